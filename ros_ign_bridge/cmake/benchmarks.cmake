@@ -0,0 +1,54 @@
+# Regression checks of Google Benchmark executables against baselines
+# recorded in the build tree, see "Benchmarks" in the README of ros_ign_bridge
+
+set(ROS_IGN_BRIDGE_BENCHMARK_THRESHOLD "0.1" CACHE STRING
+  "Largest drop in benchmark throughput allowed, as a fraction")
+set(ROS_IGN_BRIDGE_BENCHMARK_REPETITIONS "3" CACHE STRING
+  "Repetitions of each benchmark, whose median is compared")
+option(ROS_IGN_BRIDGE_BENCHMARK_ALLOW_MISSING
+  "Pass benchmark checks when benchmarks of the baseline are missing or fail"
+  OFF)
+
+set(ros_ign_bridge_COMPARE_BENCHMARKS
+  "${CMAKE_CURRENT_LIST_DIR}/../scripts/compare_benchmarks.py")
+
+# Adds targets for a benchmark executable:
+#  run_<executable>: writes its results to <executable>.json in the binary
+#    directory
+#  update_<executable>_baseline: runs it and records its results as the
+#    baseline, <executable>_baseline.json in the binary directory
+#  check_<executable>: runs it and fails if the throughput of a benchmark
+#    dropped by more than ROS_IGN_BRIDGE_BENCHMARK_THRESHOLD since the baseline,
+#    or if a benchmark of the baseline is missing or failed
+# Throughput depends on the machine and build, so baselines aren't kept in
+# the source tree.
+function(ros_ign_bridge_add_benchmark_targets executable)
+  set(results ${CMAKE_CURRENT_BINARY_DIR}/${executable}.json)
+  set(baseline ${CMAKE_CURRENT_BINARY_DIR}/${executable}_baseline.json)
+  set(compare_args --threshold ${ROS_IGN_BRIDGE_BENCHMARK_THRESHOLD})
+  if(ROS_IGN_BRIDGE_BENCHMARK_ALLOW_MISSING)
+    list(APPEND compare_args --allow-missing)
+  endif()
+  add_custom_target(run_${executable}
+    COMMAND ${executable}
+      --benchmark_repetitions=${ROS_IGN_BRIDGE_BENCHMARK_REPETITIONS}
+      --benchmark_report_aggregates_only=true
+      --benchmark_out=${results}
+      --benchmark_out_format=json
+    DEPENDS ${executable}
+    COMMENT "Writing benchmark results to ${results}"
+  )
+
+  add_custom_target(check_${executable}
+    COMMAND ${PYTHON_EXECUTABLE} ${ros_ign_bridge_COMPARE_BENCHMARKS}
+      ${baseline} ${results} ${compare_args}
+    COMMENT "Comparing ${results} to ${baseline}"
+  )
+  add_dependencies(check_${executable} run_${executable})
+
+  add_custom_target(update_${executable}_baseline
+    COMMAND ${CMAKE_COMMAND} -E copy ${results} ${baseline}
+    COMMENT "Recording ${baseline}"
+  )
+  add_dependencies(update_${executable}_baseline run_${executable})
+endfunction()
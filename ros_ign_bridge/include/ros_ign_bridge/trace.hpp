@@ -0,0 +1,187 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_BRIDGE__TRACE_HPP_
+#define ROS_IGN_BRIDGE__TRACE_HPP_
+
+// Trace points on the path of every bridged message: when it's received,
+// converted and published.
+//
+// They're compiled out unless ROS_IGN_BRIDGE_TRACING is defined, which the
+// ROS_IGN_BRIDGE_TRACING CMake option does. When compiled in, they only
+// record if the ROS_IGN_BRIDGE_TRACE_FILE environment variable is set. The
+// events are then written to that file when the process exits, as Chrome
+// trace JSON, which chrome://tracing and ui.perfetto.dev open.
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ros_ign_bridge
+{
+
+/// Collects the trace events of all threads of a process.
+class TraceRecorder
+{
+public:
+  /// Constructor
+  /// \param[in] path File written on destruction, none if empty
+  explicit TraceRecorder(const std::string & path);
+
+  /// Destructor, writes the file.
+  ~TraceRecorder();
+
+  /// Recorder of the process.
+  /// \return Null unless ROS_IGN_BRIDGE_TRACE_FILE is set.
+  static TraceRecorder *
+  instance();
+
+  /// Record an event on the calling thread. Threads only contend on their
+  /// own buffer.
+  /// \param[in] name Event name, which must outlive the recorder, such as a
+  /// string literal
+  /// \param[in] detail Argument shown with the event, such as the topic
+  /// \param[in] phase Chrome trace phase: 'i' instant, 'B' begin, 'E' end,
+  /// 'X' complete
+  /// \param[in] start Time of the event
+  /// \param[in] duration Duration of complete events
+  void
+  record(
+    const char * name,
+    const std::string & detail,
+    char phase,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::duration duration = {});
+
+  /// Write the events recorded so far as Chrome trace JSON.
+  /// \param[in] path File to write
+  /// \return False if the file can't be written.
+  bool
+  write(const std::string & path) const;
+
+private:
+  /// A recorded event
+  struct Event
+  {
+    const char * name;
+    std::string detail;
+    char phase;
+    int64_t start_ns;
+    int64_t duration_ns;
+  };
+
+  /// Events of one thread
+  struct Buffer
+  {
+    std::mutex mutex;
+    std::vector<Event> events;
+    uint32_t thread_id{0};
+  };
+
+  /// Buffer of the calling thread, created on its first event.
+  Buffer &
+  local_buffer();
+
+  const std::string path_;
+  const uint64_t id_;
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<Buffer>> buffers_;
+};
+
+/// Records a complete event from construction to destruction.
+class TraceScope
+{
+public:
+  /// Constructor
+  /// \param[in] name Event name, such as a string literal
+  /// \param[in] detail Argument shown with the event, only copied if
+  /// recording
+  template<typename T>
+  TraceScope(const char * name, const T & detail)
+  : recorder_(TraceRecorder::instance()),
+    name_(name)
+  {
+    if (recorder_) {
+      detail_ = detail;
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  /// Destructor, records the event.
+  ~TraceScope()
+  {
+    if (recorder_) {
+      recorder_->record(name_, detail_, 'X', start_,
+        std::chrono::steady_clock::now() - start_);
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope & operator=(const TraceScope &) = delete;
+
+private:
+  TraceRecorder * recorder_;
+  const char * name_;
+  std::string detail_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace ros_ign_bridge
+
+#ifdef ROS_IGN_BRIDGE_TRACING
+
+#define ROS_IGN_TRACE_CONCAT_(a, b) a ## b
+#define ROS_IGN_TRACE_CONCAT(a, b) ROS_IGN_TRACE_CONCAT_(a, b)
+
+#define ROS_IGN_TRACE_EVENT_(name, detail, phase) \
+  do { \
+    if (auto ros_ign_trace_recorder = \
+      ::ros_ign_bridge::TraceRecorder::instance()) \
+    { \
+      ros_ign_trace_recorder->record(name, detail, phase, \
+        std::chrono::steady_clock::now()); \
+    } \
+  } while (0)
+
+/// Mark a point in time, such as a message being received.
+#define ROS_IGN_TRACE_INSTANT(name, detail) \
+  ROS_IGN_TRACE_EVENT_(name, detail, 'i')
+
+/// Start a span, which ROS_IGN_TRACE_END ends on the same thread.
+#define ROS_IGN_TRACE_BEGIN(name, detail) \
+  ROS_IGN_TRACE_EVENT_(name, detail, 'B')
+
+/// End the span started last on this thread.
+#define ROS_IGN_TRACE_END(name) \
+  ROS_IGN_TRACE_EVENT_(name, std::string(), 'E')
+
+/// Span until the end of the enclosing block.
+#define ROS_IGN_TRACE_SCOPE(name, detail) \
+  ::ros_ign_bridge::TraceScope ROS_IGN_TRACE_CONCAT(ros_ign_trace_scope_, \
+    __LINE__)(name, detail)
+
+#else
+
+// Arguments aren't evaluated
+#define ROS_IGN_TRACE_INSTANT(name, detail) do {} while (0)
+#define ROS_IGN_TRACE_BEGIN(name, detail) do {} while (0)
+#define ROS_IGN_TRACE_END(name) do {} while (0)
+#define ROS_IGN_TRACE_SCOPE(name, detail) do {} while (0)
+
+#endif
+
+#endif  // ROS_IGN_BRIDGE__TRACE_HPP_
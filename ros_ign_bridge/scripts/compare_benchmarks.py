@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Compare Google Benchmark results against a baseline.
+
+Fails when the throughput of a benchmark drops by more than a threshold:
+items or bytes per second when the benchmark reports any, iterations per
+second of CPU time otherwise. With repetitions, medians are compared.
+Benchmarks of the baseline which are missing from the results, or which
+failed, fail the comparison too unless --allow-missing is given.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+# Seconds per time unit of Google Benchmark
+TIME_UNITS = {'ns': 1e-9, 'us': 1e-6, 'ms': 1e-3, 's': 1.0}
+
+# Context which should match for results to be comparable
+CONTEXT_KEYS = ['num_cpus', 'mhz_per_cpu', 'library_build_type']
+
+
+def throughput(run):
+    """Return the throughput of a run, higher is better."""
+    # Messages without data, such as std_msgs/Empty, process zero bytes
+    for counter in ('items_per_second', 'bytes_per_second'):
+        if run.get(counter, 0) > 0:
+            return float(run[counter])
+    seconds = run['cpu_time'] * TIME_UNITS[run.get('time_unit', 'ns')]
+    return 1.0 / seconds if seconds > 0 else float('inf')
+
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+
+def load(path):
+    """
+    Return the context of a file, the throughput of each benchmark in it and
+    the names of the benchmarks which failed.
+    """
+    with open(path) as f:
+        results = json.load(f)
+
+    iterations = {}
+    medians = {}
+    errors = set()
+    for run in results.get('benchmarks', []):
+        name = run.get('run_name', run['name'])
+        if run.get('error_occurred'):
+            errors.add(name)
+            continue
+        if run.get('run_type') == 'aggregate':
+            if run.get('aggregate_name') == 'median':
+                medians[name] = throughput(run)
+        else:
+            iterations.setdefault(name, []).append(throughput(run))
+
+    benchmarks = dict((name, median(values))
+                      for name, values in iterations.items())
+    benchmarks.update(medians)
+    return results.get('context', {}), benchmarks, errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('baseline', help='Google Benchmark JSON to compare to')
+    parser.add_argument('results', help='Google Benchmark JSON to check')
+    parser.add_argument(
+        '--threshold', type=float, default=0.1,
+        help='largest drop in throughput allowed, as a fraction, '
+             'default 0.1')
+    parser.add_argument(
+        '--allow-missing', action='store_true',
+        help='pass even if benchmarks of the baseline are missing from the '
+             'results or failed, such as when running a subset of them')
+    args = parser.parse_args()
+
+    if not os.path.exists(args.baseline):
+        print('No baseline at %s, record one with the '
+              'update_<benchmark>_baseline target first' % args.baseline,
+              file=sys.stderr)
+        return 2
+
+    try:
+        baseline_context, baseline, _ = load(args.baseline)
+        context, results, errors = load(args.results)
+    except (IOError, ValueError, KeyError) as e:
+        print('Failed to read benchmark results: %s' % e, file=sys.stderr)
+        return 2
+
+    for key in CONTEXT_KEYS:
+        if baseline_context.get(key) != context.get(key):
+            print('Warning: %s is %s, but %s in the baseline' %
+                  (key, context.get(key), baseline_context.get(key)))
+
+    regressions = []
+    missing = []
+    width = max([len(name) for name in baseline] + [9])
+    print('%-*s %8s' % (width, 'Benchmark', 'Change'))
+    for name in sorted(baseline):
+        if name not in results:
+            print('%-*s %8s' % (width, name,
+                                'failed' if name in errors else 'missing'))
+            missing.append(name)
+            continue
+        change = results[name] / baseline[name] - 1.0
+        regressed = change < -args.threshold
+        print('%-*s %+7.1f%%%s' % (width, name, 100.0 * change,
+                                   '  REGRESSION' if regressed else ''))
+        if regressed:
+            regressions.append(name)
+
+    for name in sorted(set(results) - set(baseline)):
+        print('%-*s %8s' % (width, name, 'new'))
+
+    if regressions:
+        print('%d of %d benchmarks lost more than %.0f%% of their throughput'
+              % (len(regressions), len(baseline), 100.0 * args.threshold),
+              file=sys.stderr)
+    if missing and not args.allow_missing:
+        print('%d of %d benchmarks are missing from the results or failed, '
+              'pass --allow-missing if that is expected'
+              % (len(missing), len(baseline)), file=sys.stderr)
+    if regressions or (missing and not args.allow_missing):
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
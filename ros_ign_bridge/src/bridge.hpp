@@ -26,12 +26,17 @@
 #include <ignition/transport/Node.hh>
 
 #include "factories.hpp"
+#include "metrics.hpp"
+#include "monitored_callback_queue.hpp"
+#include "startup_profile.hpp"
 
 namespace ros_ign_bridge
 {
 
 struct BridgeRosToIgnHandles
 {
+  // Outlives the subscriber, which schedules callbacks on it
+  std::shared_ptr<ros::CallbackQueueInterface> callback_queue;
   ros::Subscriber ros_subscriber;
   ignition::transport::Node::Publisher ign_publisher;
 };
@@ -57,17 +62,46 @@ create_bridge_from_ros_to_ign(
   size_t subscriber_queue_size,
   const std::string & ign_type_name,
   const std::string & ign_topic_name,
-  size_t publisher_queue_size)
+  size_t publisher_queue_size,
+  MetricsRegistry * metrics = nullptr,
+  StartupProfile * profile = nullptr)
 {
-  auto factory = get_factory(ros_type_name, ign_type_name);
-  auto ign_pub = factory->create_ign_publisher(
-    ign_node, ign_topic_name, publisher_queue_size);
-
-  auto ros_sub = factory->create_ros_subscriber(
-    ros_node, ros_topic_name, subscriber_queue_size, ign_pub);
+  std::shared_ptr<FactoryInterface> factory;
+  {
+    ScopedStartupTimer timer(profile ? &profile->factory_ns : nullptr);
+    factory = get_factory(ros_type_name, ign_type_name);
+  }
+
+  ignition::transport::Node::Publisher ign_pub;
+  {
+    ScopedStartupTimer timer(profile ? &profile->ign_ns : nullptr);
+    ign_pub = factory->create_ign_publisher(
+      ign_node, ign_topic_name, publisher_queue_size);
+  }
 
   BridgeRosToIgnHandles handles;
-  handles.ros_subscriber = ros_sub;
+
+  std::shared_ptr<BridgeMetrics> bridge_metrics;
+  if (metrics) {
+    bridge_metrics = metrics->add(
+      ros_topic_name, "ROS to Ignition", ros_type_name, ign_type_name);
+
+    // Mirror the subscriber queue, to report its depth and overflows
+    bridge_metrics->queue().enable(
+      static_cast<uint32_t>(subscriber_queue_size),
+      ros_node.resolveName(ros_topic_name));
+    handles.callback_queue = std::make_shared<MonitoredCallbackQueue>(
+      ros_node.getCallbackQueue(), bridge_metrics);
+    ros_node.setCallbackQueue(handles.callback_queue.get());
+  }
+
+  {
+    ScopedStartupTimer timer(profile ? &profile->ros_ns : nullptr);
+    handles.ros_subscriber = factory->create_ros_subscriber(
+      ros_node, ros_topic_name, subscriber_queue_size, ign_pub,
+      bridge_metrics);
+  }
+
   handles.ign_publisher = ign_pub;
   return handles;
 }
@@ -81,14 +115,35 @@ create_bridge_from_ign_to_ros(
   size_t subscriber_queue_size,
   const std::string & ros_type_name,
   const std::string & ros_topic_name,
-  size_t publisher_queue_size)
+  size_t publisher_queue_size,
+  MetricsRegistry * metrics = nullptr,
+  StartupProfile * profile = nullptr)
 {
-  auto factory = get_factory(ros_type_name, ign_type_name);
-  auto ros_pub = factory->create_ros_publisher(
-    ros_node, ros_topic_name, publisher_queue_size);
-
-  factory->create_ign_subscriber(
-    ign_node, ign_topic_name, subscriber_queue_size, ros_pub);
+  std::shared_ptr<FactoryInterface> factory;
+  {
+    ScopedStartupTimer timer(profile ? &profile->factory_ns : nullptr);
+    factory = get_factory(ros_type_name, ign_type_name);
+  }
+
+  ros::Publisher ros_pub;
+  {
+    ScopedStartupTimer timer(profile ? &profile->ros_ns : nullptr);
+    ros_pub = factory->create_ros_publisher(
+      ros_node, ros_topic_name, publisher_queue_size);
+  }
+
+  std::shared_ptr<BridgeMetrics> bridge_metrics;
+  if (metrics) {
+    bridge_metrics = metrics->add(
+      ign_topic_name, "Ignition to ROS", ros_type_name, ign_type_name);
+  }
+
+  {
+    ScopedStartupTimer timer(profile ? &profile->ign_ns : nullptr);
+    factory->create_ign_subscriber(
+      ign_node, ign_topic_name, subscriber_queue_size, ros_pub,
+      bridge_metrics);
+  }
 
   BridgeIgnToRosHandles handles;
   handles.ign_subscriber = ign_node;
@@ -103,7 +158,9 @@ create_bidirectional_bridge(
   const std::string & ros_type_name,
   const std::string & ign_type_name,
   const std::string & topic_name,
-  size_t queue_size = 10)
+  size_t queue_size = 10,
+  MetricsRegistry * metrics = nullptr,
+  StartupProfile * profile = nullptr)
 {
   ROS_DEBUG_STREAM("Creating bidirectional bridge for topic" << topic_name
       << " with ROS type [" << ros_type_name << "] and Ignition Transport"
@@ -112,10 +169,12 @@ create_bidirectional_bridge(
   BridgeHandles handles;
   handles.bridgeRosToIgn = create_bridge_from_ros_to_ign(
    ros_node, ign_node,
-   ros_type_name, topic_name, queue_size, ign_type_name, topic_name, queue_size);
+   ros_type_name, topic_name, queue_size, ign_type_name, topic_name, queue_size,
+   metrics, profile);
   handles.bridgeIgnToRos = create_bridge_from_ign_to_ros(
     ign_node, ros_node,
-    ign_type_name, topic_name, queue_size, ros_type_name, topic_name, queue_size);
+    ign_type_name, topic_name, queue_size, ros_type_name, topic_name, queue_size,
+    metrics, profile);
   return handles;
 }
 
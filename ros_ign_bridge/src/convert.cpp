@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cstdint>
 #include <exception>
 #include <ros/console.h>
 
@@ -22,19 +23,20 @@ namespace ros_ign_bridge
 {
 
 // This can be used to replace `::` with `/` to make frame_id compatible with TF
-std::string replace_delimiter(const std::string &input,
-                              const std::string &old_delim,
-                              const std::string new_delim)
+// The output is overwritten, reusing its memory
+void replace_delimiter(const std::string &input,
+                       const std::string &old_delim,
+                       const std::string &new_delim,
+                       std::string &output)
 {
-  std::string output;
-  output.reserve(input.size());
+  output.clear();
 
   std::size_t last_pos = 0;
 
   while (last_pos < input.size())
   {
     std::size_t pos = input.find(old_delim, last_pos);
-    output += input.substr(last_pos, pos - last_pos);
+    output.append(input, last_pos, pos - last_pos);
     if (pos != std::string::npos)
     {
       output += new_delim;
@@ -43,8 +45,6 @@ std::string replace_delimiter(const std::string &input,
 
     last_pos = pos;
   }
-
-  return output;
 }
 
 // Frame id from ROS to ign is not supported right now
@@ -53,9 +53,25 @@ std::string replace_delimiter(const std::string &input,
 //   return replace_delimiter(frame_id, "/", "::");
 // }
 
-std::string frame_id_ign_to_ros(const std::string &frame_id)
+void frame_id_ign_to_ros(const std::string &frame_id, std::string &output)
 {
-  return replace_delimiter(frame_id, "::", "/");
+  replace_delimiter(frame_id, "::", "/", output);
+}
+
+// Resize a repeated message field, keeping the elements to be overwritten.
+// Clearing them would free their sub-messages, which are allocated again
+// when the field is filled.
+template<typename T>
+void resize_repeated(google::protobuf::RepeatedPtrField<T> * field, int size)
+{
+  while (field->size() > size)
+  {
+    field->RemoveLast();
+  }
+  while (field->size() < size)
+  {
+    field->Add();
+  }
 }
 
 template<>
@@ -178,6 +194,9 @@ convert_ros_to_ign(
 {
   ign_msg.mutable_stamp()->set_sec(ros_msg.stamp.sec);
   ign_msg.mutable_stamp()->set_nsec(ros_msg.stamp.nsec);
+
+  // Cleared pairs are reused by add_data
+  ign_msg.clear_data();
   auto newPair = ign_msg.add_data();
   newPair->set_key("seq");
   newPair->add_value(std::to_string(ros_msg.seq));
@@ -195,10 +214,10 @@ convert_ign_to_ros(
   ros_msg.stamp = ros::Time(ign_msg.stamp().sec(), ign_msg.stamp().nsec());
   for (auto i = 0; i < ign_msg.data_size(); ++i)
   {
-    auto aPair = ign_msg.data(i);
+    const auto & aPair = ign_msg.data(i);
     if (aPair.key() == "seq" && aPair.value_size() > 0)
     {
-      std::string value = aPair.value(0);
+      const std::string & value = aPair.value(0);
       try
       {
         unsigned long ul = std::stoul(value, nullptr);
@@ -212,7 +231,7 @@ convert_ign_to_ros(
     }
     else if (aPair.key() == "frame_id" && aPair.value_size() > 0)
     {
-      ros_msg.frame_id = frame_id_ign_to_ros(aPair.value(0));
+      frame_id_ign_to_ros(aPair.value(0), ros_msg.frame_id);
     }
   }
 }
@@ -348,11 +367,10 @@ convert_ros_to_ign(
   const geometry_msgs::PoseArray & ros_msg,
   ignition::msgs::Pose_V & ign_msg)
 {
-  ign_msg.clear_pose();
-  for (auto const &t : ros_msg.poses)
+  resize_repeated(ign_msg.mutable_pose(), ros_msg.poses.size());
+  for (auto i = 0u; i < ros_msg.poses.size(); ++i)
   {
-    auto p = ign_msg.add_pose();
-    convert_ros_to_ign(t, *p);
+    convert_ros_to_ign(ros_msg.poses[i], *ign_msg.mutable_pose(i));
   }
 
   convert_ros_to_ign(ros_msg.header, (*ign_msg.mutable_header()));
@@ -364,12 +382,10 @@ convert_ign_to_ros(
   const ignition::msgs::Pose_V & ign_msg,
   geometry_msgs::PoseArray & ros_msg)
 {
-  ros_msg.poses.clear();
-  for (auto const &p : ign_msg.pose())
+  ros_msg.poses.resize(ign_msg.pose_size());
+  for (auto i = 0; i < ign_msg.pose_size(); ++i)
   {
-    geometry_msgs::Pose pose;
-    convert_ign_to_ros(p, pose);
-    ros_msg.poses.push_back(pose);
+    convert_ign_to_ros(ign_msg.pose(i), ros_msg.poses[i]);
   }
   convert_ign_to_ros(ign_msg.header(), ros_msg.header);
 }
@@ -438,10 +454,10 @@ convert_ign_to_ros(
   convert_ign_to_ros(ign_msg, ros_msg.transform);
   for (auto i = 0; i < ign_msg.header().data_size(); ++i)
   {
-    auto aPair = ign_msg.header().data(i);
+    const auto & aPair = ign_msg.header().data(i);
     if (aPair.key() == "child_frame_id" && aPair.value_size() > 0)
     {
-      ros_msg.child_frame_id = frame_id_ign_to_ros(aPair.value(0));
+      frame_id_ign_to_ros(aPair.value(0), ros_msg.child_frame_id);
       break;
     }
   }
@@ -453,11 +469,10 @@ convert_ros_to_ign(
   const tf2_msgs::TFMessage & ros_msg,
   ignition::msgs::Pose_V & ign_msg)
 {
-  ign_msg.clear_pose();
-  for (auto const &t : ros_msg.transforms)
+  resize_repeated(ign_msg.mutable_pose(), ros_msg.transforms.size());
+  for (auto i = 0u; i < ros_msg.transforms.size(); ++i)
   {
-    auto p = ign_msg.add_pose();
-    convert_ros_to_ign(t, *p);
+    convert_ros_to_ign(ros_msg.transforms[i], *ign_msg.mutable_pose(i));
   }
 
   if (!ros_msg.transforms.empty())
@@ -465,6 +480,10 @@ convert_ros_to_ign(
     convert_ros_to_ign(ros_msg.transforms[0].header,
         (*ign_msg.mutable_header()));
   }
+  else
+  {
+    ign_msg.clear_header();
+  }
 }
 
 template<>
@@ -473,12 +492,10 @@ convert_ign_to_ros(
   const ignition::msgs::Pose_V & ign_msg,
   tf2_msgs::TFMessage & ros_msg)
 {
-  ros_msg.transforms.clear();
-  for (auto const &p : ign_msg.pose())
+  ros_msg.transforms.resize(ign_msg.pose_size());
+  for (auto i = 0; i < ign_msg.pose_size(); ++i)
   {
-    geometry_msgs::TransformStamped tf;
-    convert_ign_to_ros(p, tf);
-    ros_msg.transforms.push_back(tf);
+    convert_ign_to_ros(ign_msg.pose(i), ros_msg.transforms[i]);
   }
 }
 
@@ -510,6 +527,9 @@ convert_ros_to_ign(
 {
   convert_ros_to_ign(ros_msg.header, (*ign_msg.mutable_header()));
 
+  ign_msg.clear_position();
+  ign_msg.clear_velocity();
+  ign_msg.clear_normalized();
   for (auto i = 0u; i < ros_msg.angles.size(); ++i)
     ign_msg.add_position(ros_msg.angles[i]);
   for (auto i = 0u; i < ros_msg.angular_velocities.size(); ++i)
@@ -526,12 +546,12 @@ convert_ign_to_ros(
 {
   convert_ign_to_ros(ign_msg.header(), ros_msg.header);
 
-  for (auto i = 0; i < ign_msg.position_size(); ++i)
-    ros_msg.angles.push_back(ign_msg.position(i));
-  for (auto i = 0; i < ign_msg.velocity_size(); ++i)
-    ros_msg.angular_velocities.push_back(ign_msg.velocity(i));
-  for (auto i = 0; i < ign_msg.normalized_size(); ++i)
-    ros_msg.normalized.push_back(ign_msg.normalized(i));
+  ros_msg.angles.assign(
+    ign_msg.position().begin(), ign_msg.position().end());
+  ros_msg.angular_velocities.assign(
+    ign_msg.velocity().begin(), ign_msg.velocity().end());
+  ros_msg.normalized.assign(
+    ign_msg.normalized().begin(), ign_msg.normalized().end());
 }
 
 template<>
@@ -557,7 +577,8 @@ convert_ros_to_ign(
   convert_ros_to_ign(ros_msg.info.origin, 
       (*ign_msg.mutable_info()->mutable_origin()));
 
-  ign_msg.set_data(&ros_msg.data[0], ros_msg.data.size());
+  ign_msg.mutable_data()->assign(
+    reinterpret_cast<const char *>(ros_msg.data.data()), ros_msg.data.size());
 }
 
 template<>
@@ -576,8 +597,7 @@ convert_ign_to_ros(
 
   convert_ign_to_ros(ign_msg.info().origin(), ros_msg.info.origin);
 
-  ros_msg.data.resize(ign_msg.data().size());
-  memcpy(&ros_msg.data[0], ign_msg.data().c_str(), ign_msg.data().size());
+  ros_msg.data.assign(ign_msg.data().begin(), ign_msg.data().end());
 }
 
 template<>
@@ -607,10 +627,10 @@ convert_ign_to_ros(
 
   for (auto i = 0; i < ign_msg.header().data_size(); ++i)
   {
-    auto aPair = ign_msg.header().data(i);
+    const auto & aPair = ign_msg.header().data(i);
     if (aPair.key() == "child_frame_id" && aPair.value_size() > 0)
     {
-      ros_msg.child_frame_id = frame_id_ign_to_ros(aPair.value(0));
+      frame_id_ign_to_ros(aPair.value(0), ros_msg.child_frame_id);
       break;
     }
   }
@@ -719,6 +739,8 @@ convert_ros_to_ign(
   {
     ign_msg.set_pixel_format_type(
       ignition::msgs::PixelFormatType::UNKNOWN_PIXEL_FORMAT);
+    ign_msg.clear_step();
+    ign_msg.clear_data();
     ROS_ERROR_STREAM("Unsupported pixel format [" << ros_msg.encoding << "]"
               << std::endl);
     return;
@@ -726,7 +748,21 @@ convert_ros_to_ign(
 
   ign_msg.set_step(ign_msg.width() * num_channels * octets_per_channel);
 
-  ign_msg.set_data(&(ros_msg.data[0]), ign_msg.step() * ign_msg.height());
+  // Only the rows which are all there
+  const uint64_t size = uint64_t{ign_msg.step()} * ign_msg.height();
+  if (size > ros_msg.data.size())
+  {
+    ROS_ERROR_STREAM("Image has " << ros_msg.data.size() << " bytes of data "
+              << "instead of " << size << ", keeping whole rows only"
+              << std::endl);
+    ign_msg.set_height(ign_msg.step() ? ros_msg.data.size() / ign_msg.step()
+      : 0u);
+  }
+
+  // Assigned in place, set_data would copy into a temporary first
+  ign_msg.mutable_data()->assign(
+    reinterpret_cast<const char *>(ros_msg.data.data()),
+    size_t{ign_msg.step()} * ign_msg.height());
 }
 
 template<>
@@ -808,6 +844,10 @@ convert_ign_to_ros(
   }
   else
   {
+    ros_msg.encoding.clear();
+    ros_msg.is_bigendian = false;
+    ros_msg.step = 0;
+    ros_msg.data.clear();
     ROS_ERROR_STREAM("Unsupported pixel format ["
         << ign_msg.pixel_format_type() << "]" << std::endl);
     return;
@@ -816,12 +856,19 @@ convert_ign_to_ros(
   ros_msg.is_bigendian = false;
   ros_msg.step = ros_msg.width * num_channels * octets_per_channel;
 
-  auto count = ros_msg.step * ros_msg.height;
-  ros_msg.data.resize(ros_msg.step * ros_msg.height);
-  std::copy(
+  // Only the rows which are all there
+  const uint64_t size = uint64_t{ros_msg.step} * ros_msg.height;
+  if (size > ign_msg.data().size())
+  {
+    ROS_ERROR_STREAM("Image has " << ign_msg.data().size() << " bytes of data "
+              << "instead of " << size << ", keeping whole rows only"
+              << std::endl);
+    ros_msg.height = ros_msg.step ? ign_msg.data().size() / ros_msg.step : 0u;
+  }
+
+  ros_msg.data.assign(
     ign_msg.data().begin(),
-    ign_msg.data().begin() + count,
-    ros_msg.data.begin());
+    ign_msg.data().begin() + size_t{ros_msg.step} * ros_msg.height);
 }
 
 template<>
@@ -850,26 +897,31 @@ convert_ros_to_ign(
   }
   else
   {
+    distortion->clear_model();
     ROS_ERROR_STREAM("Unsupported distortion model ["
         << ros_msg.distortion_model << "]" << std::endl);
   }
+  distortion->clear_k();
   for (auto i = 0u; i < ros_msg.D.size(); ++i)
   {
     distortion->add_k(ros_msg.D[i]);
   }
 
   auto intrinsics = ign_msg.mutable_intrinsics();
+  intrinsics->clear_k();
   for (auto i = 0u; i < ros_msg.K.size(); ++i)
   {
     intrinsics->add_k(ros_msg.K[i]);
   }
 
   auto projection = ign_msg.mutable_projection();
+  projection->clear_p();
   for (auto i = 0u; i < ros_msg.P.size(); ++i)
   {
     projection->add_p(ros_msg.P[i]);
   }
 
+  ign_msg.clear_rectification_matrix();
   for (auto i = 0u; i < ros_msg.R.size(); ++i)
   {
     ign_msg.add_rectification_matrix(ros_msg.R[i]);
@@ -887,10 +939,9 @@ convert_ign_to_ros(
   ros_msg.height = ign_msg.height();
   ros_msg.width = ign_msg.width();
 
-  auto distortion = ign_msg.distortion();
   if (ign_msg.has_distortion())
   {
-    auto distortion = ign_msg.distortion();
+    const auto & distortion = ign_msg.distortion();
     if (distortion.model() ==
         ignition::msgs::CameraInfo::Distortion::PLUMB_BOB)
     {
@@ -908,6 +959,7 @@ convert_ign_to_ros(
     }
     else
     {
+      ros_msg.distortion_model.clear();
       ROS_ERROR_STREAM("Unsupported distortion model ["
                 << distortion.model() << "]" << std::endl);
     }
@@ -918,30 +970,41 @@ convert_ign_to_ros(
       ros_msg.D[i] = distortion.k(i);
     }
   }
+  else
+  {
+    ros_msg.distortion_model.clear();
+    ros_msg.D.clear();
+  }
 
-  auto intrinsics = ign_msg.intrinsics();
+  // Fixed size in ROS, extra values are ignored and missing ones are zero
+  std::fill(ros_msg.K.begin(), ros_msg.K.end(), 0.0);
   if (ign_msg.has_intrinsics())
   {
-    auto intrinsics = ign_msg.intrinsics();
+    const auto & intrinsics = ign_msg.intrinsics();
 
-    for (auto i = 0; i < intrinsics.k_size(); ++i)
+    const auto k_size = std::min<size_t>(intrinsics.k_size(), ros_msg.K.size());
+    for (auto i = 0u; i < k_size; ++i)
     {
       ros_msg.K[i] = intrinsics.k(i);
     }
   }
 
-  auto projection = ign_msg.projection();
+  std::fill(ros_msg.P.begin(), ros_msg.P.end(), 0.0);
   if (ign_msg.has_projection())
   {
-    auto projection = ign_msg.projection();
+    const auto & projection = ign_msg.projection();
 
-    for (auto i = 0; i < projection.p_size(); ++i)
+    const auto p_size = std::min<size_t>(projection.p_size(), ros_msg.P.size());
+    for (auto i = 0u; i < p_size; ++i)
     {
       ros_msg.P[i] = projection.p(i);
     }
   }
 
-  for (auto i = 0; i < ign_msg.rectification_matrix_size(); ++i)
+  std::fill(ros_msg.R.begin(), ros_msg.R.end(), 0.0);
+  const auto r_size = std::min<size_t>(
+    ign_msg.rectification_matrix_size(), ros_msg.R.size());
+  for (auto i = 0u; i < r_size; ++i)
   {
     ros_msg.R[i] = ign_msg.rectification_matrix(i);
   }
@@ -988,9 +1051,10 @@ convert_ros_to_ign(
   convert_ros_to_ign(ros_msg.header, (*ign_msg.mutable_header()));
 
   const auto nan = std::numeric_limits<double>::quiet_NaN();
+  resize_repeated(ign_msg.mutable_joint(), ros_msg.name.size());
   for (auto i = 0u; i < ros_msg.name.size(); ++i)
   {
-    auto newJoint = ign_msg.add_joint();
+    auto newJoint = ign_msg.mutable_joint(i);
     newJoint->set_name(ros_msg.name[i]);
     
     if (ros_msg.position.size() > i)
@@ -1018,12 +1082,17 @@ convert_ign_to_ros(
 {
   convert_ign_to_ros(ign_msg.header(), ros_msg.header);
 
-  for (auto i = 0; i < ign_msg.joint_size(); ++i)
+  const auto count = ign_msg.joint_size();
+  ros_msg.name.resize(count);
+  ros_msg.position.resize(count);
+  ros_msg.velocity.resize(count);
+  ros_msg.effort.resize(count);
+  for (auto i = 0; i < count; ++i)
   {
-    ros_msg.name.push_back(ign_msg.joint(i).name());
-    ros_msg.position.push_back(ign_msg.joint(i).axis1().position());
-    ros_msg.velocity.push_back(ign_msg.joint(i).axis1().velocity());
-    ros_msg.effort.push_back(ign_msg.joint(i).axis1().force());
+    ros_msg.name[i] = ign_msg.joint(i).name();
+    ros_msg.position[i] = ign_msg.joint(i).axis1().position();
+    ros_msg.velocity[i] = ign_msg.joint(i).axis1().velocity();
+    ros_msg.effort[i] = ign_msg.joint(i).axis1().force();
   }
 }
 
@@ -1033,8 +1102,9 @@ convert_ros_to_ign(
   const sensor_msgs::LaserScan & ros_msg,
   ignition::msgs::LaserScan & ign_msg)
 {
-  const unsigned int num_readings =
-    (ros_msg.angle_max - ros_msg.angle_min) / ros_msg.angle_increment;
+  // The ranges hold one reading per angle step, from angle_min to angle_max
+  // included. Counting them rather than the steps can't disagree with them.
+  const unsigned int num_readings = ros_msg.ranges.size();
 
   convert_ros_to_ign(ros_msg.header, (*ign_msg.mutable_header()));
   ign_msg.set_frame(ros_msg.header.frame_id);
@@ -1051,9 +1121,20 @@ convert_ros_to_ign(
   ign_msg.set_vertical_angle_step(0.0);
   ign_msg.set_vertical_count(0u);
 
-  for (auto i = 0u; i < ign_msg.count(); ++i)
+  ign_msg.clear_ranges();
+  ign_msg.clear_intensities();
+  ign_msg.mutable_ranges()->Reserve(num_readings);
+  ign_msg.mutable_intensities()->Reserve(num_readings);
+  for (auto i = 0u; i < num_readings; ++i)
   {
     ign_msg.add_ranges(ros_msg.ranges[i]);
+  }
+
+  // Intensities are optional in ROS
+  const auto num_intensities =
+    std::min<size_t>(num_readings, ros_msg.intensities.size());
+  for (auto i = 0u; i < num_intensities; ++i)
+  {
     ign_msg.add_intensities(ros_msg.intensities[i]);
   }
 }
@@ -1065,7 +1146,7 @@ convert_ign_to_ros(
   sensor_msgs::LaserScan & ros_msg)
 {
   convert_ign_to_ros(ign_msg.header(), ros_msg.header);
-  ros_msg.header.frame_id = frame_id_ign_to_ros(ign_msg.frame());
+  frame_id_ign_to_ros(ign_msg.frame(), ros_msg.header.frame_id);
 
   ros_msg.angle_min = ign_msg.angle_min();
   ros_msg.angle_max = ign_msg.angle_max();
@@ -1078,25 +1159,25 @@ convert_ign_to_ros(
   ros_msg.range_min = ign_msg.range_min();
   ros_msg.range_max = ign_msg.range_max();
 
-  auto count = ign_msg.count();
-  auto vertical_count = ign_msg.vertical_count();
+  const size_t count = ign_msg.count();
+  const size_t vertical_count = ign_msg.vertical_count();
 
   // If there are multiple vertical beams, use the one in the middle.
-  size_t start = (vertical_count / 2) * count;
-
-  // Copy ranges into ROS message.
-  ros_msg.ranges.resize(count);
-  std::copy(
-    ign_msg.ranges().begin() + start,
-    ign_msg.ranges().begin() + start + count,
-    ros_msg.ranges.begin());
+  const size_t start = (vertical_count / 2) * count;
 
-  // Copy intensities into ROS message.
-  ros_msg.intensities.resize(count);
-  std::copy(
-    ign_msg.intensities().begin() + start,
-    ign_msg.intensities().begin() + start + count,
-    ros_msg.intensities.begin());
+  // Copy the readings of that beam into the ROS message, as far as there are
+  // any: intensities may be missing.
+  auto beam = [start, count](
+    const google::protobuf::RepeatedField<double> & readings,
+    std::vector<float> & output)
+  {
+    const size_t size = readings.size();
+    const size_t begin = std::min(start, size);
+    const size_t end = begin + std::min(count, size - begin);
+    output.assign(readings.begin() + begin, readings.begin() + end);
+  };
+  beam(ign_msg.ranges(), ros_msg.ranges);
+  beam(ign_msg.intensities(), ros_msg.intensities);
 }
 
 template<>
@@ -1139,6 +1220,7 @@ convert_ros_to_ign(
   memcpy(ign_msg.mutable_data()->data(), ros_msg.data.data(),
          ros_msg.data.size());
 
+  ign_msg.clear_field();
   for (unsigned int i = 0; i < ros_msg.fields.size(); ++i)
   {
     ignition::msgs::PointCloudPacked::Field *pf = ign_msg.add_field();
@@ -1193,9 +1275,10 @@ convert_ign_to_ros(
   ros_msg.data.resize(ign_msg.data().size());
   memcpy(ros_msg.data.data(), ign_msg.data().c_str(), ign_msg.data().size());
 
+  ros_msg.fields.resize(ign_msg.field_size());
   for (int i = 0; i < ign_msg.field_size(); ++i)
   {
-    sensor_msgs::PointField pf;
+    auto & pf = ros_msg.fields[i];
     pf.name = ign_msg.field(i).name();
     pf.count = ign_msg.field(i).count();
     pf.offset = ign_msg.field(i).offset();
@@ -1227,7 +1310,6 @@ convert_ign_to_ros(
         pf.datatype = sensor_msgs::PointField::FLOAT64;
         break;
     };
-    ros_msg.fields.push_back(pf);
   }
 }
 
@@ -1269,6 +1351,7 @@ convert_ros_to_ign(
   }
   else
   {
+    ign_msg.set_power_supply_status(ignition::msgs::BatteryState::UNKNOWN);
     ROS_ERROR_STREAM("Unsupported power supply status ["
         << ros_msg.power_supply_status << "]" << std::endl);
   }
@@ -1316,6 +1399,7 @@ convert_ign_to_ros(
   }
   else
   {
+    ros_msg.power_supply_status = sensor_msgs::BatteryState::POWER_SUPPLY_STATUS_UNKNOWN;
     ROS_ERROR_STREAM("Unsupported power supply status ["
               << ign_msg.power_supply_status() << "]" << std::endl);
   }
@@ -1333,6 +1417,10 @@ convert_ros_to_ign(
 {
   convert_ros_to_ign(ros_msg.header, (*ign_msg.mutable_header()));
 
+  // Unknown and unsupported values keep those of a new message
+  ign_msg.clear_action();
+  ign_msg.clear_type();
+
   // Note, in ROS's Marker message ADD and MODIFY both map to a value of "0", 
   // so that case is not needed here.
   switch(ros_msg.action)
@@ -1443,6 +1531,10 @@ convert_ign_to_ros(
 {
   convert_ign_to_ros(ign_msg.header(), ros_msg.header);
 
+  // Unknown and unsupported values keep those of a new message
+  ros_msg.action = visualization_msgs::Marker::ADD;
+  ros_msg.type = visualization_msgs::Marker::ARROW;
+
   switch(ign_msg.action())
   {
     case ignition::msgs::Marker::ADD_MODIFY:
@@ -1554,11 +1646,10 @@ convert_ros_to_ign(
     ignition::msgs::Marker_V & ign_msg)
 {
   ign_msg.clear_header();
-  ign_msg.clear_marker();
-  for (const auto &marker : ros_msg.markers)
+  resize_repeated(ign_msg.mutable_marker(), ros_msg.markers.size());
+  for (auto i = 0u; i < ros_msg.markers.size(); ++i)
   {
-    auto m = ign_msg.add_marker();
-    convert_ros_to_ign(marker, *m);
+    convert_ros_to_ign(ros_msg.markers[i], *ign_msg.mutable_marker(i));
   }
 }
 
@@ -1568,14 +1659,10 @@ convert_ign_to_ros(
     const ignition::msgs::Marker_V & ign_msg,
     visualization_msgs::MarkerArray & ros_msg)
 {
-  ros_msg.markers.clear();
-  ros_msg.markers.reserve(ign_msg.marker_size());
-
-  for (auto const &marker : ign_msg.marker())
+  ros_msg.markers.resize(ign_msg.marker_size());
+  for (auto i = 0; i < ign_msg.marker_size(); ++i)
   {
-      visualization_msgs::Marker m;
-      convert_ign_to_ros(marker, m);
-      ros_msg.markers.push_back(m);
+    convert_ign_to_ros(ign_msg.marker(i), ros_msg.markers[i]);
   }
 }
 
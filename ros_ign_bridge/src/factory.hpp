@@ -15,6 +15,7 @@
 #ifndef ROS_IGN_BRIDGE__FACTORY_HPP_
 #define ROS_IGN_BRIDGE__FACTORY_HPP_
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
@@ -27,6 +28,7 @@
 #include <ros/ros.h>
 
 #include "factory_interface.hpp"
+#include "ros_ign_bridge/trace.hpp"
 
 namespace ros_ign_bridge
 {
@@ -56,6 +58,7 @@ public:
     const std::string & topic_name,
     size_t /*queue_size*/)
   {
+    // Ignition Transport publishers have no queue to size
     return ign_node->Advertise<IGN_T>(topic_name);
   }
 
@@ -64,7 +67,8 @@ public:
     ros::NodeHandle node,
     const std::string & topic_name,
     size_t queue_size,
-    ignition::transport::Node::Publisher & ign_pub)
+    ignition::transport::Node::Publisher & ign_pub,
+    std::shared_ptr<BridgeMetrics> metrics)
   {
     // workaround for https://github.com/ros/roscpp_core/issues/22 to get the
     // connection header
@@ -78,7 +82,8 @@ public:
         <const ros::MessageEvent<ROS_T const> &>(
           boost::bind(
             &Factory<ROS_T, IGN_T>::ros_callback,
-            _1, ign_pub, ros_type_name_, ign_type_name_)));
+            _1, ign_pub, topic_name, ros_type_name_, ign_type_name_,
+            metrics)));
     return node.subscribe(ops);
   }
 
@@ -87,36 +92,61 @@ public:
     std::shared_ptr<ignition::transport::Node> node,
     const std::string & topic_name,
     size_t /*queue_size*/,
-    ros::Publisher ros_pub)
+    ros::Publisher ros_pub,
+    std::shared_ptr<BridgeMetrics> metrics)
   {
-
+    // Ignition Transport calls subscribers as messages arrive, without a
+    // queue to size
     std::function<void(const IGN_T&,
                        const ignition::transport::MessageInfo &)> subCb =
-    [this, ros_pub](const IGN_T &_msg,
+    [this, ros_pub, topic_name, metrics](const IGN_T &_msg,
                      const ignition::transport::MessageInfo &_info)
     {
       // Ignore messages that are published from this bridge.
       if (!_info.IntraProcess())
-        this->ign_callback(_msg, ros_pub);
+        this->ign_callback(_msg, ros_pub, topic_name, metrics);
     };
 
     node->Subscribe(topic_name, subCb);
   }
 
 protected:
+  /// Output message of the conversions on the calling thread, reused so
+  /// that converting doesn't allocate once its fields are large enough.
+  /// Shared by the bridges of the same type, as publishing serializes or
+  /// copies it before returning.
+  template<typename T>
+  static
+  T & output_message()
+  {
+    static thread_local T msg;
+    return msg;
+  }
 
   static
   void ros_callback(
     const ros::MessageEvent<ROS_T const> & ros_msg_event,
     ignition::transport::Node::Publisher & ign_pub,
+    const std::string &topic_name,
     const std::string &ros_type_name,
-    const std::string &ign_type_name)
+    const std::string &ign_type_name,
+    const std::shared_ptr<BridgeMetrics> & metrics)
   {
+    ROS_IGN_TRACE_INSTANT("receive", topic_name);
+
+    // roscpp popped this message from the subscriber queue
+    if (metrics) {
+      metrics->queue().pop();
+    }
+
     const boost::shared_ptr<ros::M_string> & connection_header =
       ros_msg_event.getConnectionHeaderPtr();
     if (!connection_header) {
       ROS_ERROR("Dropping message %s without connection header",
           ros_type_name.c_str());
+      if (metrics) {
+        metrics->record_drop();
+      }
       return;
     }
 
@@ -130,9 +160,32 @@ protected:
     const boost::shared_ptr<ROS_T const> & ros_msg =
       ros_msg_event.getConstMessage();
 
-    IGN_T ign_msg;
+    // Without metrics, don't pay for the clock nor for sizing messages
+    std::chrono::steady_clock::time_point start, converted;
+    if (metrics) {
+      start = std::chrono::steady_clock::now();
+    }
+    ROS_IGN_TRACE_BEGIN("convert", topic_name);
+    IGN_T & ign_msg = output_message<IGN_T>();
     convert_ros_to_ign(*ros_msg, ign_msg);
-    ign_pub.Publish(ign_msg);
+    ROS_IGN_TRACE_END("convert");
+    if (metrics) {
+      converted = std::chrono::steady_clock::now();
+    }
+    ROS_IGN_TRACE_BEGIN("publish", topic_name);
+    const bool published = ign_pub.Publish(ign_msg);
+    ROS_IGN_TRACE_END("publish");
+
+    if (metrics) {
+      if (published) {
+        metrics->record(
+          ros::serialization::serializationLength(*ros_msg),
+          ign_msg.ByteSizeLong(),
+          converted - start, std::chrono::steady_clock::now() - converted);
+      } else {
+        metrics->record_drop();
+      }
+    }
     ROS_INFO_ONCE("Passing message from ROS %s to Ignition %s (showing msg"\
         " only once per type", ros_type_name.c_str(), ign_type_name.c_str());
   }
@@ -140,11 +193,34 @@ protected:
   static
   void ign_callback(
     const IGN_T & ign_msg,
-    ros::Publisher ros_pub)
+    ros::Publisher ros_pub,
+    const std::string & topic_name,
+    const std::shared_ptr<BridgeMetrics> & metrics)
   {
-    ROS_T ros_msg;
+    ROS_IGN_TRACE_INSTANT("receive", topic_name);
+
+    // Without metrics, don't pay for the clock nor for sizing messages
+    std::chrono::steady_clock::time_point start, converted;
+    if (metrics) {
+      start = std::chrono::steady_clock::now();
+    }
+    ROS_IGN_TRACE_BEGIN("convert", topic_name);
+    ROS_T & ros_msg = output_message<ROS_T>();
     convert_ign_to_ros(ign_msg, ros_msg);
+    ROS_IGN_TRACE_END("convert");
+    if (metrics) {
+      converted = std::chrono::steady_clock::now();
+    }
+    ROS_IGN_TRACE_BEGIN("publish", topic_name);
     ros_pub.publish(ros_msg);
+    ROS_IGN_TRACE_END("publish");
+
+    if (metrics) {
+      metrics->record(
+        ign_msg.ByteSizeLong(),
+        ros::serialization::serializationLength(ros_msg),
+        converted - start, std::chrono::steady_clock::now() - converted);
+    }
   }
 
 public:
@@ -15,6 +15,7 @@
 #ifndef  ROS_IGN_BRIDGE__FACTORY_INTERFACE_HPP_
 #define  ROS_IGN_BRIDGE__FACTORY_INTERFACE_HPP_
 
+#include <memory>
 #include <string>
 
 // include ROS
@@ -24,6 +25,8 @@
 // include Ignition Transport
 #include <ignition/transport/Node.hh>
 
+#include "metrics.hpp"
+
 namespace ros_ign_bridge
 {
 
@@ -50,7 +53,8 @@ public:
     ros::NodeHandle node,
     const std::string & topic_name,
     size_t queue_size,
-    ignition::transport::Node::Publisher & ign_pub) = 0;
+    ignition::transport::Node::Publisher & ign_pub,
+    std::shared_ptr<BridgeMetrics> metrics) = 0;
 
   virtual
   void
@@ -58,7 +62,8 @@ public:
     std::shared_ptr<ignition::transport::Node> node,
     const std::string & topic_name,
     size_t queue_size,
-    ros::Publisher ros_pub) = 0;
+    ros::Publisher ros_pub,
+    std::shared_ptr<BridgeMetrics> metrics) = 0;
 };
 
 }  // namespace ros_ign_bridge
@@ -0,0 +1,365 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "metrics.hpp"
+
+namespace ros_ign_bridge
+{
+
+namespace
+{
+
+/// Format a value for a diagnostic key value pair.
+template<typename T>
+diagnostic_msgs::KeyValue
+key_value(const std::string & key, const T & value)
+{
+  std::ostringstream stream;
+  stream << value;
+
+  diagnostic_msgs::KeyValue kv;
+  kv.key = key;
+  kv.value = stream.str();
+  return kv;
+}
+
+/// Counts recorded between two snapshots.
+LatencyHistogram::Counts
+difference(
+  const LatencyHistogram::Counts & current,
+  const LatencyHistogram::Counts & previous)
+{
+  LatencyHistogram::Counts counts;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = current[i] - previous[i];
+  }
+  return counts;
+}
+
+/// Quantiles of a histogram in microseconds, as p50/p99/p999/max.
+std::string
+summary(const LatencyHistogram::Counts & counts)
+{
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(1)
+         << LatencyHistogram::quantile(counts, 0.5) / 1e3 << " / "
+         << LatencyHistogram::quantile(counts, 0.99) / 1e3 << " / "
+         << LatencyHistogram::quantile(counts, 0.999) / 1e3 << " / "
+         << LatencyHistogram::quantile(counts, 1.0) / 1e3;
+  return stream.str();
+}
+
+}  // namespace
+
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kSubBuckets;
+constexpr int LatencyHistogram::kMaxExponent;
+constexpr size_t LatencyHistogram::kBucketCount;
+constexpr size_t BridgeMetrics::kShards;
+
+//////////////////////////////////////////////////
+void
+LatencyHistogram::add_to(Counts & counts) const
+{
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    counts[i] += counts_[i].load(std::memory_order_relaxed);
+  }
+}
+
+//////////////////////////////////////////////////
+size_t
+LatencyHistogram::bucket_index(uint64_t nanoseconds)
+{
+  if (nanoseconds < kSubBuckets) {
+    return static_cast<size_t>(nanoseconds);
+  }
+
+  int exponent = 63 - __builtin_clzll(nanoseconds);
+  if (exponent > kMaxExponent) {
+    return kBucketCount - 1;
+  }
+
+  const auto sub_bucket =
+    (nanoseconds >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+//////////////////////////////////////////////////
+uint64_t
+LatencyHistogram::bucket_value(size_t index)
+{
+  if (index < kSubBuckets) {
+    return index;
+  }
+
+  const int exponent = static_cast<int>(index / kSubBuckets) +
+    kSubBucketBits - 1;
+  const uint64_t sub_bucket = index % kSubBuckets;
+  const int shift = exponent - kSubBucketBits;
+  return ((kSubBuckets + sub_bucket + 1) << shift) - 1;
+}
+
+//////////////////////////////////////////////////
+uint64_t
+LatencyHistogram::quantile(const Counts & counts, double quantile)
+{
+  uint64_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  // Rank of the value, starting at 1
+  auto rank = static_cast<uint64_t>(quantile * total + 0.5);
+  rank = std::max<uint64_t>(1, std::min(rank, total));
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return bucket_value(i);
+    }
+  }
+  return bucket_value(counts.size() - 1);
+}
+
+//////////////////////////////////////////////////
+BridgeMetrics::BridgeMetrics(
+  const std::string & topic_name,
+  const std::string & direction,
+  const std::string & ros_type_name,
+  const std::string & ign_type_name)
+: topic_name_(topic_name),
+  direction_(direction),
+  ros_type_name_(ros_type_name),
+  ign_type_name_(ign_type_name)
+{
+}
+
+//////////////////////////////////////////////////
+MetricsSnapshot
+BridgeMetrics::snapshot() const
+{
+  MetricsSnapshot snapshot;
+  for (const auto & shard : shards_) {
+    snapshot.messages += shard.messages.load(std::memory_order_relaxed);
+    snapshot.dropped += shard.dropped.load(std::memory_order_relaxed);
+    snapshot.bytes_in += shard.bytes_in.load(std::memory_order_relaxed);
+    snapshot.bytes_out += shard.bytes_out.load(std::memory_order_relaxed);
+    shard.convert.add_to(snapshot.convert);
+    shard.publish.add_to(snapshot.publish);
+  }
+  return snapshot;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<BridgeMetrics>
+MetricsRegistry::add(
+  const std::string & topic_name,
+  const std::string & direction,
+  const std::string & ros_type_name,
+  const std::string & ign_type_name)
+{
+  Entry entry;
+  entry.metrics = std::make_shared<BridgeMetrics>(
+    topic_name, direction, ros_type_name, ign_type_name);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.push_back(entry);
+  return entry.metrics;
+}
+
+//////////////////////////////////////////////////
+diagnostic_msgs::DiagnosticArray
+MetricsRegistry::diagnostics(const ros::Time & stamp)
+{
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = stamp;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & entry : entries_) {
+    const auto & metrics = *entry.metrics;
+    auto current = metrics.snapshot();
+    const auto & previous = entry.previous;
+
+    double period = entry.previous_stamp.isZero() ?
+      0.0 : (stamp - entry.previous_stamp).toSec();
+    auto per_second = [period](uint64_t count)
+      {
+        return period > 0.0 ? count / period : 0.0;
+      };
+
+    const auto dropped = current.dropped - previous.dropped;
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = "ros_ign_bridge: " + metrics.topic_name_ + " (" +
+      metrics.direction_ + ")";
+    status.hardware_id = "none";
+    if (dropped > 0) {
+      status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+      status.message = std::to_string(dropped) + " messages dropped";
+    } else {
+      status.level = diagnostic_msgs::DiagnosticStatus::OK;
+      status.message = "OK";
+    }
+
+    status.values.push_back(key_value("ROS type", metrics.ros_type_name_));
+    status.values.push_back(key_value("Ignition type",
+      metrics.ign_type_name_));
+    status.values.push_back(key_value("Messages", current.messages));
+    status.values.push_back(key_value("Dropped", current.dropped));
+    status.values.push_back(key_value("Rate (Hz)",
+      per_second(current.messages - previous.messages)));
+    status.values.push_back(key_value("Bytes in", current.bytes_in));
+    status.values.push_back(key_value("Bytes out", current.bytes_out));
+    status.values.push_back(key_value("Bandwidth in (B/s)",
+      per_second(current.bytes_in - previous.bytes_in)));
+    status.values.push_back(key_value("Bandwidth out (B/s)",
+      per_second(current.bytes_out - previous.bytes_out)));
+    status.values.push_back(key_value("Convert p50/p99/p999/max (us)",
+      summary(difference(current.convert, previous.convert))));
+    status.values.push_back(key_value("Publish p50/p99/p999/max (us)",
+      summary(difference(current.publish, previous.publish))));
+    array.status.push_back(status);
+
+    entry.previous = current;
+    entry.previous_stamp = stamp;
+  }
+  return array;
+}
+
+//////////////////////////////////////////////////
+void
+MetricsRegistry::update_overflows(XmlRpc::XmlRpcValue & bus_stats)
+{
+  using XmlRpc::XmlRpcValue;
+  if (bus_stats.getType() != XmlRpcValue::TypeArray || bus_stats.size() < 2 ||
+    bus_stats[1].getType() != XmlRpcValue::TypeArray)
+  {
+    return;
+  }
+  auto & subscriptions = bus_stats[1];
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<int, int> connection_drops;
+  for (int i = 0; i < subscriptions.size(); ++i) {
+    auto & subscription = subscriptions[i];
+    if (subscription.getType() != XmlRpcValue::TypeArray ||
+      subscription.size() < 2 ||
+      subscription[0].getType() != XmlRpcValue::TypeString ||
+      subscription[1].getType() != XmlRpcValue::TypeArray)
+    {
+      continue;
+    }
+    const std::string & topic = subscription[0];
+    auto & connections = subscription[1];
+
+    uint64_t overflows = 0;
+    for (int j = 0; j < connections.size(); ++j) {
+      auto & connection = connections[j];
+      if (connection.getType() != XmlRpcValue::TypeArray ||
+        connection.size() < 4 ||
+        connection[0].getType() != XmlRpcValue::TypeInt ||
+        connection[3].getType() != XmlRpcValue::TypeInt)
+      {
+        continue;
+      }
+      const int id = connection[0];
+      const int drops = connection[3];
+      connection_drops[id] = drops;
+
+      // New connections start from no drops. roscpp counts them on 32 bits,
+      // which may wrap.
+      const auto previous = connection_drops_.find(id);
+      const int previous_drops =
+        previous != connection_drops_.end() ? previous->second : 0;
+      overflows += static_cast<uint32_t>(drops) -
+        static_cast<uint32_t>(previous_drops);
+    }
+    if (overflows == 0) {
+      continue;
+    }
+
+    for (auto & entry : entries_) {
+      auto & queue = entry.metrics->queue();
+      if (queue.enabled() && queue.topic() == topic) {
+        queue.add_overflows(overflows);
+        entry.metrics->record_drop(overflows);
+      }
+    }
+  }
+
+  // Closed connections are forgotten, their drops were already added
+  connection_drops_.swap(connection_drops);
+}
+
+//////////////////////////////////////////////////
+ros_ign_bridge::BridgeStatus
+MetricsRegistry::bridge_status(const ros::Time & stamp)
+{
+  ros_ign_bridge::BridgeStatus status;
+  status.header.stamp = stamp;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & entry : entries_) {
+    auto & queue = entry.metrics->queue();
+    if (!queue.enabled()) {
+      continue;
+    }
+
+    const auto overflows = queue.overflows();
+
+    ros_ign_bridge::QueueStatus queue_status;
+    queue_status.topic = entry.metrics->topic_name_;
+    queue_status.direction = entry.metrics->direction_;
+    queue_status.queue_size = queue.queue_size();
+    queue_status.depth = queue.depth();
+    queue_status.high_water_mark = queue.take_high_water_mark();
+    queue_status.overflows = overflows - entry.previous_overflows;
+    queue_status.total_overflows = overflows;
+    status.queues.push_back(queue_status);
+
+    entry.previous_overflows = overflows;
+  }
+  return status;
+}
+
+//////////////////////////////////////////////////
+std::string
+MetricsRegistry::dump() const
+{
+  std::ostringstream stream;
+  stream << "topic, direction, messages, dropped, bytes in, bytes out, "
+         << "convert p50/p99/p999/max (us), publish p50/p99/p999/max (us)\n";
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto & entry : entries_) {
+    const auto & metrics = *entry.metrics;
+    auto current = metrics.snapshot();
+    stream << metrics.topic_name_ << ", " << metrics.direction_ << ", "
+           << current.messages << ", " << current.dropped << ", "
+           << current.bytes_in << ", " << current.bytes_out << ", "
+           << summary(current.convert) << ", " << summary(current.publish)
+           << "\n";
+  }
+  return stream.str();
+}
+
+}  // namespace ros_ign_bridge
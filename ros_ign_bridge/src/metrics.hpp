@@ -0,0 +1,417 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_BRIDGE__METRICS_HPP_
+#define ROS_IGN_BRIDGE__METRICS_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros/time.h>
+#include <ros_ign_bridge/BridgeStatus.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+namespace ros_ign_bridge
+{
+
+/// Histogram of durations in nanoseconds, bucketed like HdrHistogram: by the
+/// position of the highest set bit and the 3 bits below it. Every bucket is
+/// within 1/8 of the values in it, from nanoseconds up to minutes,
+/// with a fixed number of buckets.
+class LatencyHistogram
+{
+public:
+  /// Bits of precision below the highest set bit
+  static constexpr int kSubBucketBits = 3;
+
+  /// Buckets per power of two
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+
+  /// Highest set bit with buckets of its own. Values from 2^37 ns, about
+  /// 137 s, share the last bucket.
+  static constexpr int kMaxExponent = 36;
+
+  /// Total number of buckets
+  static constexpr size_t kBucketCount =
+    kSubBuckets * (kMaxExponent - kSubBucketBits + 2);
+
+  /// Counts per bucket
+  using Counts = std::array<uint64_t, kBucketCount>;
+
+  /// Record a duration. Lock free, safe to call from any thread.
+  void
+  record(uint64_t nanoseconds)
+  {
+    counts_[bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Add the counts of this histogram to counts.
+  void
+  add_to(Counts & counts) const;
+
+  /// Bucket holding a value.
+  static size_t
+  bucket_index(uint64_t nanoseconds);
+
+  /// Highest value falling in a bucket.
+  static uint64_t
+  bucket_value(size_t index);
+
+  /// Value below which a fraction of the recorded values fall.
+  /// \param[in] counts Counts per bucket
+  /// \param[in] quantile Fraction, from 0 to 1
+  /// \return Highest value of the bucket holding the quantile, 0 if empty.
+  static uint64_t
+  quantile(const Counts & counts, double quantile);
+
+private:
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+};
+
+/// Occupancy of a roscpp subscriber queue, which holds up to its queue size
+/// and drops its oldest message when full. roscpp doesn't expose it, so it's
+/// mirrored. roscpp schedules a callback for each message it pushes into a
+/// queue which isn't full, see MonitoredCallbackQueue, and each of those
+/// callbacks pops a message and passes it to the bridge, which pops from the
+/// mirror. A message pushed into a full queue replaces the oldest one
+/// without scheduling a callback, so overflows are invisible to the mirror.
+/// roscpp counts them per connection though, and they're added from its bus
+/// statistics, see MetricsRegistry::update_overflows.
+///
+/// Pushes and pops happen on different threads, so the depth is a single
+/// atomic, without locks.
+class QueueMonitor
+{
+public:
+  /// Start mirroring a queue, before it receives messages.
+  /// \param[in] queue_size Size of the queue, 0 if unbounded
+  /// \param[in] topic Subscribed topic, resolved as in the bus statistics
+  void
+  enable(uint32_t queue_size, const std::string & topic)
+  {
+    queue_size_ = queue_size;
+    topic_ = topic;
+    enabled_ = true;
+  }
+
+  /// Whether a queue is mirrored.
+  bool
+  enabled() const
+  {
+    return enabled_;
+  }
+
+  /// Size of the queue, 0 if unbounded.
+  uint32_t
+  queue_size() const
+  {
+    return queue_size_;
+  }
+
+  /// Subscribed topic, resolved.
+  const std::string &
+  topic() const
+  {
+    return topic_;
+  }
+
+  /// roscpp scheduled a callback for a message it pushed.
+  void
+  push()
+  {
+    const auto depth =
+      clamp(depth_.fetch_add(1, std::memory_order_relaxed) + 1);
+    auto high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+    while (depth > high_water_mark &&
+      !high_water_mark_.compare_exchange_weak(
+        high_water_mark, depth, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  /// The bridge received a message popped from the queue.
+  void
+  pop()
+  {
+    auto depth = depth_.load(std::memory_order_relaxed);
+    do {
+      if (depth == 0) {
+        return;
+      }
+    } while (!depth_.compare_exchange_weak(
+      depth, depth - 1, std::memory_order_relaxed));
+  }
+
+  /// Messages in the queue.
+  uint32_t
+  depth() const
+  {
+    return clamp(depth_.load(std::memory_order_relaxed));
+  }
+
+  /// Most messages in the queue at once since the previous call, which
+  /// restarts from the current depth.
+  uint32_t
+  take_high_water_mark()
+  {
+    return high_water_mark_.exchange(depth(), std::memory_order_relaxed);
+  }
+
+  /// Add messages dropped because the queue was full.
+  void
+  add_overflows(uint64_t count)
+  {
+    overflows_.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /// Messages dropped because the queue was full.
+  uint64_t
+  overflows() const
+  {
+    return overflows_.load(std::memory_order_relaxed);
+  }
+
+private:
+  /// Clamp a depth to the queue size. roscpp pops from its queue just before
+  /// calling the bridge, so a message arriving meanwhile can push the mirror
+  /// one beyond it.
+  uint32_t
+  clamp(uint32_t depth) const
+  {
+    return queue_size_ > 0 ? std::min(depth, queue_size_) : depth;
+  }
+
+  bool enabled_{false};
+  uint32_t queue_size_{0};
+  std::string topic_;
+  std::atomic<uint32_t> depth_{0};
+  std::atomic<uint32_t> high_water_mark_{0};
+  std::atomic<uint64_t> overflows_{0};
+};
+
+/// Totals of a bridge's counters, merged from all threads.
+struct MetricsSnapshot
+{
+  /// Messages converted and published
+  uint64_t messages{0};
+
+  /// Messages dropped, before or after conversion
+  uint64_t dropped{0};
+
+  /// Serialized bytes received
+  uint64_t bytes_in{0};
+
+  /// Serialized bytes published
+  uint64_t bytes_out{0};
+
+  /// Conversion durations
+  LatencyHistogram::Counts convert{};
+
+  /// Publish durations
+  LatencyHistogram::Counts publish{};
+};
+
+/// Counters of one bridge direction, updated by the factory callbacks.
+///
+/// Callbacks for one bridge can run on several threads, the ROS spinners
+/// and Ignition Transport's. Counters are split into shards on separate
+/// cache lines, and each thread updates its own with relaxed atomics, so
+/// recording never takes a lock nor bounces a cache line between threads.
+/// Readers merge all shards.
+class BridgeMetrics
+{
+public:
+  /// Number of shards, threads beyond this share them
+  static constexpr size_t kShards = 4;
+
+  /// Constructor
+  /// \param[in] topic_name Bridged topic
+  /// \param[in] direction Direction, such as "ROS to Ignition"
+  /// \param[in] ros_type_name ROS message type
+  /// \param[in] ign_type_name Ignition message type
+  BridgeMetrics(
+    const std::string & topic_name,
+    const std::string & direction,
+    const std::string & ros_type_name,
+    const std::string & ign_type_name);
+
+  /// Record a message which was converted and published.
+  /// \param[in] bytes_in Serialized size of the received message
+  /// \param[in] bytes_out Serialized size of the published message
+  /// \param[in] convert_time Time spent converting
+  /// \param[in] publish_time Time spent publishing
+  void
+  record(
+    uint64_t bytes_in,
+    uint64_t bytes_out,
+    std::chrono::steady_clock::duration convert_time,
+    std::chrono::steady_clock::duration publish_time)
+  {
+    auto & shard = local_shard();
+    shard.messages.fetch_add(1, std::memory_order_relaxed);
+    shard.bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+    shard.bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+    shard.convert.record(to_nanoseconds(convert_time));
+    shard.publish.record(to_nanoseconds(publish_time));
+  }
+
+  /// Record dropped messages.
+  /// \param[in] count Messages dropped
+  void
+  record_drop(uint64_t count = 1)
+  {
+    local_shard().dropped.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /// Merge all shards.
+  MetricsSnapshot
+  snapshot() const;
+
+  /// Subscriber queue, mirrored for bridges from ROS.
+  QueueMonitor &
+  queue()
+  {
+    return queue_;
+  }
+
+  /// Subscriber queue, mirrored for bridges from ROS.
+  const QueueMonitor &
+  queue() const
+  {
+    return queue_;
+  }
+
+  /// Bridged topic
+  const std::string topic_name_;
+
+  /// Direction, such as "ROS to Ignition"
+  const std::string direction_;
+
+  /// ROS message type
+  const std::string ros_type_name_;
+
+  /// Ignition message type
+  const std::string ign_type_name_;
+
+private:
+  /// Counters updated by the threads assigned to a shard
+  struct alignas(64) Shard
+  {
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> bytes_in{0};
+    std::atomic<uint64_t> bytes_out{0};
+    LatencyHistogram convert;
+    LatencyHistogram publish;
+  };
+
+  /// Shard of the calling thread, assigned on its first call.
+  Shard &
+  local_shard()
+  {
+    static std::atomic<size_t> next_thread{0};
+    thread_local const size_t index =
+      next_thread.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shards_[index];
+  }
+
+  /// Clamp a duration to a non-negative number of nanoseconds.
+  static uint64_t
+  to_nanoseconds(std::chrono::steady_clock::duration duration)
+  {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      duration).count();
+    return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+  }
+
+  std::array<Shard, kShards> shards_;
+
+  QueueMonitor queue_;
+};
+
+/// All bridges of a process, reported together.
+class MetricsRegistry
+{
+public:
+  /// Create the counters of a bridge direction.
+  /// \param[in] topic_name Bridged topic
+  /// \param[in] direction Direction, such as "ROS to Ignition"
+  /// \param[in] ros_type_name ROS message type
+  /// \param[in] ign_type_name Ignition message type
+  /// \return Counters to pass to the factory
+  std::shared_ptr<BridgeMetrics>
+  add(
+    const std::string & topic_name,
+    const std::string & direction,
+    const std::string & ros_type_name,
+    const std::string & ign_type_name);
+
+  /// Report every bridge, with rates and latencies since the previous call.
+  /// \param[in] stamp Time of the report
+  /// \return One status per bridge direction
+  diagnostic_msgs::DiagnosticArray
+  diagnostics(const ros::Time & stamp);
+
+  /// Add the messages dropped by roscpp from full subscriber queues since
+  /// the previous call, which it counts per connection, to the overflows and
+  /// drops of the bridges subscribed to their topics. Bridges subscribed to
+  /// the same topic share a roscpp subscription, so each gets all its drops.
+  /// \param[in] bus_stats Statistics returned by the getBusStats XML-RPC
+  /// call of the node: publications, then subscriptions, each a topic and a
+  /// list of connections with their id, bytes, messages and drops
+  void
+  update_overflows(XmlRpc::XmlRpcValue & bus_stats);
+
+  /// Report the subscriber queue of every bridge which has one, with its
+  /// high-water mark and overflows since the previous call.
+  /// \param[in] stamp Time of the report
+  /// \return One queue status per bridge from ROS
+  ros_ign_bridge::BridgeStatus
+  bridge_status(const ros::Time & stamp);
+
+  /// Human readable table of every bridge, with totals and latencies since
+  /// the bridge was created.
+  std::string
+  dump() const;
+
+private:
+  /// A bridge and its counters at the previous report
+  struct Entry
+  {
+    std::shared_ptr<BridgeMetrics> metrics;
+    MetricsSnapshot previous;
+    ros::Time previous_stamp;
+    uint64_t previous_overflows{0};
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Entry> entries_;
+
+  /// Drops of each subscriber connection at the previous update, by id
+  std::map<int, int> connection_drops_;
+};
+
+}  // namespace ros_ign_bridge
+
+#endif  // ROS_IGN_BRIDGE__METRICS_HPP_
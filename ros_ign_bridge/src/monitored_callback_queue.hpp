@@ -0,0 +1,73 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_BRIDGE__MONITORED_CALLBACK_QUEUE_HPP_
+#define ROS_IGN_BRIDGE__MONITORED_CALLBACK_QUEUE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <ros/callback_queue_interface.h>
+
+#include "metrics.hpp"
+
+namespace ros_ign_bridge
+{
+
+/// Callback queue which counts the callbacks roscpp schedules for the
+/// subscriber of a bridge into its QueueMonitor, and passes them on to
+/// another queue which runs them, such as the global one.
+///
+/// roscpp schedules a callback only for messages pushed into a subscriber
+/// queue which wasn't full, and each callback pops one message, so counting
+/// them in here and counting the messages the bridge receives mirrors the
+/// depth of the queue. Callbacks are passed on as they are, without
+/// allocating.
+class MonitoredCallbackQueue : public ros::CallbackQueueInterface
+{
+public:
+  /// Constructor
+  /// \param[in] queue Queue running the callbacks, must outlive this one
+  /// \param[in] metrics Counters of the bridge, with its queue enabled
+  MonitoredCallbackQueue(
+    ros::CallbackQueueInterface * queue,
+    std::shared_ptr<BridgeMetrics> metrics)
+  : queue_(queue),
+    metrics_(std::move(metrics))
+  {}
+
+  void
+  addCallback(
+    const ros::CallbackInterfacePtr & callback,
+    uint64_t owner_id = 0) override
+  {
+    metrics_->queue().push();
+    queue_->addCallback(callback, owner_id);
+  }
+
+  void
+  removeByID(uint64_t owner_id) override
+  {
+    queue_->removeByID(owner_id);
+  }
+
+private:
+  ros::CallbackQueueInterface * queue_;
+  std::shared_ptr<BridgeMetrics> metrics_;
+};
+
+}  // namespace ros_ign_bridge
+
+#endif  // ROS_IGN_BRIDGE__MONITORED_CALLBACK_QUEUE_HPP_
@@ -12,10 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 // include ROS
 #ifdef __clang__
@@ -23,7 +28,14 @@
 # pragma clang diagnostic ignored "-Wunused-parameter"
 #endif
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <ros/console.h>
+#include <ros/network.h>
+#include <ros/xmlrpc_manager.h>
+#include <xmlrpcpp/XmlRpcClient.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros_ign_bridge/BridgeStatus.h>
+#include <std_srvs/Trigger.h>
 #ifdef __clang__
 # pragma clang diagnostic pop
 #endif
@@ -32,6 +44,8 @@
 #include <ignition/transport/Node.hh>
 
 #include "bridge.hpp"
+#include "metrics.hpp"
+#include "startup_profile.hpp"
 
 // Direction of bridge.
 enum Direction
@@ -67,12 +81,142 @@ void usage()
       << ".StringMsg\n\n"
       << "A bridge from ROS to Ignition example:\n"
       << "    parameter_bridge /chatter@std_msgs/String]ignition.msgs"
-      << ".StringMsg" << std::endl);
+      << ".StringMsg\n\n"
+      << "Each bridge's message rate, bandwidth and latencies are published "
+      << "on /diagnostics every\n~metrics_period seconds (1 by default, 0 "
+      << "disables it), and returned by the\n~dump_metrics service.\n\n"
+      << "Subscriber queues hold ~queue_size messages (10 by default). Their "
+      << "depth, high-water\nmark and overflows are published on "
+      << "~bridge_status every ~status_period seconds\n(1 by default, 0 "
+      << "disables it).\n\n"
+      << "Setting ~metrics to false disables both, so that messages aren't "
+      << "timed nor sized.\n\n"
+      << "Bridges are created on ~startup_threads threads (8 by default). "
+      << "With\n--profile-startup, the time spent in each step of startup is "
+      << "logged."
+      << std::endl);
+}
+
+// A bridge to create, parsed from the command line.
+struct BridgeArgument
+{
+  std::string topic_name;
+  std::string ros_type_name;
+  std::string ign_type_name;
+  Direction direction;
+};
+
+// Handles of a created bridge, only those of its direction are set.
+struct CreatedBridge
+{
+  bool created = false;
+  ros_ign_bridge::BridgeHandles bidirectional;
+  ros_ign_bridge::BridgeIgnToRosHandles ign_to_ros;
+  ros_ign_bridge::BridgeRosToIgnHandles ros_to_ign;
+};
+
+//////////////////////////////////////////////////
+/// Parse a bridge argument.
+/// \param[in] _arg Argument, in the format described by usage()
+/// \param[out] _bridge Parsed bridge
+/// \return False if the argument is malformed
+bool parseArgument(std::string _arg, BridgeArgument &_bridge)
+{
+  const std::string delim = "@";
+  auto delimPos = _arg.find(delim);
+  if (delimPos == std::string::npos || delimPos == 0)
+    return false;
+  _bridge.topic_name = _arg.substr(0, delimPos);
+  _arg.erase(0, delimPos + delim.size());
+
+  // Get the direction delimeter, which should be one of:
+  //   @ == bidirectional, or
+  //   [ == only from IGN to ROS, or
+  //   ] == only from ROS to IGN.
+  delimPos = _arg.find("@");
+  _bridge.direction = BIDIRECTIONAL;
+  if (delimPos == std::string::npos || delimPos == 0)
+  {
+    delimPos = _arg.find("[");
+    if (delimPos == std::string::npos || delimPos == 0)
+    {
+      delimPos = _arg.find("]");
+      if (delimPos == std::string::npos || delimPos == 0)
+        return false;
+      else
+        _bridge.direction = FROM_ROS_TO_IGN;
+    }
+    else
+    {
+      _bridge.direction = FROM_IGN_TO_ROS;
+    }
+  }
+  _bridge.ros_type_name = _arg.substr(0, delimPos);
+  _arg.erase(0, delimPos + delim.size());
+
+  delimPos = _arg.find(delim);
+  if (delimPos != std::string::npos || _arg.empty())
+    return false;
+  _bridge.ign_type_name = _arg;
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// Milliseconds in a duration, for the startup profile.
+double milliseconds(std::chrono::steady_clock::duration _duration)
+{
+  return std::chrono::duration<double, std::milli>(_duration).count();
+}
+
+//////////////////////////////////////////////////
+/// Statistics of the connections of this node, which roscpp only serves
+/// through the getBusStats XML-RPC call.
+/// \param[out] _stats Statistics, in the format described by
+/// MetricsRegistry::update_overflows
+/// \return False if the call failed
+bool getBusStats(XmlRpc::XmlRpcValue &_stats)
+{
+  std::string host;
+  uint32_t port;
+  if (!ros::network::splitURI(ros::XMLRPCManager::instance()->getServerURI(),
+      host, port))
+  {
+    return false;
+  }
+
+  XmlRpc::XmlRpcClient client(host.c_str(), static_cast<int>(port), "/");
+  XmlRpc::XmlRpcValue params;
+  XmlRpc::XmlRpcValue result;
+  params[0] = ros::this_node::getName();
+  if (!client.execute("getBusStats", params, result) ||
+      result.getType() != XmlRpc::XmlRpcValue::TypeArray ||
+      result.size() != 3 ||
+      result[0].getType() != XmlRpc::XmlRpcValue::TypeInt ||
+      static_cast<int>(result[0]) != 1)
+  {
+    return false;
+  }
+  _stats = result[2];
+  return true;
 }
 
 //////////////////////////////////////////////////
 int main(int argc, char * argv[])
 {
+  const auto startTime = std::chrono::steady_clock::now();
+
+  // Remove our own flags, leaving the bridges and ROS remappings
+  bool profileStartup = false;
+  int kept = 1;
+  for (auto i = 1; i < argc; ++i)
+  {
+    if (std::string(argv[i]) == "--profile-startup")
+      profileStartup = true;
+    else
+      argv[kept++] = argv[i];
+  }
+  argc = kept;
+
   if (argc < 2)
   {
     usage();
@@ -82,108 +226,226 @@ int main(int argc, char * argv[])
   // ROS node
   ros::init(argc, argv, "ros_ign_bridge");
   ros::NodeHandle ros_node;
+  ros::NodeHandle private_node("~");
 
   // Ignition node
   auto ign_node = std::make_shared<ignition::transport::Node>();
+  const auto initTime = std::chrono::steady_clock::now();
 
   std::list<ros_ign_bridge::BridgeHandles> bidirectional_handles;
   std::list<ros_ign_bridge::BridgeIgnToRosHandles> ign_to_ros_handles;
   std::list<ros_ign_bridge::BridgeRosToIgnHandles> ros_to_ign_handles;
 
+  // Counters of every bridge, unless disabled so that messages aren't timed
+  // nor sized
+  bool metrics_enabled;
+  private_node.param("metrics", metrics_enabled, true);
+  ros_ign_bridge::MetricsRegistry metrics;
+  auto metricsPtr = metrics_enabled ? &metrics : nullptr;
+
   // Parse all arguments.
-  const std::string delim = "@";
-  const size_t queue_size = 10;
+  int queue_size;
+  private_node.param("queue_size", queue_size, 10);
+  if (queue_size < 0)
+  {
+    ROS_ERROR_STREAM("Invalid ~queue_size [" << queue_size << "]");
+    return -1;
+  }
+  std::vector<BridgeArgument> bridges(argc - 1);
   for (auto i = 1; i < argc; ++i)
   {
-    std::string arg = std::string(argv[i]);
-    auto delimPos = arg.find(delim);
-    if (delimPos == std::string::npos || delimPos == 0)
+    if (!parseArgument(argv[i], bridges[i - 1]))
     {
-     usage();
-     return -1;
+      usage();
+      return -1;
     }
-    std::string topic_name = arg.substr(0, delimPos);
-    arg.erase(0, delimPos + delim.size());
-
-    // Get the direction delimeter, which should be one of:
-    //   @ == bidirectional, or
-    //   [ == only from IGN to ROS, or
-    //   ] == only from ROS to IGN.
-    delimPos = arg.find("@");
-    Direction direction = BIDIRECTIONAL;
-    if (delimPos == std::string::npos || delimPos == 0)
+  }
+  const auto parseTime = std::chrono::steady_clock::now();
+
+  // Create the bridges on a pool of threads. Every ROS publisher and
+  // subscriber registers with the master through its own XML-RPC round-trip,
+  // which roscpp can't batch, so they're overlapped instead.
+  int startup_threads;
+  private_node.param("startup_threads", startup_threads, 8);
+  const size_t threadCount = std::min<size_t>(
+      std::max(startup_threads, 1), bridges.size());
+
+  ros_ign_bridge::StartupProfile profile;
+  auto profilePtr = profileStartup ? &profile : nullptr;
+  std::vector<CreatedBridge> created(bridges.size());
+  std::atomic<size_t> next{0};
+  auto createBridges = [&]()
+  {
+    for (size_t i = next++; i < bridges.size(); i = next++)
     {
-      delimPos = arg.find("[");
-      if (delimPos == std::string::npos || delimPos == 0)
+      const auto &bridge = bridges[i];
+      try
       {
-        delimPos = arg.find("]");
-        if (delimPos == std::string::npos || delimPos == 0)
+        switch (bridge.direction)
         {
-          usage();
-          return -1;
-        }
-        else
-        {
-          direction = FROM_ROS_TO_IGN;
+          default:
+          case BIDIRECTIONAL:
+            created[i].bidirectional =
+                ros_ign_bridge::create_bidirectional_bridge(
+                  ros_node, ign_node,
+                  bridge.ros_type_name, bridge.ign_type_name,
+                  bridge.topic_name, queue_size, metricsPtr, profilePtr);
+            break;
+          case FROM_IGN_TO_ROS:
+            created[i].ign_to_ros =
+                ros_ign_bridge::create_bridge_from_ign_to_ros(
+                  ign_node, ros_node,
+                  bridge.ign_type_name, bridge.topic_name, queue_size,
+                  bridge.ros_type_name, bridge.topic_name, queue_size,
+                  metricsPtr, profilePtr);
+            break;
+          case FROM_ROS_TO_IGN:
+            created[i].ros_to_ign =
+                ros_ign_bridge::create_bridge_from_ros_to_ign(
+                  ros_node, ign_node,
+                  bridge.ros_type_name, bridge.topic_name, queue_size,
+                  bridge.ign_type_name, bridge.topic_name, queue_size,
+                  metricsPtr, profilePtr);
+            break;
         }
+        created[i].created = true;
       }
-      else
+      catch (std::runtime_error &_e)
       {
-        direction = FROM_IGN_TO_ROS;
+        ROS_ERROR_STREAM("Failed to create a bridge for topic ["
+            << bridge.topic_name << "] "
+            << "with ROS type [" << bridge.ros_type_name << "] and "
+            << "Ignition Transport type [" << bridge.ign_type_name << "]"
+            << std::endl);
       }
     }
-    std::string ros_type_name = arg.substr(0, delimPos);
-    arg.erase(0, delimPos + delim.size());
+  };
 
-    delimPos = arg.find(delim);
-    if (delimPos != std::string::npos || arg.empty())
-    {
-      usage();
-      return -1;
-    }
-    std::string ign_type_name = arg;
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < threadCount; ++i)
+    threads.emplace_back(createBridges);
+  createBridges();
+  for (auto &thread : threads)
+    thread.join();
 
-    try
-    {
-      switch (direction)
-      {
-        default:
-        case BIDIRECTIONAL:
-          bidirectional_handles.push_back(
-              ros_ign_bridge::create_bidirectional_bridge(
-                ros_node, ign_node,
-                ros_type_name, ign_type_name,
-                topic_name, queue_size));
-          break;
-        case FROM_IGN_TO_ROS:
-          ign_to_ros_handles.push_back(
-              ros_ign_bridge::create_bridge_from_ign_to_ros(
-                ign_node, ros_node,
-                ign_type_name, topic_name, queue_size,
-                ros_type_name, topic_name, queue_size));
-          break;
-        case FROM_ROS_TO_IGN:
-          ros_to_ign_handles.push_back(
-              ros_ign_bridge::create_bridge_from_ros_to_ign(
-                ros_node, ign_node,
-                ros_type_name, topic_name, queue_size,
-                ign_type_name, topic_name, queue_size));
-          break;
-      }
-    }
-    catch (std::runtime_error &_e)
+  size_t createdCount = 0;
+  for (size_t i = 0; i < bridges.size(); ++i)
+  {
+    if (!created[i].created)
+      continue;
+    ++createdCount;
+    switch (bridges[i].direction)
     {
-      ROS_ERROR_STREAM("Failed to create a bridge for topic ["
-          << topic_name << "] "
-          << "with ROS type [" << ros_type_name << "] and "
-          << "Ignition Transport type [" << ign_type_name << "]"
-          << std::endl);
+      default:
+      case BIDIRECTIONAL:
+        bidirectional_handles.push_back(created[i].bidirectional);
+        break;
+      case FROM_IGN_TO_ROS:
+        ign_to_ros_handles.push_back(created[i].ign_to_ros);
+        break;
+      case FROM_ROS_TO_IGN:
+        ros_to_ign_handles.push_back(created[i].ros_to_ign);
+        break;
     }
   }
+  created.clear();
+  const auto createTime = std::chrono::steady_clock::now();
+
+  // Periodic report
+  double metrics_period;
+  private_node.param("metrics_period", metrics_period, 1.0);
+  ros::Publisher diagnostics_pub;
+  ros::Timer metrics_timer;
+  if (metrics_enabled && metrics_period > 0.0)
+  {
+    diagnostics_pub =
+        ros_node.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    metrics_timer = ros_node.createTimer(ros::Duration(metrics_period),
+        [&](const ros::TimerEvent &)
+        {
+          diagnostics_pub.publish(metrics.diagnostics(ros::Time::now()));
+        });
+  }
+
+  // Backpressure, on a thread of its own so that the XML-RPC round-trip for
+  // the bus statistics doesn't hold up the bridges
+  double status_period;
+  private_node.param("status_period", status_period, 1.0);
+  ros::CallbackQueue status_queue;
+  ros::AsyncSpinner status_spinner(1, &status_queue);
+  ros::NodeHandle status_node;
+  status_node.setCallbackQueue(&status_queue);
+  ros::Publisher status_pub;
+  ros::Timer status_timer;
+  if (metrics_enabled && status_period > 0.0)
+  {
+    status_pub = private_node.advertise<ros_ign_bridge::BridgeStatus>(
+        "bridge_status", 1);
+    status_timer = status_node.createTimer(ros::Duration(status_period),
+        [&](const ros::TimerEvent &)
+        {
+          // roscpp doesn't schedule callbacks for the messages it drops from
+          // full subscriber queues, it only counts them
+          XmlRpc::XmlRpcValue bus_stats;
+          if (getBusStats(bus_stats))
+            metrics.update_overflows(bus_stats);
+
+          auto status = metrics.bridge_status(ros::Time::now());
+          for (const auto & queue : status.queues)
+          {
+            if (queue.overflows > 0)
+            {
+              ROS_WARN_STREAM_THROTTLE(10.0, "Queue of [" << queue.topic
+                  << "] dropped " << queue.overflows << " messages, consider "
+                  << "a larger ~queue_size");
+            }
+          }
+          status_pub.publish(status);
+        });
+    status_spinner.start();
+  }
+
+  // Report on demand
+  ros::ServiceServer dump_service;
+  if (metrics_enabled)
+  {
+    dump_service = private_node.advertiseService<
+        std_srvs::Trigger::Request, std_srvs::Trigger::Response>(
+        "dump_metrics",
+        [&metrics](std_srvs::Trigger::Request &,
+            std_srvs::Trigger::Response & _res)
+        {
+          _res.success = true;
+          _res.message = metrics.dump();
+          return true;
+        });
+  }
 
   // ROS asynchronous spinner
   ros::AsyncSpinner async_spinner(1);
   async_spinner.start();
+  const auto readyTime = std::chrono::steady_clock::now();
+
+  if (profileStartup)
+  {
+    // Steps of bridge creation are summed over all threads
+    ROS_INFO_STREAM("Startup profile (ms):\n"
+        << "  Initialize ROS and Ignition nodes: "
+        << milliseconds(initTime - startTime) << "\n"
+        << "  Parse " << bridges.size() << " arguments: "
+        << milliseconds(parseTime - initTime) << "\n"
+        << "  Create " << createdCount << " bridges on " << threadCount
+        << " threads: " << milliseconds(createTime - parseTime) << "\n"
+        << "    Look up factories, summed over threads: "
+        << profile.factory_ns / 1e6 << "\n"
+        << "    Create ROS publishers and subscribers, summed over threads: "
+        << profile.ros_ns / 1e6 << "\n"
+        << "    Create Ignition publishers and subscribers, summed over "
+        << "threads: " << profile.ign_ns / 1e6 << "\n"
+        << "  Advertise reports and services: "
+        << milliseconds(readyTime - createTime) << "\n"
+        << "  Total: " << milliseconds(readyTime - startTime));
+  }
 
   // Zzzzzz.
   ignition::transport::waitForShutdown();
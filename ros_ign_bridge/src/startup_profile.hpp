@@ -0,0 +1,74 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_BRIDGE__STARTUP_PROFILE_HPP_
+#define ROS_IGN_BRIDGE__STARTUP_PROFILE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ros_ign_bridge
+{
+
+/// Time spent in each step of creating bridges, summed over all the threads
+/// creating them. Reported by parameter_bridge's --profile-startup.
+struct StartupProfile
+{
+  /// Looking up factories
+  std::atomic<uint64_t> factory_ns{0};
+
+  /// Creating ROS publishers and subscribers, which register with the master
+  std::atomic<uint64_t> ros_ns{0};
+
+  /// Creating Ignition Transport publishers and subscribers
+  std::atomic<uint64_t> ign_ns{0};
+};
+
+/// Adds the time from its construction to its destruction to a counter.
+/// Does nothing without a counter, so it costs nothing when not profiling.
+class ScopedStartupTimer
+{
+public:
+  /// Constructor
+  /// \param[in] counter Nanoseconds to add to, or null
+  explicit ScopedStartupTimer(std::atomic<uint64_t> * counter)
+  : counter_(counter)
+  {
+    if (counter_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedStartupTimer()
+  {
+    if (counter_) {
+      counter_->fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_).count(),
+        std::memory_order_relaxed);
+    }
+  }
+
+  ScopedStartupTimer(const ScopedStartupTimer &) = delete;
+  ScopedStartupTimer & operator=(const ScopedStartupTimer &) = delete;
+
+private:
+  std::atomic<uint64_t> * counter_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace ros_ign_bridge
+
+#endif  // ROS_IGN_BRIDGE__STARTUP_PROFILE_HPP_
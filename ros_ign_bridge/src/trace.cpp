@@ -0,0 +1,179 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "ros_ign_bridge/trace.hpp"
+
+namespace ros_ign_bridge
+{
+
+namespace
+{
+
+/// Write a string as a JSON string.
+void
+write_json_string(std::ostream & stream, const std::string & value)
+{
+  stream << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      stream << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      stream << escaped;
+    } else {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+/// Write nanoseconds as microseconds with three decimals, exact however long
+/// the clock has been running, unlike streaming a double.
+void
+write_microseconds(std::ostream & stream, int64_t ns)
+{
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%s%lld.%03lld",
+    ns < 0 ? "-" : "",
+    static_cast<long long>(std::llabs(ns) / 1000),
+    static_cast<long long>(std::llabs(ns) % 1000));
+  stream << buffer;
+}
+
+/// Ids of recorders, never reused unlike their addresses
+std::atomic<uint64_t> next_id{1};
+
+}  // namespace
+
+//////////////////////////////////////////////////
+TraceRecorder::TraceRecorder(const std::string & path)
+: path_(path),
+  id_(next_id++)
+{
+}
+
+//////////////////////////////////////////////////
+TraceRecorder::~TraceRecorder()
+{
+  if (!path_.empty()) {
+    write(path_);
+  }
+}
+
+//////////////////////////////////////////////////
+TraceRecorder *
+TraceRecorder::instance()
+{
+  static std::unique_ptr<TraceRecorder> recorder = []
+    {
+      const char * path = std::getenv("ROS_IGN_BRIDGE_TRACE_FILE");
+      return path && *path ?
+             std::unique_ptr<TraceRecorder>(new TraceRecorder(path)) : nullptr;
+    }();
+  return recorder.get();
+}
+
+//////////////////////////////////////////////////
+void
+TraceRecorder::record(
+  const char * name,
+  const std::string & detail,
+  char phase,
+  std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::duration duration)
+{
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  auto & buffer = local_buffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events.push_back({name, detail, phase,
+      duration_cast<nanoseconds>(start.time_since_epoch()).count(),
+      duration_cast<nanoseconds>(duration).count()});
+}
+
+//////////////////////////////////////////////////
+TraceRecorder::Buffer &
+TraceRecorder::local_buffer()
+{
+  // Buffers are shared with the recorder, so events outlive their thread
+  thread_local std::shared_ptr<Buffer> buffer;
+  thread_local uint64_t owner{0};
+  if (!buffer || owner != id_) {
+    static std::atomic<uint32_t> next_thread_id{1};
+    buffer = std::make_shared<Buffer>();
+    buffer->thread_id = next_thread_id++;
+    owner = id_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(buffer);
+  }
+  return *buffer;
+}
+
+//////////////////////////////////////////////////
+bool
+TraceRecorder::write(const std::string & path) const
+{
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  const auto pid = static_cast<int>(getpid());
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto & buffer : buffers_) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    for (const auto & event : buffer->events) {
+      file << (first ? "\n" : ",\n");
+      first = false;
+
+      // Chrome traces are in microseconds
+      file << "{\"name\":";
+      write_json_string(file, event.name);
+      file << ",\"cat\":\"ros_ign\",\"ph\":\"" << event.phase << "\""
+           << ",\"pid\":" << pid << ",\"tid\":" << buffer->thread_id
+           << ",\"ts\":";
+      write_microseconds(file, event.start_ns);
+      if (event.phase == 'X') {
+        file << ",\"dur\":";
+        write_microseconds(file, event.duration_ns);
+      } else if (event.phase == 'i') {
+        file << ",\"s\":\"t\"";
+      }
+      if (!event.detail.empty()) {
+        file << ",\"args\":{\"detail\":";
+        write_json_string(file, event.detail);
+        file << "}";
+      }
+      file << "}";
+    }
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
+
+}  // namespace ros_ign_bridge
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ros_ign_bridge/convert.hpp"
+#include "benchmarks/sized_msgs.h"
+
+// Counts the heap allocations of every conversion, by replacing malloc for
+// the whole test. operator new and protobuf allocate through it.
+//
+// Budgets are for the steady state: converting into a message which already
+// held a conversion of the same size, as a bridge reusing its messages
+// would. A new message always allocates its fields, and how often depends on
+// the protobuf version, so that isn't checked.
+
+/// \brief Whether allocations are counted.
+static bool g_counting = false;
+
+/// \brief Allocations counted.
+static size_t g_allocations = 0;
+
+extern "C"
+{
+void *__libc_malloc(size_t _size);
+void *__libc_calloc(size_t _count, size_t _size);
+void *__libc_realloc(void *_ptr, size_t _size);
+
+/////////////////////////////////////////////////
+void *malloc(size_t _size)
+{
+  if (g_counting)
+    ++g_allocations;
+  return __libc_malloc(_size);
+}
+
+/////////////////////////////////////////////////
+void *calloc(size_t _count, size_t _size)
+{
+  if (g_counting)
+    ++g_allocations;
+  return __libc_calloc(_count, _size);
+}
+
+/////////////////////////////////////////////////
+void *realloc(void *_ptr, size_t _size)
+{
+  if (g_counting)
+    ++g_allocations;
+  return __libc_realloc(_ptr, _size);
+}
+}
+
+namespace ros_ign_bridge
+{
+namespace testing
+{
+  /// \brief Nothing to fill in.
+  void createTestMsg(std_msgs::Empty &, int64_t)
+  {
+  }
+}
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the allocations of the third conversion into the same
+/// message.
+/// \param[in] _in Message to convert
+/// \param[in] _convert Conversion
+/// \return Number of allocations
+template<typename IN_T, typename OUT_T>
+size_t steadyAllocations(const IN_T &_in,
+    void (*_convert)(const IN_T &, OUT_T &))
+{
+  OUT_T out;
+  _convert(_in, out);
+  _convert(_in, out);
+
+  g_allocations = 0;
+  g_counting = true;
+  _convert(_in, out);
+  g_counting = false;
+  return g_allocations;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the allocations of a pair of types, in both directions.
+/// \param[in] _size Size of the messages, see sized_msgs.h
+/// \param[in] _rosToIgn Allocations allowed from ROS to Ignition
+/// \param[in] _ignToRos Allocations allowed from Ignition to ROS
+template<typename ROS_T, typename IGN_T>
+void checkBudget(int64_t _size, size_t _rosToIgn, size_t _ignToRos)
+{
+  ROS_T rosMsg;
+  ros_ign_bridge::testing::createTestMsg(rosMsg, _size);
+  IGN_T ignMsg;
+  ros_ign_bridge::convert_ros_to_ign(rosMsg, ignMsg);
+  SCOPED_TRACE(ignMsg.GetTypeName());
+
+  auto rosToIgn = steadyAllocations<ROS_T, IGN_T>(rosMsg,
+      &ros_ign_bridge::convert_ros_to_ign);
+  EXPECT_LE(rosToIgn, _rosToIgn) << "ROS to Ignition";
+
+  auto ignToRos = steadyAllocations<IGN_T, ROS_T>(ignMsg,
+      &ros_ign_bridge::convert_ign_to_ros);
+  EXPECT_LE(ignToRos, _ignToRos) << "Ignition to ROS";
+}
+
+/////////////////////////////////////////////////
+/// \brief Check that converting into a message which already held a
+/// conversion gives the same result as a new message, which budgets rely on.
+template<typename ROS_T, typename IGN_T>
+void checkReuse()
+{
+  ROS_T rosMsg;
+  ros_ign_bridge::testing::createTestMsg(rosMsg);
+  IGN_T ignMsg;
+  ros_ign_bridge::testing::createTestMsg(ignMsg);
+  SCOPED_TRACE(ignMsg.GetTypeName());
+
+  IGN_T ignOut;
+  ros_ign_bridge::convert_ros_to_ign(rosMsg, ignOut);
+  ros_ign_bridge::convert_ros_to_ign(rosMsg, ignOut);
+  ros_ign_bridge::testing::compareTestMsg(ignOut);
+
+  ROS_T rosOut;
+  ros_ign_bridge::convert_ign_to_ros(ignMsg, rosOut);
+  ros_ign_bridge::convert_ign_to_ros(ignMsg, rosOut);
+  ros_ign_bridge::testing::compareTestMsg(rosOut);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, Counting)
+{
+  g_allocations = 0;
+  g_counting = true;
+  std::string *text = new std::string(64, 'a');
+  g_counting = false;
+  delete text;
+
+  EXPECT_EQ(2u, g_allocations);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, StdMsgs)
+{
+  checkBudget<std_msgs::Bool, ignition::msgs::Boolean>(0, 0, 0);
+  checkBudget<std_msgs::ColorRGBA, ignition::msgs::Color>(0, 0, 0);
+  checkBudget<std_msgs::Empty, ignition::msgs::Empty>(0, 0, 0);
+  checkBudget<std_msgs::Int32, ignition::msgs::Int32>(0, 0, 0);
+  checkBudget<std_msgs::Float32, ignition::msgs::Float>(0, 0, 0);
+  checkBudget<std_msgs::Float64, ignition::msgs::Double>(0, 0, 0);
+  checkBudget<std_msgs::Header, ignition::msgs::Header>(0, 0, 0);
+  checkBudget<std_msgs::String, ignition::msgs::StringMsg>(0, 0, 0);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, GeometryMsgs)
+{
+  checkBudget<rosgraph_msgs::Clock, ignition::msgs::Clock>(0, 0, 0);
+  checkBudget<geometry_msgs::Quaternion, ignition::msgs::Quaternion>(0, 0, 0);
+  checkBudget<geometry_msgs::Vector3, ignition::msgs::Vector3d>(0, 0, 0);
+  checkBudget<geometry_msgs::Point, ignition::msgs::Vector3d>(0, 0, 0);
+  checkBudget<geometry_msgs::Pose, ignition::msgs::Pose>(0, 0, 0);
+  checkBudget<geometry_msgs::PoseStamped, ignition::msgs::Pose>(0, 0, 0);
+  checkBudget<geometry_msgs::Transform, ignition::msgs::Pose>(0, 0, 0);
+  checkBudget<geometry_msgs::TransformStamped, ignition::msgs::Pose>(
+      0, 0, 0);
+  checkBudget<geometry_msgs::Twist, ignition::msgs::Twist>(0, 0, 0);
+  checkBudget<geometry_msgs::PoseArray, ignition::msgs::Pose_V>(64, 0, 0);
+  checkBudget<tf2_msgs::TFMessage, ignition::msgs::Pose_V>(64, 0, 0);
+  checkBudget<mav_msgs::Actuators, ignition::msgs::Actuators>(0, 0, 0);
+  checkBudget<nav_msgs::Odometry, ignition::msgs::Odometry>(0, 0, 0);
+  checkBudget<nav_msgs::OccupancyGrid, ignition::msgs::OccupancyGrid>(
+      512, 0, 0);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, SensorMsgs)
+{
+  checkBudget<sensor_msgs::BatteryState, ignition::msgs::BatteryState>(
+      0, 0, 0);
+  checkBudget<sensor_msgs::CameraInfo, ignition::msgs::CameraInfo>(0, 0, 0);
+  checkBudget<sensor_msgs::FluidPressure, ignition::msgs::FluidPressure>(
+      0, 0, 0);
+  checkBudget<sensor_msgs::Imu, ignition::msgs::IMU>(0, 0, 0);
+  checkBudget<sensor_msgs::MagneticField, ignition::msgs::Magnetometer>(
+      0, 0, 0);
+  checkBudget<sensor_msgs::JointState, ignition::msgs::Model>(32, 0, 0);
+  checkBudget<sensor_msgs::LaserScan, ignition::msgs::LaserScan>(1080, 0, 0);
+  checkBudget<visualization_msgs::Marker, ignition::msgs::Marker>(0, 0, 0);
+  checkBudget<visualization_msgs::MarkerArray, ignition::msgs::Marker_V>(
+      0, 0, 0);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, Images)
+{
+  // Camera sized images and clouds must never allocate once warmed up
+  checkBudget<sensor_msgs::Image, ignition::msgs::Image>(640, 0, 0);
+  checkBudget<sensor_msgs::Image, ignition::msgs::Image>(1920, 0, 0);
+  checkBudget<sensor_msgs::PointCloud2, ignition::msgs::PointCloudPacked>(
+      32768, 0, 0);
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, Reuse)
+{
+  checkReuse<std_msgs::Bool, ignition::msgs::Boolean>();
+  checkReuse<std_msgs::ColorRGBA, ignition::msgs::Color>();
+  checkReuse<std_msgs::Int32, ignition::msgs::Int32>();
+  checkReuse<std_msgs::Float32, ignition::msgs::Float>();
+  checkReuse<std_msgs::Float64, ignition::msgs::Double>();
+  checkReuse<std_msgs::Header, ignition::msgs::Header>();
+  checkReuse<std_msgs::String, ignition::msgs::StringMsg>();
+  checkReuse<rosgraph_msgs::Clock, ignition::msgs::Clock>();
+  checkReuse<geometry_msgs::Quaternion, ignition::msgs::Quaternion>();
+  checkReuse<geometry_msgs::Vector3, ignition::msgs::Vector3d>();
+  checkReuse<geometry_msgs::Point, ignition::msgs::Vector3d>();
+  checkReuse<geometry_msgs::Pose, ignition::msgs::Pose>();
+  checkReuse<geometry_msgs::PoseStamped, ignition::msgs::Pose>();
+  checkReuse<geometry_msgs::Transform, ignition::msgs::Pose>();
+  checkReuse<geometry_msgs::TransformStamped, ignition::msgs::Pose>();
+  checkReuse<geometry_msgs::Twist, ignition::msgs::Twist>();
+  checkReuse<geometry_msgs::PoseArray, ignition::msgs::Pose_V>();
+  checkReuse<tf2_msgs::TFMessage, ignition::msgs::Pose_V>();
+  checkReuse<mav_msgs::Actuators, ignition::msgs::Actuators>();
+  checkReuse<nav_msgs::Odometry, ignition::msgs::Odometry>();
+  checkReuse<nav_msgs::OccupancyGrid, ignition::msgs::OccupancyGrid>();
+  checkReuse<sensor_msgs::BatteryState, ignition::msgs::BatteryState>();
+  checkReuse<sensor_msgs::CameraInfo, ignition::msgs::CameraInfo>();
+  checkReuse<sensor_msgs::FluidPressure, ignition::msgs::FluidPressure>();
+  checkReuse<sensor_msgs::Imu, ignition::msgs::IMU>();
+  checkReuse<sensor_msgs::MagneticField, ignition::msgs::Magnetometer>();
+  checkReuse<sensor_msgs::Image, ignition::msgs::Image>();
+  checkReuse<sensor_msgs::JointState, ignition::msgs::Model>();
+  checkReuse<sensor_msgs::LaserScan, ignition::msgs::LaserScan>();
+  checkReuse<sensor_msgs::PointCloud2, ignition::msgs::PointCloudPacked>();
+  checkReuse<visualization_msgs::Marker, ignition::msgs::Marker>();
+  checkReuse<visualization_msgs::MarkerArray, ignition::msgs::Marker_V>();
+}
+
+/////////////////////////////////////////////////
+TEST(AllocationsTest, ReuseUnsupported)
+{
+  // Markers which are converted first
+  visualization_msgs::MarkerArray rosMarkers;
+  rosMarkers.markers.resize(2);
+  rosMarkers.markers[0].type = visualization_msgs::Marker::CUBE;
+  rosMarkers.markers[0].action = visualization_msgs::Marker::DELETE;
+  rosMarkers.markers[1].type = visualization_msgs::Marker::SPHERE;
+
+  ignition::msgs::Marker_V ignMarkers;
+  ros_ign_bridge::convert_ros_to_ign(rosMarkers, ignMarkers);
+  ASSERT_EQ(2, ignMarkers.marker_size());
+  EXPECT_EQ(ignition::msgs::Marker::BOX, ignMarkers.marker(0).type());
+
+  // Unsupported types and unknown actions don't keep those of the markers
+  // converted before
+  rosMarkers.markers[0].type = visualization_msgs::Marker::CUBE_LIST;
+  rosMarkers.markers[0].action = 42;
+  rosMarkers.markers[1].type = visualization_msgs::Marker::MESH_RESOURCE;
+  ros_ign_bridge::convert_ros_to_ign(rosMarkers, ignMarkers);
+  ASSERT_EQ(2, ignMarkers.marker_size());
+  for (const auto &marker : ignMarkers.marker())
+  {
+    EXPECT_EQ(ignition::msgs::Marker::NONE, marker.type());
+    EXPECT_EQ(ignition::msgs::Marker::ADD_MODIFY, marker.action());
+  }
+
+  // Same the other way
+  ignMarkers.mutable_marker(0)->set_type(ignition::msgs::Marker::BOX);
+  ignMarkers.mutable_marker(0)->set_action(
+      ignition::msgs::Marker::DELETE_MARKER);
+  visualization_msgs::MarkerArray back;
+  ros_ign_bridge::convert_ign_to_ros(ignMarkers, back);
+  ASSERT_EQ(2u, back.markers.size());
+  EXPECT_EQ(visualization_msgs::Marker::CUBE, back.markers[0].type);
+
+  ignMarkers.mutable_marker(0)->set_type(
+      ignition::msgs::Marker::TRIANGLE_FAN);
+  ignMarkers.mutable_marker(0)->set_action(
+      static_cast<ignition::msgs::Marker::Action>(42));
+  ros_ign_bridge::convert_ign_to_ros(ignMarkers, back);
+  ASSERT_EQ(2u, back.markers.size());
+  EXPECT_EQ(visualization_msgs::Marker::ARROW, back.markers[0].type);
+  EXPECT_EQ(visualization_msgs::Marker::ADD, back.markers[0].action);
+
+  // Fields missing from the Ignition message don't keep earlier values
+  ignition::msgs::CameraInfo ignInfo;
+  ros_ign_bridge::testing::createTestMsg(ignInfo);
+  sensor_msgs::CameraInfo rosInfo;
+  ros_ign_bridge::convert_ign_to_ros(ignInfo, rosInfo);
+  EXPECT_FALSE(rosInfo.D.empty());
+
+  ignInfo.clear_distortion();
+  ignInfo.clear_intrinsics();
+  ros_ign_bridge::convert_ign_to_ros(ignInfo, rosInfo);
+  EXPECT_TRUE(rosInfo.distortion_model.empty());
+  EXPECT_TRUE(rosInfo.D.empty());
+  for (auto k : rosInfo.K)
+    EXPECT_DOUBLE_EQ(0.0, k);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,566 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Load generator and sink for a running parameter_bridge. For every topic
+// of a scenario, messages of a given type and size are published on one
+// side of the bridge at a fixed rate, stamped with the wall clock, and
+// received on the other side. Both ends run in this process, so latency
+// and loss are measured without synchronizing clocks.
+
+#include <ros/ros.h>
+#include <ros/serialization.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/msgs.hh>
+#include <ignition/transport.hh>
+
+#include "ros_ign_bridge/convert.hpp"
+#include "../../src/metrics.hpp"
+#include "sized_msgs.h"
+
+/// \brief Flag used to stop the publishers.
+static std::atomic<bool> g_stop(false);
+
+//////////////////////////////////////////////////
+/// \brief One topic of a scenario.
+struct TopicLoad
+{
+  /// \brief Topic, the same on both sides of the bridge
+  std::string topic;
+
+  /// \brief Name of the message type, such as "image"
+  std::string type;
+
+  /// \brief True to publish on ROS, false to publish on Ignition
+  bool ros_to_ign = true;
+
+  /// \brief Messages per second
+  double rate = 10.0;
+
+  /// \brief Size for messages whose size varies, such as the width of an
+  /// image. 0 for the default test message.
+  int64_t size = 0;
+};
+
+//////////////////////////////////////////////////
+/// \brief Nanoseconds since the epoch.
+int64_t toNanoseconds(int64_t _sec, int64_t _nsec)
+{
+  return _sec * 1000000000 + _nsec;
+}
+
+//////////////////////////////////////////////////
+/// \brief Stamp of a ROS message.
+template<typename T>
+ros::Time &rosStamp(T &_msg)
+{
+  return _msg.header.stamp;
+}
+
+//////////////////////////////////////////////////
+ros::Time &rosStamp(std_msgs::Header &_msg)
+{
+  return _msg.stamp;
+}
+
+//////////////////////////////////////////////////
+/// \brief Stamp of a received ROS message.
+template<typename T>
+const ros::Time &rosStamp(const T &_msg)
+{
+  return _msg.header.stamp;
+}
+
+//////////////////////////////////////////////////
+const ros::Time &rosStamp(const std_msgs::Header &_msg)
+{
+  return _msg.stamp;
+}
+
+//////////////////////////////////////////////////
+/// \brief Stamp of an Ignition message.
+template<typename T>
+ignition::msgs::Time *ignStamp(T &_msg)
+{
+  return _msg.mutable_header()->mutable_stamp();
+}
+
+//////////////////////////////////////////////////
+ignition::msgs::Time *ignStamp(ignition::msgs::Header &_msg)
+{
+  return _msg.mutable_stamp();
+}
+
+//////////////////////////////////////////////////
+/// \brief Stamp of a received Ignition message.
+template<typename T>
+const ignition::msgs::Time &ignStamp(const T &_msg)
+{
+  return _msg.header().stamp();
+}
+
+//////////////////////////////////////////////////
+const ignition::msgs::Time &ignStamp(const ignition::msgs::Header &_msg)
+{
+  return _msg.stamp();
+}
+
+//////////////////////////////////////////////////
+/// \brief Publisher and subscriber of a topic, on opposite sides of the
+/// bridge.
+class Load
+{
+  /// \brief Constructor.
+  /// \param[in] _config Topic to load
+  public: explicit Load(const TopicLoad &_config)
+    : config(_config)
+  {
+  }
+
+  /// \brief Destructor.
+  public: virtual ~Load() = default;
+
+  /// \brief Whether the bridge subscribes to the publisher and publishes to
+  /// the subscriber.
+  public: virtual bool Connected() const = 0;
+
+  /// \brief Publish a message stamped with the current time.
+  public: virtual void Publish() = 0;
+
+  /// \brief Record a received message.
+  /// \param[in] _stamp Stamp of the message, in nanoseconds
+  protected: void OnReceived(int64_t _stamp)
+  {
+    const auto now = ros::WallTime::now();
+    const auto latency = toNanoseconds(now.sec, now.nsec) - _stamp;
+    this->latency.record(std::max<int64_t>(latency, 0));
+    this->received++;
+  }
+
+  /// \brief Topic to load.
+  public: const TopicLoad config;
+
+  /// \brief Serialized size of the published message.
+  public: uint64_t messageSize = 0;
+
+  /// \brief Messages published.
+  public: std::atomic<uint64_t> published{0};
+
+  /// \brief Messages received.
+  public: std::atomic<uint64_t> received{0};
+
+  /// \brief Latency from publishing to receiving.
+  public: ros_ign_bridge::LatencyHistogram latency;
+};
+
+//////////////////////////////////////////////////
+/// \brief Load of a type pair.
+template<typename ROS_T, typename IGN_T>
+class TypedLoad : public Load
+{
+  /// \brief Constructor.
+  /// \param[in] _config Topic to load
+  /// \param[in] _rosNode ROS node
+  /// \param[in] _ignNode Ignition node, which must outlive this load
+  public: TypedLoad(const TopicLoad &_config, ros::NodeHandle &_rosNode,
+      ignition::transport::Node &_ignNode)
+    : Load(_config)
+  {
+    ros_ign_bridge::testing::createTestMsg(this->rosMsg, _config.size);
+
+    if (_config.ros_to_ign)
+    {
+      this->messageSize =
+          ros::serialization::serializationLength(this->rosMsg);
+      this->rosPub = _rosNode.advertise<ROS_T>(_config.topic, 100);
+
+      std::function<void(const IGN_T &)> cb = [this](const IGN_T &_msg)
+      {
+        const auto &stamp = ignStamp(_msg);
+        this->OnReceived(toNanoseconds(stamp.sec(), stamp.nsec()));
+      };
+      _ignNode.Subscribe(_config.topic, cb);
+    }
+    else
+    {
+      ros_ign_bridge::convert_ros_to_ign(this->rosMsg, this->ignMsg);
+      this->messageSize = this->ignMsg.ByteSizeLong();
+      this->ignPub = _ignNode.Advertise<IGN_T>(_config.topic);
+      this->rosSub = _rosNode.subscribe(_config.topic, 100,
+          &TypedLoad::OnRosMsg, this);
+    }
+  }
+
+  // Documentation inherited
+  public: bool Connected() const override
+  {
+    if (this->config.ros_to_ign)
+      return this->rosPub.getNumSubscribers() > 0;
+    return this->ignPub.HasConnections() &&
+        this->rosSub.getNumPublishers() > 0;
+  }
+
+  // Documentation inherited
+  public: void Publish() override
+  {
+    const auto now = ros::WallTime::now();
+    if (this->config.ros_to_ign)
+    {
+      rosStamp(this->rosMsg) = ros::Time(now.sec, now.nsec);
+      this->rosPub.publish(this->rosMsg);
+    }
+    else
+    {
+      ignStamp(this->ignMsg)->set_sec(now.sec);
+      ignStamp(this->ignMsg)->set_nsec(now.nsec);
+      this->ignPub.Publish(this->ignMsg);
+    }
+    this->published++;
+  }
+
+  /// \brief Callback of the ROS subscriber.
+  private: void OnRosMsg(const ROS_T &_msg)
+  {
+    const auto &stamp = rosStamp(_msg);
+    this->OnReceived(toNanoseconds(stamp.sec, stamp.nsec));
+  }
+
+  /// \brief Message published on ROS.
+  private: ROS_T rosMsg;
+
+  /// \brief Message published on Ignition.
+  private: IGN_T ignMsg;
+
+  /// \brief ROS publisher, when publishing on ROS.
+  private: ros::Publisher rosPub;
+
+  /// \brief ROS subscriber, when publishing on Ignition.
+  private: ros::Subscriber rosSub;
+
+  /// \brief Ignition publisher, when publishing on Ignition.
+  private: ignition::transport::Node::Publisher ignPub;
+};
+
+//////////////////////////////////////////////////
+/// \brief A message type which can be loaded.
+struct LoadType
+{
+  /// \brief Name used in scenarios
+  std::string name;
+
+  /// \brief ROS type, for parameter_bridge
+  std::string rosType;
+
+  /// \brief Ignition type, for parameter_bridge
+  std::string ignType;
+
+  /// \brief Create a load of this type
+  std::function<std::unique_ptr<Load>(const TopicLoad &,
+      ros::NodeHandle &, ignition::transport::Node &)> create;
+};
+
+//////////////////////////////////////////////////
+template<typename ROS_T, typename IGN_T>
+LoadType loadType(const std::string &_name, const std::string &_rosType,
+    const std::string &_ignType)
+{
+  return {_name, _rosType, _ignType,
+      [](const TopicLoad &_config, ros::NodeHandle &_rosNode,
+          ignition::transport::Node &_ignNode)
+      {
+        return std::unique_ptr<Load>(
+            new TypedLoad<ROS_T, IGN_T>(_config, _rosNode, _ignNode));
+      }};
+}
+
+//////////////////////////////////////////////////
+/// \brief Types which can be loaded, all of them stamped.
+const std::vector<LoadType> &loadTypes()
+{
+  static const std::vector<LoadType> types = {
+    loadType<std_msgs::Header, ignition::msgs::Header>(
+        "header", "std_msgs/Header", "ignition.msgs.Header"),
+    loadType<geometry_msgs::PoseStamped, ignition::msgs::Pose>(
+        "pose_stamped", "geometry_msgs/PoseStamped", "ignition.msgs.Pose"),
+    loadType<nav_msgs::OccupancyGrid, ignition::msgs::OccupancyGrid>(
+        "map", "nav_msgs/OccupancyGrid", "ignition.msgs.OccupancyGrid"),
+    loadType<nav_msgs::Odometry, ignition::msgs::Odometry>(
+        "odometry", "nav_msgs/Odometry", "ignition.msgs.Odometry"),
+    loadType<sensor_msgs::Image, ignition::msgs::Image>(
+        "image", "sensor_msgs/Image", "ignition.msgs.Image"),
+    loadType<sensor_msgs::Imu, ignition::msgs::IMU>(
+        "imu", "sensor_msgs/Imu", "ignition.msgs.IMU"),
+    loadType<sensor_msgs::JointState, ignition::msgs::Model>(
+        "joint_states", "sensor_msgs/JointState", "ignition.msgs.Model"),
+    loadType<sensor_msgs::LaserScan, ignition::msgs::LaserScan>(
+        "laserscan", "sensor_msgs/LaserScan", "ignition.msgs.LaserScan"),
+    loadType<sensor_msgs::PointCloud2, ignition::msgs::PointCloudPacked>(
+        "pointcloud2", "sensor_msgs/PointCloud2",
+        "ignition.msgs.PointCloudPacked"),
+  };
+  return types;
+}
+
+//////////////////////////////////////////////////
+/// \brief Find a type by name.
+/// \return Null if unknown
+const LoadType *findLoadType(const std::string &_name)
+{
+  for (const auto &type : loadTypes())
+  {
+    if (type.name == _name)
+      return &type;
+  }
+  return nullptr;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a scenario, one topic per line:
+///   <topic> <type> <ros_to_ign|ign_to_ros> <rate> [size]
+/// Empty lines and lines starting with # are ignored.
+/// \param[in] _path Scenario file
+/// \param[out] _topics Topics of the scenario
+/// \return False if the file can't be read or has an invalid line
+bool readScenario(const std::string &_path, std::vector<TopicLoad> &_topics)
+{
+  std::ifstream file(_path);
+  if (!file)
+  {
+    std::cerr << "Can't open scenario [" << _path << "]" << std::endl;
+    return false;
+  }
+
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(file, line))
+  {
+    ++lineNumber;
+    std::istringstream stream(line);
+    TopicLoad topic;
+    if (!(stream >> topic.topic) || topic.topic[0] == '#')
+      continue;
+
+    std::string direction;
+    stream >> topic.type >> direction >> topic.rate;
+    if (!stream || nullptr == findLoadType(topic.type) ||
+        (direction != "ros_to_ign" && direction != "ign_to_ros") ||
+        topic.rate <= 0.0)
+    {
+      std::cerr << _path << ":" << lineNumber << ": invalid topic ["
+                << line << "]" << std::endl;
+      return false;
+    }
+    topic.ros_to_ign = direction == "ros_to_ign";
+    stream >> topic.size;
+    _topics.push_back(topic);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Publish at the topic's rate until stopped. If publishing falls
+/// behind, the missed messages are skipped instead of sent in a burst.
+void publishLoop(Load &_load)
+{
+  using Clock = std::chrono::steady_clock;
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / _load.config.rate));
+
+  auto next = Clock::now();
+  while (!g_stop)
+  {
+    _load.Publish();
+    next += period;
+    const auto now = Clock::now();
+    if (next < now)
+      next = now;
+    std::this_thread::sleep_until(next);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Print a line per topic with throughput, loss and latency.
+/// \param[in] _loads Loads of the scenario
+/// \param[in] _duration Seconds spent publishing
+void report(const std::vector<std::unique_ptr<Load>> &_loads,
+    double _duration)
+{
+  std::cout << "topic, type, direction, target rate (Hz), published, "
+            << "received, received rate (Hz), throughput (MB/s), loss (%), "
+            << "latency p50/p99/p999/max (ms)" << std::endl;
+
+  for (const auto &load : _loads)
+  {
+    const uint64_t published = load->published;
+    const uint64_t received = load->received;
+    const double loss = published > 0 ?
+        100.0 * (published - std::min(received, published)) / published : 0.0;
+
+    ros_ign_bridge::LatencyHistogram::Counts counts{};
+    load->latency.add_to(counts);
+    auto ms = [&counts](double _quantile)
+    {
+      return ros_ign_bridge::LatencyHistogram::quantile(counts, _quantile) /
+          1e6;
+    };
+
+    std::cout << std::fixed << std::setprecision(3)
+              << load->config.topic << ", " << load->config.type << ", "
+              << (load->config.ros_to_ign ? "ros_to_ign" : "ign_to_ros")
+              << ", " << load->config.rate << ", "
+              << published << ", " << received << ", "
+              << received / _duration << ", "
+              << received * load->messageSize / _duration / 1e6 << ", "
+              << loss << ", "
+              << ms(0.5) << " / " << ms(0.99) << " / " << ms(0.999) << " / "
+              << ms(1.0) << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void usage()
+{
+  std::cerr <<
+      "Load a running parameter_bridge and measure latency, throughput and"
+      " loss.\n\n"
+      "  bridge_load <scenario> [--duration <seconds>] [--bridge-args]\n\n"
+      "Each line of the scenario is a topic:\n"
+      "  <topic> <type> <ros_to_ign|ign_to_ros> <rate> [size]\n\n"
+      "With --bridge-args, print the parameter_bridge arguments for the\n"
+      "scenario and exit:\n"
+      "  rosrun ros_ign_bridge parameter_bridge \\\n"
+      "    $(rosrun ros_ign_bridge bridge_load <scenario> --bridge-args)\n\n"
+      "Types and their size:\n";
+  for (const auto &type : loadTypes())
+    std::cerr << "  " << type.name << " (" << type.rosType << ")\n";
+  std::cerr << "Sizes: image width, pointcloud2 points, laserscan readings,\n"
+            << "joint_states joints, map side in cells." << std::endl;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "bridge_load", ros::init_options::AnonymousName);
+
+  std::string scenario;
+  double duration = 10.0;
+  bool bridgeArgs = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (arg == "--duration" && i + 1 < argc)
+      duration = std::stod(argv[++i]);
+    else if (arg == "--bridge-args")
+      bridgeArgs = true;
+    else if (scenario.empty() && arg[0] != '-')
+      scenario = arg;
+    else
+    {
+      usage();
+      return -1;
+    }
+  }
+
+  std::vector<TopicLoad> topics;
+  if (scenario.empty() || duration <= 0.0 || !readScenario(scenario, topics))
+  {
+    usage();
+    return -1;
+  }
+
+  if (bridgeArgs)
+  {
+    for (const auto &topic : topics)
+    {
+      const auto type = findLoadType(topic.type);
+      std::cout << topic.topic << "@" << type->rosType
+                << (topic.ros_to_ign ? "]" : "[") << type->ignType << " ";
+    }
+    std::cout << std::endl;
+    return 0;
+  }
+
+  // Declared before the node, so subscriptions are gone when they're
+  // destroyed
+  std::vector<std::unique_ptr<Load>> loads;
+  ignition::transport::Node ignNode;
+  ros::NodeHandle rosNode;
+  for (const auto &topic : topics)
+  {
+    loads.push_back(
+        findLoadType(topic.type)->create(topic, rosNode, ignNode));
+  }
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  // Wait for the bridge
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  for (const auto &load : loads)
+  {
+    while (!load->Connected() && ros::ok() &&
+        std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!load->Connected())
+    {
+      std::cerr << "The bridge isn't connected to [" << load->config.topic
+                << "], is parameter_bridge running with --bridge-args?"
+                << std::endl;
+      return -1;
+    }
+  }
+
+  // Let discovery settle on the side which can't be checked
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  std::vector<std::thread> publishers;
+  const auto start = std::chrono::steady_clock::now();
+  for (auto &load : loads)
+    publishers.emplace_back(publishLoop, std::ref(*load));
+
+  while (ros::ok() && std::chrono::steady_clock::now() - start <
+      std::chrono::duration<double>(duration))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  g_stop = true;
+  for (auto &publisher : publishers)
+    publisher.join();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  // Messages still in flight
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  spinner.stop();
+
+  report(loads, elapsed.count());
+  return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <ros/serialization.h>
+
+#include "ros_ign_bridge/convert.hpp"
+#include "sized_msgs.h"
+
+// Every conversion in convert.cpp, in both directions. Messages are built
+// like the factory does, once per conversion, and nothing needs a ROS master.
+//
+// Messages whose size varies at runtime take their size from the benchmark
+// argument. Bytes processed are the serialized size of the input message.
+
+//////////////////////////////////////////////////
+/// \brief Fill a fixed size message with the test values.
+template<typename T>
+void fill(T & _msg)
+{
+  ros_ign_bridge::testing::createTestMsg(_msg);
+}
+
+//////////////////////////////////////////////////
+void fill(std_msgs::Empty &)
+{
+}
+
+//////////////////////////////////////////////////
+void fill(ignition::msgs::Empty &)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert the same message over and over, into the same output
+/// message, so only the conversion is measured and capacity reused by the
+/// conversion pays off, as in the allocation test.
+/// \param[in] _size Serialized size of the input message
+template<typename IN_T, typename OUT_T, typename CONVERT>
+void run(benchmark::State & _state, const IN_T & _in, uint64_t _size,
+    CONVERT _convert)
+{
+  OUT_T out;
+  for (auto _ : _state)
+  {
+    _convert(_in, out);
+    benchmark::DoNotOptimize(out);
+    benchmark::ClobberMemory();
+  }
+  _state.SetBytesProcessed(_state.iterations() * _size);
+}
+
+//////////////////////////////////////////////////
+template<typename ROS_T, typename IGN_T>
+void ros_to_ign(benchmark::State & _state)
+{
+  ROS_T ros_msg;
+  fill(ros_msg);
+  run<ROS_T, IGN_T>(_state, ros_msg,
+      ros::serialization::serializationLength(ros_msg),
+      [](const ROS_T & _in, IGN_T & _out)
+      {
+        ros_ign_bridge::convert_ros_to_ign(_in, _out);
+      });
+}
+
+//////////////////////////////////////////////////
+template<typename ROS_T, typename IGN_T>
+void ign_to_ros(benchmark::State & _state)
+{
+  IGN_T ign_msg;
+  fill(ign_msg);
+  run<IGN_T, ROS_T>(_state, ign_msg, ign_msg.ByteSizeLong(),
+      [](const IGN_T & _in, ROS_T & _out)
+      {
+        ros_ign_bridge::convert_ign_to_ros(_in, _out);
+      });
+}
+
+//////////////////////////////////////////////////
+/// \brief Like ros_to_ign, for messages sized by the benchmark argument.
+template<typename ROS_T, typename IGN_T>
+void ros_to_ign_sized(benchmark::State & _state)
+{
+  ROS_T ros_msg;
+  ros_ign_bridge::testing::createTestMsg(ros_msg, _state.range(0));
+  run<ROS_T, IGN_T>(_state, ros_msg,
+      ros::serialization::serializationLength(ros_msg),
+      [](const ROS_T & _in, IGN_T & _out)
+      {
+        ros_ign_bridge::convert_ros_to_ign(_in, _out);
+      });
+}
+
+//////////////////////////////////////////////////
+/// \brief Like ign_to_ros, for messages sized by the benchmark argument.
+/// The Ignition message is converted from the ROS one.
+template<typename ROS_T, typename IGN_T>
+void ign_to_ros_sized(benchmark::State & _state)
+{
+  ROS_T ros_msg;
+  ros_ign_bridge::testing::createTestMsg(ros_msg, _state.range(0));
+  IGN_T ign_msg;
+  ros_ign_bridge::convert_ros_to_ign(ros_msg, ign_msg);
+  run<IGN_T, ROS_T>(_state, ign_msg, ign_msg.ByteSizeLong(),
+      [](const IGN_T & _in, ROS_T & _out)
+      {
+        ros_ign_bridge::convert_ign_to_ros(_in, _out);
+      });
+}
+
+#define BRIDGE_BENCHMARK(ROS_T, IGN_T) \
+  BENCHMARK_TEMPLATE(ros_to_ign, ROS_T, IGN_T); \
+  BENCHMARK_TEMPLATE(ign_to_ros, ROS_T, IGN_T)
+
+#define BRIDGE_BENCHMARK_SIZES(...) \
+  Apply([](benchmark::internal::Benchmark * _b) \
+  { \
+    for (auto size : {__VA_ARGS__}) \
+      _b->Arg(size); \
+  })
+
+#define BRIDGE_BENCHMARK_SIZED(ROS_T, IGN_T, ...) \
+  BENCHMARK_TEMPLATE(ros_to_ign_sized, ROS_T, IGN_T)-> \
+    BRIDGE_BENCHMARK_SIZES(__VA_ARGS__); \
+  BENCHMARK_TEMPLATE(ign_to_ros_sized, ROS_T, IGN_T)-> \
+    BRIDGE_BENCHMARK_SIZES(__VA_ARGS__)
+
+// std_msgs
+BRIDGE_BENCHMARK(std_msgs::Bool, ignition::msgs::Boolean);
+BRIDGE_BENCHMARK(std_msgs::ColorRGBA, ignition::msgs::Color);
+BRIDGE_BENCHMARK(std_msgs::Empty, ignition::msgs::Empty);
+BRIDGE_BENCHMARK(std_msgs::Int32, ignition::msgs::Int32);
+BRIDGE_BENCHMARK(std_msgs::Float32, ignition::msgs::Float);
+BRIDGE_BENCHMARK(std_msgs::Float64, ignition::msgs::Double);
+BRIDGE_BENCHMARK(std_msgs::Header, ignition::msgs::Header);
+BRIDGE_BENCHMARK(std_msgs::String, ignition::msgs::StringMsg);
+
+// rosgraph_msgs
+BRIDGE_BENCHMARK(rosgraph_msgs::Clock, ignition::msgs::Clock);
+
+// geometry_msgs
+BRIDGE_BENCHMARK(geometry_msgs::Quaternion, ignition::msgs::Quaternion);
+BRIDGE_BENCHMARK(geometry_msgs::Vector3, ignition::msgs::Vector3d);
+BRIDGE_BENCHMARK(geometry_msgs::Point, ignition::msgs::Vector3d);
+BRIDGE_BENCHMARK(geometry_msgs::Pose, ignition::msgs::Pose);
+BRIDGE_BENCHMARK(geometry_msgs::PoseStamped, ignition::msgs::Pose);
+BRIDGE_BENCHMARK(geometry_msgs::Transform, ignition::msgs::Pose);
+BRIDGE_BENCHMARK(geometry_msgs::TransformStamped, ignition::msgs::Pose);
+BRIDGE_BENCHMARK(geometry_msgs::Twist, ignition::msgs::Twist);
+BRIDGE_BENCHMARK_SIZED(geometry_msgs::PoseArray, ignition::msgs::Pose_V,
+    1, 16, 256);
+
+// tf2_msgs
+BRIDGE_BENCHMARK_SIZED(tf2_msgs::TFMessage, ignition::msgs::Pose_V,
+    1, 16, 256);
+
+// mav_msgs
+BRIDGE_BENCHMARK(mav_msgs::Actuators, ignition::msgs::Actuators);
+
+// nav_msgs
+BRIDGE_BENCHMARK(nav_msgs::Odometry, ignition::msgs::Odometry);
+BRIDGE_BENCHMARK_SIZED(nav_msgs::OccupancyGrid, ignition::msgs::OccupancyGrid,
+    64, 512, 2048);
+
+// sensor_msgs
+BRIDGE_BENCHMARK(sensor_msgs::BatteryState, ignition::msgs::BatteryState);
+BRIDGE_BENCHMARK(sensor_msgs::CameraInfo, ignition::msgs::CameraInfo);
+BRIDGE_BENCHMARK(sensor_msgs::FluidPressure, ignition::msgs::FluidPressure);
+BRIDGE_BENCHMARK(sensor_msgs::Imu, ignition::msgs::IMU);
+BRIDGE_BENCHMARK(sensor_msgs::MagneticField, ignition::msgs::Magnetometer);
+BRIDGE_BENCHMARK_SIZED(sensor_msgs::Image, ignition::msgs::Image,
+    320, 640, 1280, 1920);
+BRIDGE_BENCHMARK_SIZED(sensor_msgs::JointState, ignition::msgs::Model,
+    7, 32, 128);
+BRIDGE_BENCHMARK_SIZED(sensor_msgs::LaserScan, ignition::msgs::LaserScan,
+    360, 1080, 4096);
+BRIDGE_BENCHMARK_SIZED(sensor_msgs::PointCloud2,
+    ignition::msgs::PointCloudPacked, 1024, 32768, 131072);
+
+// visualization_msgs
+BRIDGE_BENCHMARK(visualization_msgs::Marker, ignition::msgs::Marker);
+BRIDGE_BENCHMARK(visualization_msgs::MarkerArray, ignition::msgs::Marker_V);
+
+BENCHMARK_MAIN();
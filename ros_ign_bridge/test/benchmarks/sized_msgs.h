@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef ROS_IGN_BRIDGE__SIZED_MSGS_H_
+#define ROS_IGN_BRIDGE__SIZED_MSGS_H_
+
+#include <cstdint>
+#include <string>
+
+#include "../test_utils.h"
+
+namespace ros_ign_bridge
+{
+namespace testing
+{
+  /// \brief Create a message used for testing, for messages whose size
+  /// doesn't vary. The size is ignored.
+  /// \param[out] _msg The message populated.
+  template<typename T>
+  void createTestMsg(T &_msg, int64_t)
+  {
+    createTestMsg(_msg);
+  }
+
+  /// \brief Create an rgb8 image.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _width Width in pixels, the height is 3/4 of it.
+  inline void createTestMsg(sensor_msgs::Image &_msg, int64_t _width)
+  {
+    createTestMsg(_msg);
+    _msg.width = _width;
+    _msg.height = _width * 3 / 4;
+    _msg.step = _msg.width * 3;
+    _msg.data.assign(_msg.height * _msg.step, 0x7f);
+  }
+
+  /// \brief Create an unorganized cloud with x, y, z and intensity.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _points Number of points.
+  inline void createTestMsg(sensor_msgs::PointCloud2 &_msg, int64_t _points)
+  {
+    createTestMsg(_msg);
+    _msg.fields.clear();
+    for (auto name : {"x", "y", "z", "intensity"})
+    {
+      sensor_msgs::PointField field;
+      field.name = name;
+      field.offset = _msg.fields.size() * sizeof(float);
+      field.datatype = sensor_msgs::PointField::FLOAT32;
+      field.count = 1;
+      _msg.fields.push_back(field);
+    }
+    _msg.height = 1;
+    _msg.width = _points;
+    _msg.point_step = _msg.fields.size() * sizeof(float);
+    _msg.row_step = _msg.width * _msg.point_step;
+    _msg.data.assign(_msg.row_step, 0x7f);
+  }
+
+  /// \brief Create a scan with ranges and intensities.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _readings Number of readings.
+  inline void createTestMsg(sensor_msgs::LaserScan &_msg, int64_t _readings)
+  {
+    createTestMsg(_msg);
+
+    // Exact in float, so the converter counts every reading
+    _msg.angle_increment = 1.0f / 256;
+    _msg.angle_min = -_readings / 2 * _msg.angle_increment;
+    _msg.angle_max = _msg.angle_min + _readings * _msg.angle_increment;
+    _msg.ranges.assign(_readings, 5.0f);
+    _msg.intensities.assign(_readings, 100.0f);
+  }
+
+  /// \brief Create a pose array.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _poses Number of poses.
+  inline void createTestMsg(geometry_msgs::PoseArray &_msg, int64_t _poses)
+  {
+    createTestMsg(_msg);
+    _msg.poses.resize(_poses, _msg.poses.front());
+  }
+
+  /// \brief Create a transform tree.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _transforms Number of transforms.
+  inline void createTestMsg(tf2_msgs::TFMessage &_msg, int64_t _transforms)
+  {
+    createTestMsg(_msg);
+    _msg.transforms.resize(_transforms, _msg.transforms.front());
+  }
+
+  /// \brief Create the state of named joints.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _joints Number of joints.
+  inline void createTestMsg(sensor_msgs::JointState &_msg, int64_t _joints)
+  {
+    createTestMsg(_msg);
+    _msg.name.resize(_joints);
+    for (int64_t i = 0; i < _joints; ++i)
+      _msg.name[i] = "joint_" + std::to_string(i);
+    _msg.position.assign(_joints, 1.0);
+    _msg.velocity.assign(_joints, 2.0);
+    _msg.effort.assign(_joints, 3.0);
+  }
+
+  /// \brief Create a square map.
+  /// \param[out] _msg The message populated.
+  /// \param[in] _side Width and height in cells.
+  inline void createTestMsg(nav_msgs::OccupancyGrid &_msg, int64_t _side)
+  {
+    createTestMsg(_msg);
+    _msg.info.width = _side;
+    _msg.info.height = _side;
+    _msg.data.assign(_side * _side, 50);
+  }
+}
+}
+
+#endif  // ROS_IGN_BRIDGE__SIZED_MSGS_H_
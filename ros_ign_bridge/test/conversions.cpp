@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// Properties of the conversions, checked on random messages. The generator
+// is seeded, so a failure reproduces, and its iteration is traced.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ros_ign_bridge/convert.hpp"
+#include "test_utils.h"
+
+using ros_ign_bridge::convert_ign_to_ros;
+using ros_ign_bridge::convert_ros_to_ign;
+
+/// \brief Random messages per property
+static const int kIterations = 200;
+
+/// \brief Pixel formats supported by the bridge, with their bytes per pixel
+static const std::vector<std::pair<ignition::msgs::PixelFormatType,
+    unsigned int>> kPixelFormats = {
+  {ignition::msgs::PixelFormatType::L_INT8, 1},
+  {ignition::msgs::PixelFormatType::L_INT16, 2},
+  {ignition::msgs::PixelFormatType::RGB_INT8, 3},
+  {ignition::msgs::PixelFormatType::RGBA_INT8, 4},
+  {ignition::msgs::PixelFormatType::BGRA_INT8, 4},
+  {ignition::msgs::PixelFormatType::RGB_INT16, 6},
+  {ignition::msgs::PixelFormatType::BGR_INT8, 3},
+  {ignition::msgs::PixelFormatType::BGR_INT16, 6},
+  {ignition::msgs::PixelFormatType::R_FLOAT32, 4},
+};
+
+/////////////////////////////////////////////////
+/// \brief Random integer.
+/// \param[in] _gen Generator
+/// \param[in] _min Lowest value
+/// \param[in] _max Highest value
+/// \return Value in [_min, _max]
+static size_t randomSize(std::mt19937 &_gen, size_t _min, size_t _max)
+{
+  return std::uniform_int_distribution<size_t>(_min, _max)(_gen);
+}
+
+/////////////////////////////////////////////////
+/// \brief Random bytes.
+/// \param[in] _gen Generator
+/// \param[in] _size Number of bytes
+/// \return Bytes
+static std::string randomBytes(std::mt19937 &_gen, size_t _size)
+{
+  std::string bytes(_size, '\0');
+  for (auto &byte : bytes)
+    byte = static_cast<char>(randomSize(_gen, 0, 255));
+  return bytes;
+}
+
+/////////////////////////////////////////////////
+/// \brief Random values which survive a round trip through float.
+/// \param[in] _gen Generator
+/// \param[in] _size Number of values
+/// \return Values
+static std::vector<float> randomFloats(std::mt19937 &_gen, size_t _size)
+{
+  std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+  std::vector<float> values(_size);
+  for (auto &value : values)
+    value = distribution(_gen);
+  return values;
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, ImageRoundTrip)
+{
+  std::mt19937 gen(1);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+    const auto &format = kPixelFormats[randomSize(gen, 0,
+        kPixelFormats.size() - 1)];
+
+    ignition::msgs::Image ignMsg;
+    ignMsg.set_pixel_format_type(format.first);
+    ignMsg.set_width(randomSize(gen, 0, 64));
+    ignMsg.set_height(randomSize(gen, 0, 64));
+    ignMsg.set_step(ignMsg.width() * format.second);
+    ignMsg.set_data(randomBytes(gen, ignMsg.step() * ignMsg.height()));
+
+    sensor_msgs::Image rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    EXPECT_EQ(rosMsg.step * rosMsg.height, rosMsg.data.size());
+
+    ignition::msgs::Image back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(ignMsg.pixel_format_type(), back.pixel_format_type());
+    EXPECT_EQ(ignMsg.width(), back.width());
+    EXPECT_EQ(ignMsg.height(), back.height());
+    EXPECT_EQ(ignMsg.step(), back.step());
+    EXPECT_EQ(ignMsg.data(), back.data());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, ImageTruncated)
+{
+  std::mt19937 gen(2);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+    const auto &format = kPixelFormats[randomSize(gen, 0,
+        kPixelFormats.size() - 1)];
+
+    // Less data than the size says, down to none
+    ignition::msgs::Image ignMsg;
+    ignMsg.set_pixel_format_type(format.first);
+    ignMsg.set_width(randomSize(gen, 1, 64));
+    ignMsg.set_height(randomSize(gen, 1, 64));
+    const size_t size = ignMsg.width() * format.second * ignMsg.height();
+    ignMsg.set_data(randomBytes(gen, randomSize(gen, 0, size - 1)));
+
+    // Only whole rows are kept
+    sensor_msgs::Image rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    EXPECT_EQ(ignMsg.data().size() / rosMsg.step, rosMsg.height);
+    EXPECT_EQ(rosMsg.step * rosMsg.height, rosMsg.data.size());
+    EXPECT_EQ(0, ignMsg.data().compare(0, rosMsg.data.size(),
+        reinterpret_cast<const char *>(rosMsg.data.data()),
+        rosMsg.data.size()));
+
+    // Same from ROS
+    rosMsg.height = ignMsg.height();
+    rosMsg.data.assign(ignMsg.data().begin(), ignMsg.data().end());
+    ignition::msgs::Image back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(ignMsg.data().size() / back.step(), back.height());
+    EXPECT_EQ(back.step() * back.height(), back.data().size());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, LaserScanRoundTrip)
+{
+  std::mt19937 gen(3);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+    const size_t count = randomSize(gen, 0, 720);
+
+    ignition::msgs::LaserScan ignMsg;
+    ignMsg.set_count(count);
+    ignMsg.set_vertical_count(randomSize(gen, 0, 1));
+    for (auto range : randomFloats(gen, count))
+      ignMsg.add_ranges(range);
+    for (auto intensity : randomFloats(gen, count))
+      ignMsg.add_intensities(intensity);
+
+    sensor_msgs::LaserScan rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    EXPECT_EQ(count, rosMsg.ranges.size());
+    EXPECT_EQ(count, rosMsg.intensities.size());
+
+    ignition::msgs::LaserScan back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(count, back.count());
+    ASSERT_EQ(ignMsg.ranges_size(), back.ranges_size());
+    ASSERT_EQ(ignMsg.intensities_size(), back.intensities_size());
+    for (int j = 0; j < ignMsg.ranges_size(); ++j)
+    {
+      EXPECT_EQ(ignMsg.ranges(j), back.ranges(j));
+      EXPECT_EQ(ignMsg.intensities(j), back.intensities(j));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, LaserScanMismatched)
+{
+  std::mt19937 gen(4);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+
+    // Counts disagreeing with the readings, intensities often missing
+    ignition::msgs::LaserScan ignMsg;
+    ignMsg.set_count(randomSize(gen, 0, 100));
+    ignMsg.set_vertical_count(randomSize(gen, 0, 8));
+    for (auto range : randomFloats(gen, randomSize(gen, 0, 400)))
+      ignMsg.add_ranges(range);
+    for (auto intensity : randomFloats(gen, randomSize(gen, 0, 1) *
+        randomSize(gen, 0, 400)))
+    {
+      ignMsg.add_intensities(intensity);
+    }
+
+    // The middle beam, as far as it's there
+    sensor_msgs::LaserScan rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    const size_t start = (ignMsg.vertical_count() / 2) * ignMsg.count();
+    auto expected = [&](size_t _size)
+    {
+      return std::min<size_t>(ignMsg.count(), _size - std::min(start, _size));
+    };
+    ASSERT_EQ(expected(ignMsg.ranges_size()), rosMsg.ranges.size());
+    ASSERT_EQ(expected(ignMsg.intensities_size()), rosMsg.intensities.size());
+    for (size_t j = 0; j < rosMsg.ranges.size(); ++j)
+      EXPECT_FLOAT_EQ(ignMsg.ranges(start + j), rosMsg.ranges[j]);
+
+    // Angles disagreeing with the readings, down to a zero increment
+    rosMsg.angle_min = -1.0f;
+    rosMsg.angle_max = 1.0f;
+    rosMsg.angle_increment = randomSize(gen, 0, 1) * 0.01f;
+    rosMsg.ranges = randomFloats(gen, randomSize(gen, 0, 400));
+    rosMsg.intensities = randomFloats(gen, randomSize(gen, 0, 1) *
+        randomSize(gen, 0, 400));
+
+    // Every range, and the intensities there are
+    ignition::msgs::LaserScan back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(rosMsg.ranges.size(), back.count());
+    EXPECT_EQ(rosMsg.ranges.size(), static_cast<size_t>(back.ranges_size()));
+    EXPECT_EQ(std::min(rosMsg.ranges.size(), rosMsg.intensities.size()),
+        static_cast<size_t>(back.intensities_size()));
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, CameraInfoOversized)
+{
+  std::mt19937 gen(5);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+
+    // More values than ROS has room for, or fewer
+    ignition::msgs::CameraInfo ignMsg;
+    for (auto value : randomFloats(gen, randomSize(gen, 0, 20)))
+      ignMsg.mutable_intrinsics()->add_k(value);
+    for (auto value : randomFloats(gen, randomSize(gen, 0, 20)))
+      ignMsg.mutable_projection()->add_p(value);
+    for (auto value : randomFloats(gen, randomSize(gen, 0, 20)))
+      ignMsg.add_rectification_matrix(value);
+
+    sensor_msgs::CameraInfo rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    for (size_t j = 0; j < rosMsg.K.size() &&
+        j < static_cast<size_t>(ignMsg.intrinsics().k_size()); ++j)
+    {
+      EXPECT_EQ(ignMsg.intrinsics().k(j), rosMsg.K[j]);
+    }
+    for (size_t j = 0; j < rosMsg.P.size() &&
+        j < static_cast<size_t>(ignMsg.projection().p_size()); ++j)
+    {
+      EXPECT_EQ(ignMsg.projection().p(j), rosMsg.P[j]);
+    }
+    for (size_t j = 0; j < rosMsg.R.size() &&
+        j < static_cast<size_t>(ignMsg.rectification_matrix_size()); ++j)
+    {
+      EXPECT_EQ(ignMsg.rectification_matrix(j), rosMsg.R[j]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, PointCloudRoundTrip)
+{
+  std::mt19937 gen(6);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+
+    ignition::msgs::PointCloudPacked ignMsg;
+    ignMsg.set_width(randomSize(gen, 0, 100));
+    ignMsg.set_height(randomSize(gen, 0, 4));
+    ignMsg.set_point_step(randomSize(gen, 1, 32));
+    ignMsg.set_row_step(ignMsg.width() * ignMsg.point_step());
+    ignMsg.set_is_dense(randomSize(gen, 0, 1));
+    const auto fieldCount = randomSize(gen, 0, 4);
+    for (size_t j = 0; j < fieldCount; ++j)
+    {
+      auto field = ignMsg.add_field();
+      field->set_name("field" + std::to_string(j));
+      field->set_offset(randomSize(gen, 0, 28));
+      field->set_count(1);
+      field->set_datatype(
+          ignition::msgs::PointCloudPacked::Field::FLOAT32);
+    }
+    ignMsg.set_data(randomBytes(gen, ignMsg.row_step() * ignMsg.height()));
+
+    sensor_msgs::PointCloud2 rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+
+    ignition::msgs::PointCloudPacked back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(ignMsg.width(), back.width());
+    EXPECT_EQ(ignMsg.height(), back.height());
+    EXPECT_EQ(ignMsg.point_step(), back.point_step());
+    EXPECT_EQ(ignMsg.row_step(), back.row_step());
+    EXPECT_EQ(ignMsg.is_dense(), back.is_dense());
+    EXPECT_EQ(ignMsg.data(), back.data());
+    ASSERT_EQ(ignMsg.field_size(), back.field_size());
+    for (int j = 0; j < ignMsg.field_size(); ++j)
+    {
+      EXPECT_EQ(ignMsg.field(j).name(), back.field(j).name());
+      EXPECT_EQ(ignMsg.field(j).offset(), back.field(j).offset());
+      EXPECT_EQ(ignMsg.field(j).datatype(), back.field(j).datatype());
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, OccupancyGridRoundTrip)
+{
+  std::mt19937 gen(7);
+  for (int i = 0; i < kIterations; ++i)
+  {
+    SCOPED_TRACE(i);
+
+    // Including empty grids
+    ignition::msgs::OccupancyGrid ignMsg;
+    ignMsg.mutable_info()->set_width(randomSize(gen, 0, 64));
+    ignMsg.mutable_info()->set_height(randomSize(gen, 0, 64));
+    ignMsg.set_data(randomBytes(gen,
+        ignMsg.info().width() * ignMsg.info().height()));
+
+    nav_msgs::OccupancyGrid rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+
+    ignition::msgs::OccupancyGrid back;
+    convert_ros_to_ign(rosMsg, back);
+    EXPECT_EQ(ignMsg.info().width(), back.info().width());
+    EXPECT_EQ(ignMsg.info().height(), back.info().height());
+    EXPECT_EQ(ignMsg.data(), back.data());
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Corrupt serialized test messages, then convert whatever still
+/// parses there and back. Run under AddressSanitizer to catch reads out of
+/// bounds; the libFuzzer targets explore further, see the README.
+/// \param[in] _gen Generator
+template<typename ROS_T, typename IGN_T>
+void corrupt(std::mt19937 &_gen)
+{
+  IGN_T seed;
+  ros_ign_bridge::testing::createTestMsg(seed);
+  const auto serialized = seed.SerializeAsString();
+
+  for (int i = 0; i < kIterations; ++i)
+  {
+    // Flip bytes, then maybe truncate or append
+    auto bytes = serialized;
+    const auto flips = randomSize(_gen, 1, 8);
+    for (size_t j = 0; j < flips && !bytes.empty(); ++j)
+    {
+      bytes[randomSize(_gen, 0, bytes.size() - 1)] ^=
+          static_cast<char>(randomSize(_gen, 1, 255));
+    }
+    if (randomSize(_gen, 0, 1))
+      bytes.resize(randomSize(_gen, 0, bytes.size()));
+    else
+      bytes += randomBytes(_gen, randomSize(_gen, 0, 16));
+
+    IGN_T ignMsg;
+    if (!ignMsg.ParseFromString(bytes))
+      continue;
+
+    ROS_T rosMsg;
+    convert_ign_to_ros(ignMsg, rosMsg);
+    convert_ign_to_ros(ignMsg, rosMsg);
+
+    IGN_T back;
+    convert_ros_to_ign(rosMsg, back);
+    convert_ros_to_ign(rosMsg, back);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, Corrupted)
+{
+  std::mt19937 gen(8);
+  corrupt<std_msgs::Bool, ignition::msgs::Boolean>(gen);
+  corrupt<std_msgs::ColorRGBA, ignition::msgs::Color>(gen);
+  corrupt<std_msgs::Float32, ignition::msgs::Float>(gen);
+  corrupt<std_msgs::Float64, ignition::msgs::Double>(gen);
+  corrupt<std_msgs::Header, ignition::msgs::Header>(gen);
+  corrupt<std_msgs::Int32, ignition::msgs::Int32>(gen);
+  corrupt<std_msgs::String, ignition::msgs::StringMsg>(gen);
+  corrupt<geometry_msgs::Quaternion, ignition::msgs::Quaternion>(gen);
+  corrupt<geometry_msgs::Vector3, ignition::msgs::Vector3d>(gen);
+  corrupt<geometry_msgs::Point, ignition::msgs::Vector3d>(gen);
+  corrupt<geometry_msgs::Pose, ignition::msgs::Pose>(gen);
+  corrupt<geometry_msgs::PoseStamped, ignition::msgs::Pose>(gen);
+  corrupt<geometry_msgs::Transform, ignition::msgs::Pose>(gen);
+  corrupt<geometry_msgs::TransformStamped, ignition::msgs::Pose>(gen);
+  corrupt<geometry_msgs::PoseArray, ignition::msgs::Pose_V>(gen);
+  corrupt<geometry_msgs::Twist, ignition::msgs::Twist>(gen);
+  corrupt<mav_msgs::Actuators, ignition::msgs::Actuators>(gen);
+  corrupt<nav_msgs::OccupancyGrid, ignition::msgs::OccupancyGrid>(gen);
+  corrupt<nav_msgs::Odometry, ignition::msgs::Odometry>(gen);
+  corrupt<rosgraph_msgs::Clock, ignition::msgs::Clock>(gen);
+  corrupt<sensor_msgs::BatteryState, ignition::msgs::BatteryState>(gen);
+  corrupt<sensor_msgs::CameraInfo, ignition::msgs::CameraInfo>(gen);
+  corrupt<sensor_msgs::FluidPressure, ignition::msgs::FluidPressure>(gen);
+  corrupt<sensor_msgs::Image, ignition::msgs::Image>(gen);
+  corrupt<sensor_msgs::Imu, ignition::msgs::IMU>(gen);
+  corrupt<sensor_msgs::JointState, ignition::msgs::Model>(gen);
+  corrupt<sensor_msgs::LaserScan, ignition::msgs::LaserScan>(gen);
+  corrupt<sensor_msgs::MagneticField, ignition::msgs::Magnetometer>(gen);
+  corrupt<sensor_msgs::PointCloud2, ignition::msgs::PointCloudPacked>(gen);
+  corrupt<tf2_msgs::TFMessage, ignition::msgs::Pose_V>(gen);
+  corrupt<visualization_msgs::Marker, ignition::msgs::Marker>(gen);
+  corrupt<visualization_msgs::MarkerArray, ignition::msgs::Marker_V>(gen);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
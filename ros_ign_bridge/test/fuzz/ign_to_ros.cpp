@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ros_ign_bridge/convert.hpp"
+
+// One target is built per conversion, with FUZZ_IGN_TYPE and FUZZ_ROS_TYPE
+// defined by CMake
+#if !defined(FUZZ_IGN_TYPE) || !defined(FUZZ_ROS_TYPE)
+# error "FUZZ_IGN_TYPE and FUZZ_ROS_TYPE must be defined"
+#endif
+
+//////////////////////////////////////////////////
+/// \brief libFuzzer entry point. Parses the input as a serialized Ignition
+/// message, converts it to ROS, then back to Ignition. Every conversion is
+/// done twice, since converting into a used message takes other paths.
+/// \param[in] _data Input
+/// \param[in] _size Size of the input
+/// \return 0, as libFuzzer expects
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *_data, size_t _size)
+{
+  FUZZ_IGN_TYPE ignMsg;
+  if (!ignMsg.ParseFromArray(_data, static_cast<int>(_size)))
+    return 0;
+
+  FUZZ_ROS_TYPE rosMsg;
+  ros_ign_bridge::convert_ign_to_ros(ignMsg, rosMsg);
+  ros_ign_bridge::convert_ign_to_ros(ignMsg, rosMsg);
+
+  FUZZ_IGN_TYPE ignBack;
+  ros_ign_bridge::convert_ros_to_ign(rosMsg, ignBack);
+  ros_ign_bridge::convert_ros_to_ign(rosMsg, ignBack);
+  return 0;
+}
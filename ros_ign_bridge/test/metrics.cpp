@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/make_shared.hpp>
+#include <ros/callback_queue.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include "../src/metrics.hpp"
+#include "../src/monitored_callback_queue.hpp"
+
+using ros_ign_bridge::LatencyHistogram;
+
+/////////////////////////////////////////////////
+TEST(MetricsTest, Buckets)
+{
+  // Small values have a bucket each
+  for (uint64_t value = 0; value < LatencyHistogram::kSubBuckets; ++value)
+  {
+    EXPECT_EQ(value, LatencyHistogram::bucket_index(value));
+    EXPECT_EQ(value, LatencyHistogram::bucket_value(value));
+  }
+
+  // Every value falls in a bucket whose highest value is within 1/8 above it
+  for (uint64_t value : {8ull, 9ull, 15ull, 16ull, 17ull, 1000ull, 123456ull,
+      1000000000ull})
+  {
+    auto index = LatencyHistogram::bucket_index(value);
+    auto high = LatencyHistogram::bucket_value(index);
+    EXPECT_GE(high, value);
+    EXPECT_LE(high - value, value / 8) << value;
+    EXPECT_LT(LatencyHistogram::bucket_value(index - 1), value) << value;
+  }
+
+  // Buckets are ordered
+  for (size_t i = 1; i < LatencyHistogram::kBucketCount; ++i)
+  {
+    EXPECT_LT(LatencyHistogram::bucket_value(i - 1),
+        LatencyHistogram::bucket_value(i));
+  }
+
+  // Huge values share the last bucket
+  EXPECT_EQ(LatencyHistogram::kBucketCount - 1,
+      LatencyHistogram::bucket_index(uint64_t{1} << 40));
+  EXPECT_EQ(LatencyHistogram::kBucketCount - 1,
+      LatencyHistogram::bucket_index(~uint64_t{0}));
+}
+
+/////////////////////////////////////////////////
+TEST(MetricsTest, Quantiles)
+{
+  LatencyHistogram::Counts counts{};
+  EXPECT_EQ(0u, LatencyHistogram::quantile(counts, 0.5));
+
+  LatencyHistogram histogram;
+  for (uint64_t value = 1; value <= 1000; ++value)
+    histogram.record(value * 1000);
+  histogram.add_to(counts);
+
+  auto p50 = LatencyHistogram::quantile(counts, 0.5);
+  EXPECT_GE(p50, 500000u);
+  EXPECT_LE(p50, 500000u + 500000u / 8);
+
+  auto p99 = LatencyHistogram::quantile(counts, 0.99);
+  EXPECT_GE(p99, 990000u);
+  EXPECT_LE(p99, 990000u + 990000u / 8);
+
+  auto max = LatencyHistogram::quantile(counts, 1.0);
+  EXPECT_GE(max, 1000000u);
+  EXPECT_LE(max, 1000000u + 1000000u / 8);
+}
+
+/////////////////////////////////////////////////
+TEST(MetricsTest, Threads)
+{
+  ros_ign_bridge::MetricsRegistry registry;
+  auto metrics = registry.add("/chatter", "ROS to Ignition",
+      "std_msgs/String", "ignition.msgs.StringMsg");
+
+  // More threads than shards
+  const size_t thread_count = ros_ign_bridge::BridgeMetrics::kShards * 2;
+  const size_t per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i)
+  {
+    threads.emplace_back([&metrics, per_thread]
+    {
+      for (size_t j = 0; j < per_thread; ++j)
+      {
+        metrics->record(10, 20, std::chrono::microseconds(5),
+            std::chrono::microseconds(50));
+      }
+      metrics->record_drop();
+    });
+  }
+  for (auto & thread : threads)
+    thread.join();
+
+  auto snapshot = metrics->snapshot();
+  EXPECT_EQ(thread_count * per_thread, snapshot.messages);
+  EXPECT_EQ(thread_count, snapshot.dropped);
+  EXPECT_EQ(thread_count * per_thread * 10, snapshot.bytes_in);
+  EXPECT_EQ(thread_count * per_thread * 20, snapshot.bytes_out);
+
+  auto convert = LatencyHistogram::quantile(snapshot.convert, 0.5);
+  EXPECT_GE(convert, 5000u);
+  EXPECT_LE(convert, 5000u + 5000u / 8);
+
+  // One status per bridge, warning about drops
+  auto array = registry.diagnostics(ros::Time(10, 0));
+  ASSERT_EQ(1u, array.status.size());
+  EXPECT_EQ(diagnostic_msgs::DiagnosticStatus::WARN, array.status[0].level);
+
+  // No drops since
+  array = registry.diagnostics(ros::Time(11, 0));
+  ASSERT_EQ(1u, array.status.size());
+  EXPECT_EQ(diagnostic_msgs::DiagnosticStatus::OK, array.status[0].level);
+
+  auto dump = registry.dump();
+  EXPECT_NE(std::string::npos, dump.find("/chatter, ROS to Ignition, 80000"));
+}
+
+/////////////////////////////////////////////////
+/// \brief Bus statistics with one subscription, as returned by the
+/// getBusStats XML-RPC call.
+/// \param[in] _topic Subscribed topic
+/// \param[in] _drops Messages dropped by each connection, by id
+/// \return Statistics
+static XmlRpc::XmlRpcValue busStats(const std::string &_topic,
+    const std::map<int, int> &_drops)
+{
+  XmlRpc::XmlRpcValue stats;
+  stats[0].setSize(0);
+  stats[1][0][0] = _topic;
+  stats[1][0][1].setSize(0);
+  int index = 0;
+  for (const auto &drops : _drops)
+  {
+    auto &connection = stats[1][0][1][index++];
+    connection[0] = drops.first;
+    connection[1] = 0;
+    connection[2] = 0;
+    connection[3] = drops.second;
+    connection[4] = 0;
+  }
+  stats[2].setSize(0);
+  return stats;
+}
+
+/////////////////////////////////////////////////
+TEST(MetricsTest, Queue)
+{
+  ros_ign_bridge::MetricsRegistry registry;
+  auto metrics = registry.add("/chatter", "ROS to Ignition",
+      "std_msgs/String", "ignition.msgs.StringMsg");
+  registry.add("/chatter", "Ignition to ROS",
+      "std_msgs/String", "ignition.msgs.StringMsg");
+
+  // Only enabled queues are reported
+  EXPECT_TRUE(registry.bridge_status(ros::Time(1, 0)).queues.empty());
+
+  auto & queue = metrics->queue();
+  queue.enable(3, "/chatter");
+
+  // Fill it
+  for (int i = 0; i < 3; ++i)
+    queue.push();
+  EXPECT_EQ(3u, queue.depth());
+
+  // A message may be scheduled after roscpp popped one, but before the
+  // bridge receives it
+  queue.push();
+  EXPECT_EQ(3u, queue.depth());
+  queue.pop();
+  EXPECT_EQ(3u, queue.depth());
+
+  // Drain it, popping from an empty queue does nothing
+  for (int i = 0; i < 3; ++i)
+    queue.pop();
+  queue.pop();
+  EXPECT_EQ(0u, queue.depth());
+
+  // Overflows come from the drops roscpp counts per connection
+  EXPECT_EQ(0u, queue.overflows());
+  auto stats = busStats("/chatter", {{1, 2}});
+  registry.update_overflows(stats);
+  EXPECT_EQ(2u, queue.overflows());
+
+  // Only drops since the previous update are added, from every connection
+  stats = busStats("/chatter", {{1, 2}, {2, 1}});
+  registry.update_overflows(stats);
+  EXPECT_EQ(3u, queue.overflows());
+  EXPECT_EQ(3u, metrics->snapshot().dropped);
+
+  // Other topics aren't counted
+  stats = busStats("/other", {{3, 5}});
+  registry.update_overflows(stats);
+  EXPECT_EQ(3u, queue.overflows());
+
+  auto status = registry.bridge_status(ros::Time(2, 0));
+  EXPECT_EQ(ros::Time(2, 0), status.header.stamp);
+  ASSERT_EQ(1u, status.queues.size());
+  EXPECT_EQ("/chatter", status.queues[0].topic);
+  EXPECT_EQ("ROS to Ignition", status.queues[0].direction);
+  EXPECT_EQ(3u, status.queues[0].queue_size);
+  EXPECT_EQ(0u, status.queues[0].depth);
+  EXPECT_EQ(3u, status.queues[0].high_water_mark);
+  EXPECT_EQ(3u, status.queues[0].overflows);
+  EXPECT_EQ(3u, status.queues[0].total_overflows);
+
+  // The high-water mark and overflows restart with every status
+  queue.push();
+  status = registry.bridge_status(ros::Time(3, 0));
+  ASSERT_EQ(1u, status.queues.size());
+  EXPECT_EQ(1u, status.queues[0].depth);
+  EXPECT_EQ(1u, status.queues[0].high_water_mark);
+  EXPECT_EQ(0u, status.queues[0].overflows);
+  EXPECT_EQ(3u, status.queues[0].total_overflows);
+
+  // roscpp counts drops on 32 bits
+  stats = busStats("/chatter", {{4, std::numeric_limits<int>::max()}});
+  registry.update_overflows(stats);
+  stats = busStats("/chatter", {{4, std::numeric_limits<int>::min()}});
+  registry.update_overflows(stats);
+  EXPECT_EQ(3u + std::numeric_limits<int>::max() + 1u, queue.overflows());
+
+  // Unbounded queues never overflow
+  ros_ign_bridge::QueueMonitor unbounded;
+  unbounded.enable(0, "/unbounded");
+  for (int i = 0; i < 1000; ++i)
+    unbounded.push();
+  EXPECT_EQ(1000u, unbounded.depth());
+  EXPECT_EQ(0u, unbounded.overflows());
+}
+
+/////////////////////////////////////////////////
+/// \brief Subscriber queue behaving like roscpp's. A message pushed into a
+/// full queue replaces the oldest one without scheduling a callback, and is
+/// counted as a drop. Other messages schedule a callback, which pops a
+/// message and passes it to the subscriber.
+class SubscriberQueue : public ros::CallbackInterface,
+  public boost::enable_shared_from_this<SubscriberQueue>
+{
+  /// \brief Constructor
+  /// \param[in] _size Messages held
+  /// \param[in] _callbackQueue Queue to schedule callbacks on
+  /// \param[in] _subscriber Subscriber callback
+  public: SubscriberQueue(size_t _size,
+      ros::CallbackQueueInterface *_callbackQueue,
+      std::function<void(int)> _subscriber)
+    : size(_size), callbackQueue(_callbackQueue),
+      subscriber(std::move(_subscriber))
+  {
+  }
+
+  /// \brief Push a message, and schedule a callback if the queue wasn't
+  /// full.
+  /// \param[in] _msg Message
+  public: void Push(int _msg)
+  {
+    const bool wasFull = this->msgs.size() >= this->size;
+    if (wasFull)
+    {
+      this->msgs.pop_front();
+      ++this->drops;
+    }
+    this->msgs.push_back(_msg);
+    if (!wasFull)
+      this->callbackQueue->addCallback(this->shared_from_this());
+  }
+
+  // Documentation inherited
+  public: CallResult call() override
+  {
+    if (this->msgs.empty())
+      return Invalid;
+    const int msg = this->msgs.front();
+    this->msgs.pop_front();
+    this->subscriber(msg);
+    return Success;
+  }
+
+  /// \brief Messages held
+  public: size_t size;
+
+  /// \brief Queue to schedule callbacks on
+  public: ros::CallbackQueueInterface *callbackQueue;
+
+  /// \brief Subscriber callback
+  public: std::function<void(int)> subscriber;
+
+  /// \brief Queued messages
+  public: std::deque<int> msgs;
+
+  /// \brief Messages dropped because the queue was full
+  public: int drops = 0;
+};
+
+/////////////////////////////////////////////////
+TEST(MetricsTest, MonitoredCallbackQueue)
+{
+  ros_ign_bridge::MetricsRegistry registry;
+  auto metrics = registry.add("/chatter", "ROS to Ignition",
+      "std_msgs/String", "ignition.msgs.StringMsg");
+  metrics->queue().enable(2, "/chatter");
+
+  // The bridge pops from the mirror when it receives a message
+  std::vector<int> received;
+  ros::CallbackQueue callbackQueue;
+  ros_ign_bridge::MonitoredCallbackQueue monitored(&callbackQueue, metrics);
+  auto subscriber = boost::make_shared<SubscriberQueue>(2, &monitored,
+      [&](int _msg)
+      {
+        metrics->queue().pop();
+        received.push_back(_msg);
+      });
+
+  // The mirror follows the subscriber queue through overflows, which it
+  // can't see
+  for (int msg = 0; msg < 5; ++msg)
+  {
+    subscriber->Push(msg);
+    EXPECT_EQ(subscriber->msgs.size(), metrics->queue().depth());
+  }
+  EXPECT_EQ(3, subscriber->drops);
+  EXPECT_EQ(0u, metrics->queue().overflows());
+
+  // They're counted from the bus statistics
+  auto stats = busStats("/chatter", {std::make_pair(1, subscriber->drops)});
+  registry.update_overflows(stats);
+  EXPECT_EQ(3u, metrics->queue().overflows());
+  EXPECT_EQ(3u, metrics->snapshot().dropped);
+
+  // One callback per message held
+  while (!callbackQueue.isEmpty())
+  {
+    callbackQueue.callOne();
+    EXPECT_EQ(subscriber->msgs.size(), metrics->queue().depth());
+  }
+  EXPECT_EQ(std::vector<int>({3, 4}), received);
+  EXPECT_EQ(0u, metrics->queue().depth());
+
+  // Messages arriving while draining
+  subscriber->Push(5);
+  subscriber->Push(6);
+  callbackQueue.callOne();
+  subscriber->Push(7);
+  subscriber->Push(8);
+  EXPECT_EQ(subscriber->msgs.size(), metrics->queue().depth());
+  EXPECT_EQ(4, subscriber->drops);
+  callbackQueue.callAvailable();
+  EXPECT_EQ(std::vector<int>({3, 4, 5, 7, 8}), received);
+  EXPECT_EQ(0u, metrics->queue().depth());
+
+  stats = busStats("/chatter", {std::make_pair(1, subscriber->drops)});
+  registry.update_overflows(stats);
+  EXPECT_EQ(4u, metrics->queue().overflows());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -116,14 +116,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::Bool &_msg)
+  inline void createTestMsg(std_msgs::Bool &_msg)
   {
     _msg.data = true;
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Bool &_msg)
+  inline void compareTestMsg(const std_msgs::Bool &_msg)
   {
     std_msgs::Bool expected_msg;
     createTestMsg(expected_msg);
@@ -133,7 +133,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::ColorRGBA &_msg)
+  inline void createTestMsg(std_msgs::ColorRGBA &_msg)
   {
     _msg.r = 10.0;
     _msg.g = 11.0;
@@ -143,7 +143,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::ColorRGBA &_msg)
+  inline void compareTestMsg(const std_msgs::ColorRGBA &_msg)
   {
     std_msgs::ColorRGBA expected_msg;
     createTestMsg(expected_msg);
@@ -156,34 +156,34 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing. Noop for Empty
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Empty &)
+  inline void compareTestMsg(const std_msgs::Empty &)
   {
   }
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::Int32 &_msg)
+  inline void createTestMsg(std_msgs::Int32 &_msg)
   {
     _msg.data = 5;
   }
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::Float32 &_msg)
+  inline void createTestMsg(std_msgs::Float32 &_msg)
   {
     _msg.data = 1.5;
   }
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::Float64 &_msg)
+  inline void createTestMsg(std_msgs::Float64 &_msg)
   {
     _msg.data = 1.5;
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Int32 &_msg)
+  inline void compareTestMsg(const std_msgs::Int32 &_msg)
   {
     std_msgs::Int32 expected_msg;
     createTestMsg(expected_msg);
@@ -193,7 +193,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Float32 &_msg)
+  inline void compareTestMsg(const std_msgs::Float32 &_msg)
   {
     std_msgs::Float32 expected_msg;
     createTestMsg(expected_msg);
@@ -203,7 +203,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Float64 &_msg)
+  inline void compareTestMsg(const std_msgs::Float64 &_msg)
   {
     std_msgs::Float64 expected_msg;
     createTestMsg(expected_msg);
@@ -213,7 +213,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::Header &_msg)
+  inline void createTestMsg(std_msgs::Header &_msg)
   {
     _msg.seq        = 1;
     _msg.stamp.sec  = 2;
@@ -223,7 +223,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::Header &_msg)
+  inline void compareTestMsg(const std_msgs::Header &_msg)
   {
     std_msgs::Header expected_msg;
     createTestMsg(expected_msg);
@@ -236,14 +236,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(std_msgs::String &_msg)
+  inline void createTestMsg(std_msgs::String &_msg)
   {
     _msg.data = "string";
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const std_msgs::String &_msg)
+  inline void compareTestMsg(const std_msgs::String &_msg)
   {
     std_msgs::String expected_msg;
     createTestMsg(expected_msg);
@@ -253,7 +253,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Quaternion &_msg)
+  inline void createTestMsg(geometry_msgs::Quaternion &_msg)
   {
     _msg.x = 1;
     _msg.y = 2;
@@ -263,7 +263,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Quaternion &_msg)
+  inline void compareTestMsg(const geometry_msgs::Quaternion &_msg)
   {
     geometry_msgs::Quaternion expected_msg;
     createTestMsg(expected_msg);
@@ -276,7 +276,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Vector3 &_msg)
+  inline void createTestMsg(geometry_msgs::Vector3 &_msg)
   {
     _msg.x = 1;
     _msg.y = 2;
@@ -285,7 +285,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Vector3 &_msg)
+  inline void compareTestMsg(const geometry_msgs::Vector3 &_msg)
   {
     geometry_msgs::Vector3 expected_msg;
     createTestMsg(expected_msg);
@@ -297,7 +297,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(rosgraph_msgs::Clock &_msg)
+  inline void createTestMsg(rosgraph_msgs::Clock &_msg)
   {
     _msg.clock.sec  = 1;
     _msg.clock.nsec = 2;
@@ -305,7 +305,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Point &_msg)
+  inline void createTestMsg(geometry_msgs::Point &_msg)
   {
     _msg.x = 1;
     _msg.y = 2;
@@ -314,7 +314,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const rosgraph_msgs::Clock &_msg)
+  inline void compareTestMsg(const rosgraph_msgs::Clock &_msg)
   {
     rosgraph_msgs::Clock expected_msg;
     createTestMsg(expected_msg);
@@ -325,7 +325,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Point &_msg)
+  inline void compareTestMsg(const geometry_msgs::Point &_msg)
   {
     geometry_msgs::Point expected_msg;
     createTestMsg(expected_msg);
@@ -337,7 +337,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Pose &_msg)
+  inline void createTestMsg(geometry_msgs::Pose &_msg)
   {
     createTestMsg(_msg.position);
     createTestMsg(_msg.orientation);
@@ -345,7 +345,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Pose &_msg)
+  inline void compareTestMsg(const geometry_msgs::Pose &_msg)
   {
     compareTestMsg(_msg.position);
     compareTestMsg(_msg.orientation);
@@ -353,7 +353,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::PoseArray &_msg)
+  inline void createTestMsg(geometry_msgs::PoseArray &_msg)
   {
     geometry_msgs::Pose pose;
     createTestMsg(pose);
@@ -364,7 +364,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::PoseArray &_msg)
+  inline void compareTestMsg(const geometry_msgs::PoseArray &_msg)
   {
     compareTestMsg(_msg.poses[0]);
     compareTestMsg(_msg.header);
@@ -372,7 +372,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::PoseStamped &_msg)
+  inline void createTestMsg(geometry_msgs::PoseStamped &_msg)
   {
     createTestMsg(_msg.header);
     createTestMsg(_msg.pose);
@@ -380,7 +380,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::PoseStamped &_msg)
+  inline void compareTestMsg(const geometry_msgs::PoseStamped &_msg)
   {
     compareTestMsg(_msg.header);
     compareTestMsg(_msg.pose);
@@ -388,7 +388,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Transform &_msg)
+  inline void createTestMsg(geometry_msgs::Transform &_msg)
   {
     createTestMsg(_msg.translation);
     createTestMsg(_msg.rotation);
@@ -396,7 +396,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Transform &_msg)
+  inline void compareTestMsg(const geometry_msgs::Transform &_msg)
   {
     compareTestMsg(_msg.translation);
     compareTestMsg(_msg.rotation);
@@ -404,7 +404,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::TransformStamped &_msg)
+  inline void createTestMsg(geometry_msgs::TransformStamped &_msg)
   {
     createTestMsg(_msg.header);
     createTestMsg(_msg.transform);
@@ -413,7 +413,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::TransformStamped &_msg)
+  inline void compareTestMsg(const geometry_msgs::TransformStamped &_msg)
   {
     geometry_msgs::TransformStamped expected_msg;
     createTestMsg(expected_msg);
@@ -425,7 +425,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(tf2_msgs::TFMessage &_msg)
+  inline void createTestMsg(tf2_msgs::TFMessage &_msg)
   {
     geometry_msgs::TransformStamped tf;
     createTestMsg(tf);
@@ -434,7 +434,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const tf2_msgs::TFMessage &_msg)
+  inline void compareTestMsg(const tf2_msgs::TFMessage &_msg)
   {
     tf2_msgs::TFMessage expected_msg;
     createTestMsg(expected_msg);
@@ -444,7 +444,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(geometry_msgs::Twist &_msg)
+  inline void createTestMsg(geometry_msgs::Twist &_msg)
   {
     createTestMsg(_msg.linear);
     createTestMsg(_msg.angular);
@@ -452,7 +452,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const geometry_msgs::Twist &_msg)
+  inline void compareTestMsg(const geometry_msgs::Twist &_msg)
   {
     compareTestMsg(_msg.linear);
     compareTestMsg(_msg.angular);
@@ -460,7 +460,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(mav_msgs::Actuators &_msg)
+  inline void createTestMsg(mav_msgs::Actuators &_msg)
   {
     createTestMsg(_msg.header);
     for (auto i = 0u; i < 5; ++i)
@@ -473,7 +473,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const mav_msgs::Actuators &_msg)
+  inline void compareTestMsg(const mav_msgs::Actuators &_msg)
   {
     mav_msgs::Actuators expected_msg;
     createTestMsg(expected_msg);
@@ -495,7 +495,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(nav_msgs::OccupancyGrid &_msg)
+  inline void createTestMsg(nav_msgs::OccupancyGrid &_msg)
   {
     createTestMsg(_msg.header);
 
@@ -510,7 +510,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const nav_msgs::OccupancyGrid &_msg)
+  inline void compareTestMsg(const nav_msgs::OccupancyGrid &_msg)
   {
     nav_msgs::OccupancyGrid expected_msg;
     createTestMsg(expected_msg);
@@ -532,7 +532,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(nav_msgs::Odometry &_msg)
+  inline void createTestMsg(nav_msgs::Odometry &_msg)
   {
     createTestMsg(_msg.header);
     createTestMsg(_msg.pose.pose);
@@ -541,7 +541,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const nav_msgs::Odometry &_msg)
+  inline void compareTestMsg(const nav_msgs::Odometry &_msg)
   {
     compareTestMsg(_msg.header);
     compareTestMsg(_msg.pose.pose);
@@ -550,7 +550,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::Image &_msg)
+  inline void createTestMsg(sensor_msgs::Image &_msg)
   {
     std_msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -566,7 +566,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::Image &_msg)
+  inline void compareTestMsg(const sensor_msgs::Image &_msg)
   {
     sensor_msgs::Image expected_msg;
     createTestMsg(expected_msg);
@@ -581,7 +581,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::CameraInfo &_msg)
+  inline void createTestMsg(sensor_msgs::CameraInfo &_msg)
   {
     std_msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -633,7 +633,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::CameraInfo &_msg)
+  inline void compareTestMsg(const sensor_msgs::CameraInfo &_msg)
   {
     sensor_msgs::CameraInfo expected_msg;
     createTestMsg(expected_msg);
@@ -662,7 +662,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::FluidPressure &_msg)
+  inline void createTestMsg(sensor_msgs::FluidPressure &_msg)
   {
     std_msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -674,7 +674,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::FluidPressure &_msg)
+  inline void compareTestMsg(const sensor_msgs::FluidPressure &_msg)
   {
     sensor_msgs::FluidPressure expected_msg;
     createTestMsg(expected_msg);
@@ -686,7 +686,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::Imu &_msg)
+  inline void createTestMsg(sensor_msgs::Imu &_msg)
   {
     std_msgs::Header header_msg;
     geometry_msgs::Quaternion quaternion_msg;
@@ -707,7 +707,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::Imu &_msg)
+  inline void compareTestMsg(const sensor_msgs::Imu &_msg)
   {
     compareTestMsg(_msg.header);
     compareTestMsg(_msg.orientation);
@@ -724,7 +724,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::JointState &_msg)
+  inline void createTestMsg(sensor_msgs::JointState &_msg)
   {
     std_msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -738,7 +738,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::JointState &_msg)
+  inline void compareTestMsg(const sensor_msgs::JointState &_msg)
   {
     sensor_msgs::JointState expected_msg;
     createTestMsg(expected_msg);
@@ -761,7 +761,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::LaserScan &_msg)
+  inline void createTestMsg(sensor_msgs::LaserScan &_msg)
   {
     const unsigned int num_readings = 100u;
     const double laser_frequency    = 40;
@@ -783,7 +783,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::LaserScan &_msg)
+  inline void compareTestMsg(const sensor_msgs::LaserScan &_msg)
   {
     sensor_msgs::LaserScan expected_msg;
     createTestMsg(expected_msg);
@@ -808,7 +808,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::MagneticField &_msg)
+  inline void createTestMsg(sensor_msgs::MagneticField &_msg)
   {
     std_msgs::Header header_msg;
     geometry_msgs::Vector3 vector3_msg;
@@ -823,7 +823,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::MagneticField &_msg)
+  inline void compareTestMsg(const sensor_msgs::MagneticField &_msg)
   {
     compareTestMsg(_msg.header);
     compareTestMsg(_msg.magnetic_field);
@@ -834,7 +834,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::PointCloud2 &_msg)
+  inline void createTestMsg(sensor_msgs::PointCloud2 &_msg)
   {
     createTestMsg(_msg.header);
 
@@ -871,7 +871,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::PointCloud2 &_msg)
+  inline void compareTestMsg(const sensor_msgs::PointCloud2 &_msg)
   {
     compareTestMsg(_msg.header);
 
@@ -903,7 +903,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(sensor_msgs::BatteryState &_msg)
+  inline void createTestMsg(sensor_msgs::BatteryState &_msg)
   {
     std_msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -919,7 +919,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const sensor_msgs::BatteryState &_msg)
+  inline void compareTestMsg(const sensor_msgs::BatteryState &_msg)
   {
     sensor_msgs::BatteryState expected_msg;
     createTestMsg(expected_msg);
@@ -935,7 +935,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(visualization_msgs::Marker &_msg)
+  inline void createTestMsg(visualization_msgs::Marker &_msg)
   {
     createTestMsg(_msg.header);
 
@@ -959,7 +959,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const visualization_msgs::Marker &_msg)
+  inline void compareTestMsg(const visualization_msgs::Marker &_msg)
   {
     visualization_msgs::Marker expected_msg;
     createTestMsg(expected_msg);
@@ -985,7 +985,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(visualization_msgs::MarkerArray &_msg)
+  inline void createTestMsg(visualization_msgs::MarkerArray &_msg)
   {
     _msg.markers.clear();
     visualization_msgs::Marker marker;
@@ -995,7 +995,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const visualization_msgs::MarkerArray &_msg)
+  inline void compareTestMsg(const visualization_msgs::MarkerArray &_msg)
   {
     visualization_msgs::MarkerArray expected_msg;
     createTestMsg(expected_msg);
@@ -1010,14 +1010,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Boolean &_msg)
+  inline void createTestMsg(ignition::msgs::Boolean &_msg)
   {
     _msg.set_data(true);
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Boolean &_msg)
+  inline void compareTestMsg(const ignition::msgs::Boolean &_msg)
   {
     ignition::msgs::Boolean expected_msg;
     createTestMsg(expected_msg);
@@ -1027,7 +1027,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Color &_msg)
+  inline void createTestMsg(ignition::msgs::Color &_msg)
   {
     _msg.set_r(10.0);
     _msg.set_g(11.0);
@@ -1037,7 +1037,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Color &_msg)
+  inline void compareTestMsg(const ignition::msgs::Color &_msg)
   {
     ignition::msgs::Color expected_msg;
     createTestMsg(expected_msg);
@@ -1050,20 +1050,20 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing. Noop for Empty
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Empty &)
+  inline void compareTestMsg(const ignition::msgs::Empty &)
   {
   }
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Int32 &_msg)
+  inline void createTestMsg(ignition::msgs::Int32 &_msg)
   {
     _msg.set_data(5);
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Int32 &_msg)
+  inline void compareTestMsg(const ignition::msgs::Int32 &_msg)
   {
     ignition::msgs::Int32 expected_msg;
     createTestMsg(expected_msg);
@@ -1073,14 +1073,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Float &_msg)
+  inline void createTestMsg(ignition::msgs::Float &_msg)
   {
     _msg.set_data(1.5);
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Float &_msg)
+  inline void compareTestMsg(const ignition::msgs::Float &_msg)
   {
     ignition::msgs::Float expected_msg;
     createTestMsg(expected_msg);
@@ -1090,14 +1090,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Double &_msg)
+  inline void createTestMsg(ignition::msgs::Double &_msg)
   {
     _msg.set_data(1.5);
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Double &_msg)
+  inline void compareTestMsg(const ignition::msgs::Double &_msg)
   {
     ignition::msgs::Double expected_msg;
     createTestMsg(expected_msg);
@@ -1107,7 +1107,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Header &_msg)
+  inline void createTestMsg(ignition::msgs::Header &_msg)
   {
     auto seq_entry = _msg.add_data();
     seq_entry->set_key("seq");
@@ -1121,7 +1121,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Header &_msg)
+  inline void compareTestMsg(const ignition::msgs::Header &_msg)
   {
     ignition::msgs::Header expected_msg;
     createTestMsg(expected_msg);
@@ -1148,7 +1148,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Clock &_msg)
+  inline void createTestMsg(ignition::msgs::Clock &_msg)
   {
     _msg.mutable_sim()->set_sec(1);
     _msg.mutable_sim()->set_nsec(2);
@@ -1156,7 +1156,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Clock &_msg)
+  inline void compareTestMsg(const ignition::msgs::Clock &_msg)
   {
     ignition::msgs::Clock expected_msg;
     createTestMsg(expected_msg);
@@ -1167,14 +1167,14 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::StringMsg &_msg)
+  inline void createTestMsg(ignition::msgs::StringMsg &_msg)
   {
     _msg.set_data("string");
   }
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::StringMsg &_msg)
+  inline void compareTestMsg(const ignition::msgs::StringMsg &_msg)
   {
     ignition::msgs::StringMsg expected_msg;
     createTestMsg(expected_msg);
@@ -1184,7 +1184,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Quaternion &_msg)
+  inline void createTestMsg(ignition::msgs::Quaternion &_msg)
   {
     _msg.set_x(1.0);
     _msg.set_y(2.0);
@@ -1194,7 +1194,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Quaternion &_msg)
+  inline void compareTestMsg(const ignition::msgs::Quaternion &_msg)
   {
     ignition::msgs::Quaternion expected_msg;
     createTestMsg(expected_msg);
@@ -1207,7 +1207,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Vector3d &_msg)
+  inline void createTestMsg(ignition::msgs::Vector3d &_msg)
   {
     _msg.set_x(1.0);
     _msg.set_y(2.0);
@@ -1216,7 +1216,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Vector3d &_msg)
+  inline void compareTestMsg(const ignition::msgs::Vector3d &_msg)
   {
     ignition::msgs::Vector3d expected_msg;
     createTestMsg(expected_msg);
@@ -1228,7 +1228,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Pose &_msg)
+  inline void createTestMsg(ignition::msgs::Pose &_msg)
   {
     createTestMsg(*_msg.mutable_header());
     auto child_frame_id_entry = _msg.mutable_header()->add_data();
@@ -1241,7 +1241,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Pose &_msg)
+  inline void compareTestMsg(const ignition::msgs::Pose &_msg)
   {
     if (_msg.header().data_size() > 0)
     {
@@ -1269,7 +1269,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Pose_V &_msg)
+  inline void createTestMsg(ignition::msgs::Pose_V &_msg)
   {
     createTestMsg(*_msg.mutable_header());
     createTestMsg(*_msg.add_pose());
@@ -1277,7 +1277,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Pose_V &_msg)
+  inline void compareTestMsg(const ignition::msgs::Pose_V &_msg)
   {
     ignition::msgs::Pose_V expected_msg;
     createTestMsg(expected_msg);
@@ -1288,7 +1288,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Twist &_msg)
+  inline void createTestMsg(ignition::msgs::Twist &_msg)
   {
     ignition::msgs::Header header_msg;
     ignition::msgs::Vector3d linear_msg;
@@ -1305,7 +1305,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Twist &_msg)
+  inline void compareTestMsg(const ignition::msgs::Twist &_msg)
   {
     compareTestMsg(_msg.linear());
     compareTestMsg(_msg.angular());
@@ -1313,7 +1313,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Image &_msg)
+  inline void createTestMsg(ignition::msgs::Image &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1328,7 +1328,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Image &_msg)
+  inline void compareTestMsg(const ignition::msgs::Image &_msg)
   {
     ignition::msgs::Image expected_msg;
     createTestMsg(expected_msg);
@@ -1343,7 +1343,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::CameraInfo &_msg)
+  inline void createTestMsg(ignition::msgs::CameraInfo &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1398,7 +1398,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::CameraInfo &_msg)
+  inline void compareTestMsg(const ignition::msgs::CameraInfo &_msg)
   {
     ignition::msgs::CameraInfo expected_msg;
     createTestMsg(expected_msg);
@@ -1445,7 +1445,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::FluidPressure &_msg)
+  inline void createTestMsg(ignition::msgs::FluidPressure &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1457,7 +1457,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::FluidPressure &_msg)
+  inline void compareTestMsg(const ignition::msgs::FluidPressure &_msg)
   {
     ignition::msgs::FluidPressure expected_msg;
     createTestMsg(expected_msg);
@@ -1469,7 +1469,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::IMU &_msg)
+  inline void createTestMsg(ignition::msgs::IMU &_msg)
   {
     ignition::msgs::Header header_msg;
     ignition::msgs::Quaternion quaternion_msg;
@@ -1487,7 +1487,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::IMU &_msg)
+  inline void compareTestMsg(const ignition::msgs::IMU &_msg)
   {
     compareTestMsg(_msg.header());
     compareTestMsg(_msg.orientation());
@@ -1497,7 +1497,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Axis &_msg)
+  inline void createTestMsg(ignition::msgs::Axis &_msg)
   {
     _msg.set_position(1.0);
     _msg.set_velocity(2.0);
@@ -1506,7 +1506,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Axis &_msg)
+  inline void compareTestMsg(const ignition::msgs::Axis &_msg)
   {
     ignition::msgs::Axis expected_msg;
     createTestMsg(expected_msg);
@@ -1518,7 +1518,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Model &_msg)
+  inline void createTestMsg(ignition::msgs::Model &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1537,7 +1537,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Model &_msg)
+  inline void compareTestMsg(const ignition::msgs::Model &_msg)
   {
     ignition::msgs::Model expected_msg;
     createTestMsg(expected_msg);
@@ -1554,7 +1554,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::LaserScan &_msg)
+  inline void createTestMsg(ignition::msgs::LaserScan &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1582,7 +1582,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::LaserScan &_msg)
+  inline void compareTestMsg(const ignition::msgs::LaserScan &_msg)
   {
     ignition::msgs::LaserScan expected_msg;
     createTestMsg(expected_msg);
@@ -1613,7 +1613,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Magnetometer &_msg)
+  inline void createTestMsg(ignition::msgs::Magnetometer &_msg)
   {
     ignition::msgs::Header header_msg;
     ignition::msgs::Vector3d vector3_msg;
@@ -1627,7 +1627,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Magnetometer &_msg)
+  inline void compareTestMsg(const ignition::msgs::Magnetometer &_msg)
   {
     compareTestMsg(_msg.header());
     compareTestMsg(_msg.field_tesla());
@@ -1635,7 +1635,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Actuators &_msg)
+  inline void createTestMsg(ignition::msgs::Actuators &_msg)
   {
     ignition::msgs::Header header_msg;
 
@@ -1652,7 +1652,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Actuators &_msg)
+  inline void compareTestMsg(const ignition::msgs::Actuators &_msg)
   {
     ignition::msgs::Actuators expected_msg;
     createTestMsg(expected_msg);
@@ -1669,7 +1669,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::OccupancyGrid &_msg)
+  inline void createTestMsg(ignition::msgs::OccupancyGrid &_msg)
   {
     ignition::msgs::Header header_msg;
     ignition::msgs::Pose pose_msg;
@@ -1693,7 +1693,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::OccupancyGrid &_msg)
+  inline void compareTestMsg(const ignition::msgs::OccupancyGrid &_msg)
   {
     compareTestMsg(_msg.header());
 
@@ -1710,7 +1710,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Odometry &_msg)
+  inline void createTestMsg(ignition::msgs::Odometry &_msg)
   {
     ignition::msgs::Header header_msg;
     ignition::msgs::Pose pose_msg;
@@ -1727,7 +1727,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Odometry &_msg)
+  inline void compareTestMsg(const ignition::msgs::Odometry &_msg)
   {
     compareTestMsg(_msg.header());
     compareTestMsg(_msg.pose());
@@ -1736,7 +1736,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::PointCloudPacked &_msg)
+  inline void createTestMsg(ignition::msgs::PointCloudPacked &_msg)
   {
     ignition::msgs::Header header_msg;
 
@@ -1776,7 +1776,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::PointCloudPacked &_msg)
+  inline void compareTestMsg(const ignition::msgs::PointCloudPacked &_msg)
   {
     compareTestMsg(_msg.header());
 
@@ -1807,7 +1807,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::BatteryState &_msg)
+  inline void createTestMsg(ignition::msgs::BatteryState &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1823,7 +1823,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::BatteryState &_msg)
+  inline void compareTestMsg(const ignition::msgs::BatteryState &_msg)
   {
     ignition::msgs::BatteryState expected_msg;
     createTestMsg(expected_msg);
@@ -1842,7 +1842,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Marker &_msg)
+  inline void createTestMsg(ignition::msgs::Marker &_msg)
   {
     ignition::msgs::Header header_msg;
     createTestMsg(header_msg);
@@ -1871,7 +1871,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Marker &_msg)
+  inline void compareTestMsg(const ignition::msgs::Marker &_msg)
   {
     ignition::msgs::Marker expected_msg;
     createTestMsg(expected_msg);
@@ -1901,7 +1901,7 @@ namespace testing
 
   /// \brief Create a message used for testing.
   /// \param[out] _msg The message populated.
-  void createTestMsg(ignition::msgs::Marker_V &_msg)
+  inline void createTestMsg(ignition::msgs::Marker_V &_msg)
   {
     // Not setting header because the ROS MarkerArray doesn't use it.
     createTestMsg(*_msg.add_marker());
@@ -1909,7 +1909,7 @@ namespace testing
 
   /// \brief Compare a message with the populated for testing.
   /// \param[in] _msg The message to compare.
-  void compareTestMsg(const ignition::msgs::Marker_V &_msg)
+  inline void compareTestMsg(const ignition::msgs::Marker_V &_msg)
   {
     ignition::msgs::Marker_V expected_msg;
     createTestMsg(expected_msg);
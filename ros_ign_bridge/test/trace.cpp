@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ros_ign_bridge/trace.hpp"
+
+// Built twice: test_trace with the trace points compiled out, like the
+// default build, and test_trace_enabled with them compiled in.
+
+/////////////////////////////////////////////////
+/// \brief Count how often trace arguments are evaluated.
+int g_evaluated = 0;
+
+/////////////////////////////////////////////////
+std::string detail()
+{
+  ++g_evaluated;
+  return "/topic";
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a whole file.
+std::string read(const std::string &_path)
+{
+  std::ifstream file(_path);
+  std::stringstream stream;
+  stream << file.rdbuf();
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the occurrences of a string.
+size_t count(const std::string &_text, const std::string &_pattern)
+{
+  size_t result = 0;
+  for (auto pos = _text.find(_pattern); pos != std::string::npos;
+      pos = _text.find(_pattern, pos + 1))
+  {
+    ++result;
+  }
+  return result;
+}
+
+#ifndef ROS_IGN_BRIDGE_TRACING
+
+/////////////////////////////////////////////////
+/// \brief Only compiles if the trace points expand to no code at all, since
+/// nothing else may appear in a C++14 constexpr function.
+constexpr int traced()
+{
+  ROS_IGN_TRACE_INSTANT("receive", detail());
+  ROS_IGN_TRACE_BEGIN("convert", detail());
+  ROS_IGN_TRACE_END("convert");
+  ROS_IGN_TRACE_SCOPE("publish", detail());
+  return 1;
+}
+static_assert(traced() == 1, "Trace points must compile out");
+
+/////////////////////////////////////////////////
+TEST(TraceTest, CompiledOut)
+{
+  ROS_IGN_TRACE_INSTANT("receive", detail());
+  ROS_IGN_TRACE_BEGIN("convert", detail());
+  ROS_IGN_TRACE_END("convert");
+  {
+    ROS_IGN_TRACE_SCOPE("publish", detail());
+  }
+
+  EXPECT_EQ(0, g_evaluated);
+
+  // The file is set, but nothing was compiled in to record to it
+  EXPECT_TRUE(read(::getenv("ROS_IGN_BRIDGE_TRACE_FILE")).empty());
+}
+
+#else
+
+/////////////////////////////////////////////////
+TEST(TraceTest, Macros)
+{
+  auto recorder = ros_ign_bridge::TraceRecorder::instance();
+  ASSERT_NE(nullptr, recorder);
+
+  ROS_IGN_TRACE_INSTANT("receive", detail());
+  ROS_IGN_TRACE_BEGIN("convert", detail());
+  ROS_IGN_TRACE_END("convert");
+  {
+    ROS_IGN_TRACE_SCOPE("publish", detail());
+    ROS_IGN_TRACE_SCOPE("nested", "literal");
+  }
+  EXPECT_EQ(3, g_evaluated);
+
+  std::string path = ::getenv("ROS_IGN_BRIDGE_TRACE_FILE");
+  ASSERT_TRUE(recorder->write(path));
+  auto json = read(path);
+
+  EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_EQ(1u, count(json, "\"name\":\"receive\",\"cat\":\"ros_ign\","
+      "\"ph\":\"i\""));
+  EXPECT_EQ(1u, count(json, "\"name\":\"convert\",\"cat\":\"ros_ign\","
+      "\"ph\":\"B\""));
+  EXPECT_EQ(1u, count(json, "\"name\":\"convert\",\"cat\":\"ros_ign\","
+      "\"ph\":\"E\""));
+  EXPECT_EQ(1u, count(json, "\"name\":\"publish\",\"cat\":\"ros_ign\","
+      "\"ph\":\"X\""));
+  EXPECT_EQ(3u, count(json, "\"args\":{\"detail\":\"/topic\"}"));
+  EXPECT_EQ(1u, count(json, "\"args\":{\"detail\":\"literal\"}"));
+  EXPECT_EQ(2u, count(json, "\"dur\":"));
+}
+
+/////////////////////////////////////////////////
+TEST(TraceTest, Threads)
+{
+  ros_ign_bridge::TraceRecorder recorder("");
+
+  const int kThreads = 4;
+  const int kEvents = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t)
+  {
+    threads.emplace_back([&recorder]()
+    {
+      for (int i = 0; i < kEvents; ++i)
+      {
+        recorder.record("receive", "", 'i',
+            std::chrono::steady_clock::now());
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  char path[] = "/tmp/test_trace_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_NE(-1, fd);
+  ::close(fd);
+
+  ASSERT_TRUE(recorder.write(path));
+  auto json = read(path);
+  ::unlink(path);
+
+  EXPECT_EQ(static_cast<size_t>(kThreads * kEvents),
+      count(json, "\"name\":\"receive\""));
+
+  // Each thread has its own id
+  std::vector<std::string> ids;
+  for (auto pos = json.find("\"tid\":"); pos != std::string::npos;
+      pos = json.find("\"tid\":", pos + 1))
+  {
+    auto id = json.substr(pos, json.find(',', pos) - pos);
+    if (std::find(ids.begin(), ids.end(), id) == ids.end())
+      ids.push_back(id);
+  }
+  EXPECT_EQ(static_cast<size_t>(kThreads), ids.size());
+}
+
+/////////////////////////////////////////////////
+TEST(TraceTest, Escape)
+{
+  ros_ign_bridge::TraceRecorder recorder("");
+  recorder.record("publish", "a \"quoted\"\\path\n", 'i',
+      std::chrono::steady_clock::now());
+
+  char path[] = "/tmp/test_trace_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_NE(-1, fd);
+  ::close(fd);
+
+  ASSERT_TRUE(recorder.write(path));
+  auto json = read(path);
+  ::unlink(path);
+
+  EXPECT_NE(std::string::npos,
+      json.find("\"detail\":\"a \\\"quoted\\\"\\\\path\\u000a\""));
+}
+
+/////////////////////////////////////////////////
+TEST(TraceTest, Microseconds)
+{
+  ros_ign_bridge::TraceRecorder recorder("");
+
+  // Hours after the clock started, when doubles printed with the default
+  // precision only resolve to tens of milliseconds
+  std::chrono::steady_clock::time_point start(std::chrono::hours(10));
+  recorder.record("receive", "", 'i', start);
+  recorder.record("publish", "", 'X', start + std::chrono::microseconds(1),
+      std::chrono::nanoseconds(1500));
+
+  char path[] = "/tmp/test_trace_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_NE(-1, fd);
+  ::close(fd);
+
+  ASSERT_TRUE(recorder.write(path));
+  auto json = read(path);
+  ::unlink(path);
+
+  std::vector<double> ts;
+  for (auto pos = json.find("\"ts\":"); pos != std::string::npos;
+      pos = json.find("\"ts\":", pos + 1))
+  {
+    ts.push_back(std::stod(json.substr(pos + 5)));
+  }
+  ASSERT_EQ(2u, ts.size());
+  EXPECT_DOUBLE_EQ(1.0, ts[1] - ts[0]);
+  EXPECT_EQ(1u, count(json, "\"ts\":36000000000.000,"));
+  EXPECT_EQ(1u, count(json, "\"ts\":36000000001.000,"));
+  EXPECT_EQ(1u, count(json, "\"dur\":1.500"));
+}
+
+#endif
+
+/////////////////////////////////////////////////
+/// \brief File the process' recorder writes to.
+char g_path[] = "/tmp/test_trace_XXXXXX";
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Before the recorder is first used
+  int fd = ::mkstemp(g_path);
+  if (fd == -1)
+    return 1;
+  ::close(fd);
+  ::setenv("ROS_IGN_BRIDGE_TRACE_FILE", g_path, 1);
+
+  // Registered before the recorder is created, so runs after it's destroyed
+  // and has written the file
+  std::atexit([]()
+  {
+    ::unlink(g_path);
+  });
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
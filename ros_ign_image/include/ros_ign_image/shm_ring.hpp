@@ -0,0 +1,118 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_IMAGE__SHM_RING_HPP_
+#define ROS_IGN_IMAGE__SHM_RING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ros_ign_image
+{
+
+/// \brief Ring of fixed size slots in POSIX shared memory, written by one
+/// process and read by any number of processes on the same machine.
+///
+/// The writer fills slots in order, and announces each frame with its slot
+/// and sequence number, for example in a ros_ign_image/ShmImage message.
+/// Readers use the frame in place, without copying it, and then check that
+/// the slot still holds the same sequence. If it doesn't, the writer lapped
+/// the reader and the data read may be torn, so it must be discarded. Rings
+/// with more slots give readers more time.
+///
+/// Usage by a reader:
+///
+/// ~~~
+/// auto ring = ros_ign_image::ShmRing::Open(msg.shm_name);
+/// auto data = ring->Data(msg.slot);
+/// // ... process data ...
+/// if (!ring->IsValid(msg.slot, msg.sequence))
+///   // ... discard results ...
+/// ~~~
+class ShmRing
+{
+  /// \brief Create a ring, replacing any existing one with the same name.
+  /// The shared memory object is removed when the ring is destroyed.
+  /// \param[in] _name Shared memory object name, starting with `/`
+  /// \param[in] _slot_count Number of slots, at least 2
+  /// \param[in] _slot_size Bytes per slot
+  /// \return Ring, or null on failure.
+  public: static std::unique_ptr<ShmRing> Create(const std::string & _name,
+      uint32_t _slot_count, uint64_t _slot_size);
+
+  /// \brief Open an existing ring for reading.
+  /// \param[in] _name Shared memory object name
+  /// \return Ring, or null if it doesn't exist or isn't a ring.
+  public: static std::unique_ptr<ShmRing> Open(const std::string & _name);
+
+  /// \brief Destructor, unmaps the ring and removes it if created here.
+  public: ~ShmRing();
+
+  /// \brief Shared memory object name
+  /// \return Name
+  public: const std::string & Name() const;
+
+  /// \brief Number of slots
+  /// \return Slot count
+  public: uint32_t SlotCount() const;
+
+  /// \brief Bytes per slot
+  /// \return Slot size
+  public: uint64_t SlotSize() const;
+
+  /// \brief Start writing the next slot. Only for rings created with Create.
+  /// \param[out] _slot Slot index
+  /// \return Slot memory, SlotSize() bytes
+  public: uint8_t * BeginWrite(uint32_t & _slot);
+
+  /// \brief Finish writing a slot, which makes it valid for readers.
+  /// \param[in] _slot Slot index from BeginWrite
+  /// \return Sequence number readers need to validate the frame.
+  public: uint64_t EndWrite(uint32_t _slot);
+
+  /// \brief Slot memory for reading.
+  /// \param[in] _slot Slot index
+  /// \return Slot memory, or null if the index is out of range.
+  public: const uint8_t * Data(uint32_t _slot) const;
+
+  /// \brief Check if a slot still holds a frame. Call after reading it.
+  /// \param[in] _slot Slot index
+  /// \param[in] _sequence Sequence number returned by EndWrite
+  /// \return True if nothing was written to the slot since.
+  public: bool IsValid(uint32_t _slot, uint64_t _sequence) const;
+
+  /// \brief Constructor, use Create or Open.
+  private: ShmRing();
+
+  /// \brief Shared memory object name
+  private: std::string name;
+
+  /// \brief Mapped memory
+  private: uint8_t * memory{nullptr};
+
+  /// \brief Size of the mapped memory
+  private: size_t size{0};
+
+  /// \brief True if this process created the ring and writes to it
+  private: bool owner{false};
+
+  /// \brief Next slot to write
+  private: uint32_t next_slot{0};
+};
+
+}  // namespace ros_ign_image
+
+#endif  // ROS_IGN_IMAGE__SHM_RING_HPP_
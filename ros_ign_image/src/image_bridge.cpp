@@ -12,44 +12,1327 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <ignition/transport/Node.hh>
 
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <image_transport/image_transport.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <ros_ign_bridge/convert.hpp>
+#include <ros_ign_bridge/trace.hpp>
+#include <ros_ign_image/ShmImage.h>
+#include <ros_ign_image/shm_ring.hpp>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include "image_codec.hpp"
+#include "image_ops.hpp"
+
+//////////////////////////////////////////////////
+/// \brief Options which can be set per topic.
+struct TopicOptions
+{
+  /// \brief True to also bridge camera info and publish it together with
+  /// images using image_transport::CameraPublisher.
+  bool camera_info{false};
+
+  /// \brief Ignition camera info topic. Defaults to `camera_info` next to the
+  /// image topic, which is where Ignition cameras publish it.
+  std::string camera_info_topic;
+
+  /// \brief Crop, downscale and encoding applied while converting images.
+  ros_ign_image::ImageTransform transform;
+
+  /// \brief Also write images to a shared memory ring, announced on
+  /// `<topic>/shm`, for consumers on the same machine.
+  bool shm{false};
+
+  /// \brief Number of slots in the shared memory ring
+  int shm_slots{4};
+
+  /// \brief Publish `<topic>/compressed` from the encoder threads instead
+  /// of the compressed_image_transport plugin.
+  bool compressed{false};
+
+  /// \brief Codec and quality of compressed images
+  ros_ign_image::CompressionOptions compression;
+
+  /// \brief Frames older than this many seconds of simulation time are
+  /// dropped before conversion, zero to keep all frames.
+  double max_age{0.0};
+};
+
+//////////////////////////////////////////////////
+/// \brief A frame converted for every output which has subscribers.
+struct ConvertedFrame
+{
+  /// \brief True if image holds an image to publish
+  bool has_image{false};
+
+  /// \brief ROS image
+  sensor_msgs::Image image;
+
+  /// \brief ROS camera info, if enabled
+  sensor_msgs::CameraInfo info;
+
+  /// \brief True if shm_image announces an image written to shared memory
+  bool has_shm_image{false};
+
+  /// \brief Announcement of the image written to shared memory
+  ros_ign_image::ShmImage shm_image;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get a parameter for a topic, looking up `~<topic>/<name>` first
+/// and then `~<name>`, which applies to all topics.
+/// \param[in] _private_node Node handle in the private namespace
+/// \param[in] _topic Image topic
+/// \param[in] _name Parameter name
+/// \param[in] _default Value used if the parameter isn't set
+/// \return Parameter value
+template<typename T>
+T TopicParam(const ros::NodeHandle & _private_node, const std::string & _topic,
+    const std::string & _name, const T & _default)
+{
+  auto ns = _topic.substr(std::min(_topic.find_first_not_of('/'), _topic.size()));
+
+  T value;
+  if (!ns.empty() && _private_node.getParam(ns + "/" + _name, value))
+    return value;
+  if (_private_node.getParam(_name, value))
+    return value;
+  return _default;
+}
+
+//////////////////////////////////////////////////
+/// \brief Load the options for a topic from the parameter server.
+/// \param[in] _private_node Node handle in the private namespace
+/// \param[in] _topic Image topic
+/// \return Topic options
+TopicOptions LoadTopicOptions(const ros::NodeHandle & _private_node,
+    const std::string & _topic)
+{
+  TopicOptions options;
+  options.camera_info = TopicParam(_private_node, _topic, "camera_info", false);
+
+  auto default_info_topic =
+      _topic.substr(0, _topic.rfind('/') + 1) + "camera_info";
+  options.camera_info_topic = TopicParam(_private_node, _topic,
+      "camera_info_topic", default_info_topic);
+
+  auto & transform = options.transform;
+  transform.downscale = std::max(1, TopicParam(_private_node, _topic,
+      "downscale", 1));
+  auto filter = TopicParam<std::string>(_private_node, _topic,
+      "downscale_filter", "area");
+  if (filter == "nearest")
+  {
+    transform.filter = ros_ign_image::DownscaleFilter::NEAREST;
+  }
+  else if (filter != "area")
+  {
+    ROS_ERROR("Unknown downscale_filter [%s] for topic [%s], using [area]",
+        filter.c_str(), _topic.c_str());
+  }
+  transform.roi_x = std::max(0, TopicParam(_private_node, _topic, "roi_x", 0));
+  transform.roi_y = std::max(0, TopicParam(_private_node, _topic, "roi_y", 0));
+  transform.roi_width = std::max(0, TopicParam(_private_node, _topic,
+      "roi_width", 0));
+  transform.roi_height = std::max(0, TopicParam(_private_node, _topic,
+      "roi_height", 0));
+
+  transform.encoding = TopicParam<std::string>(_private_node, _topic,
+      "encoding", "");
+  if (!transform.encoding.empty() &&
+      !ros_ign_image::supports_encoding(transform.encoding))
+  {
+    ROS_ERROR("Unsupported encoding [%s] for topic [%s], keeping the "
+        "original encoding", transform.encoding.c_str(), _topic.c_str());
+    transform.encoding.clear();
+  }
+
+  options.shm = TopicParam(_private_node, _topic, "shm", false);
+  options.shm_slots = std::max(2, TopicParam(_private_node, _topic,
+      "shm_slots", 4));
+
+  auto compression = TopicParam<std::string>(_private_node, _topic,
+      "compression", "none");
+  if (compression != "none")
+  {
+    options.compressed = ros_ign_image::parse_compression_format(compression,
+        options.compression.format);
+    if (!options.compressed)
+    {
+      ROS_ERROR("Unknown compression [%s] for topic [%s], using the "
+          "image_transport plugin", compression.c_str(), _topic.c_str());
+    }
+  }
+  options.compression.jpeg_quality = TopicParam(_private_node, _topic,
+      "jpeg_quality", 80);
+  options.compression.png_level = TopicParam(_private_node, _topic,
+      "png_level", 9);
+
+  options.max_age = std::max(0.0, TopicParam(_private_node, _topic,
+      "max_age", 0.0));
+
+  return options;
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert an Ignition header stamp to nanoseconds.
+/// \param[in] _header Ignition header
+/// \return Nanoseconds
+int64_t StampNanoseconds(const ignition::msgs::Header & _header)
+{
+  return _header.stamp().sec() * 1000000000LL + _header.stamp().nsec();
+}
+
+//////////////////////////////////////////////////
+/// \brief Latest simulation time published by Ignition, used to tell how
+/// old frames are.
+class SimClock
+{
+  /// \brief Constructor
+  /// \param[in] _topic Ignition clock topic
+  public: explicit SimClock(const std::string & _topic)
+  {
+    this->node.Subscribe(_topic, &SimClock::OnClock, this);
+  }
+
+  /// \brief Latest simulation time.
+  /// \return Nanoseconds, or -1 before the first clock message.
+  public: int64_t Now() const
+  {
+    return this->now.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Callback when the clock is received
+  /// \param[in] _msg Ignition clock
+  private: void OnClock(const ignition::msgs::Clock & _msg)
+  {
+    const auto & sim = _msg.sim();
+    this->now.store(sim.sec() * 1000000000LL + sim.nsec(),
+        std::memory_order_relaxed);
+  }
+
+  /// \brief Ignition node
+  private: ignition::transport::Node node;
+
+  /// \brief Latest simulation time in nanoseconds
+  private: std::atomic<int64_t> now{-1};
+};
+
+//////////////////////////////////////////////////
+/// \brief Pool of threads which run queued jobs.
+class WorkerPool
+{
+  /// \brief Constructor
+  /// \param[in] _thread_count Number of worker threads
+  public: explicit WorkerPool(unsigned int _thread_count)
+  {
+    for (auto i = 0u; i < _thread_count; ++i)
+      this->threads.emplace_back(&WorkerPool::Run, this);
+  }
+
+  /// \brief Destructor, waits for running jobs and drops queued ones.
+  public: ~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stop = true;
+    }
+    this->condition.notify_all();
+
+    for (auto &thread : this->threads)
+      thread.join();
+  }
+
+  /// \brief Queue a job to be run by the next free worker.
+  /// \param[in] _job Job to run
+  public: void Post(std::function<void()> _job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->stop)
+        return;
+      this->jobs.push_back(std::move(_job));
+    }
+    this->condition.notify_one();
+  }
+
+  /// \brief Worker thread loop
+  private: void Run()
+  {
+    while (true)
+    {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condition.wait(lock, [this]
+        {
+          return this->stop || !this->jobs.empty();
+        });
+
+        if (this->stop)
+          return;
+
+        job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+  /// \brief Worker threads
+  private: std::vector<std::thread> threads;
+
+  /// \brief Jobs waiting for a worker
+  private: std::deque<std::function<void()>> jobs;
+
+  /// \brief Protects jobs and stop
+  private: std::mutex mutex;
+
+  /// \brief Wakes up workers
+  private: std::condition_variable condition;
+
+  /// \brief True when shutting down
+  private: bool stop{false};
+};
+
+class Handler;
+
+//////////////////////////////////////////////////
+/// \brief Synchronizes frames from several topics, such as the cameras of a
+/// stereo rig.
+///
+/// Frames are matched by their simulation timestamp. Once a frame has been
+/// received from every topic, the whole group is converted on a worker and
+/// published back to back. A group which isn't complete within the timeout
+/// is dropped, and so are older groups once a newer one is complete, since
+/// each topic delivers its frames in order. As with single topics, only the
+/// latest complete group waits for a worker.
+class Group : public std::enable_shared_from_this<Group>
+{
+  /// \brief Constructor
+  /// \param[in] _name Name used in diagnostics
+  /// \param[in] _timeout Seconds to wait for a group to be complete
+  /// \param[in] _pool Workers which convert and publish groups, must outlive
+  /// the group
+  public: Group(const std::string & _name, double _timeout, WorkerPool & _pool)
+    : name(_name),
+      timeout(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(_timeout))),
+      pool(_pool)
+  {
+  }
+
+  /// \brief Add a topic to the group.
+  /// \param[in] _handler Handler for the topic
+  /// \return Index of the topic within the group
+  public: size_t AddMember(std::shared_ptr<Handler> _handler)
+  {
+    this->members.push_back(_handler);
+    return this->members.size() - 1;
+  }
+
+  /// \brief Name used in diagnostics
+  /// \return Group name
+  public: const std::string & Name() const
+  {
+    return this->name;
+  }
+
+  /// \brief Total number of ROS subscribers to all topics in the group.
+  /// \return Subscriber count
+  public: uint32_t NumSubscribers() const;
+
+  /// \brief Update the Ignition subscriptions of all topics in the group.
+  public: void UpdateSubscriptions();
+
+  /// \brief Add a frame received on one of the topics.
+  /// \param[in] _index Index of the topic within the group
+  /// \param[in] _ign_msg Ignition image
+  public: void Add(size_t _index, const ignition::msgs::Image & _ign_msg)
+  {
+    const int64_t key = StampNanoseconds(_ign_msg.header());
+    const auto now = std::chrono::steady_clock::now();
+    auto msg = std::make_shared<ignition::msgs::Image>(_ign_msg);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->ExpireLocked(now);
+
+    auto & group = this->pending[key];
+    if (group.frames.empty())
+    {
+      group.frames.resize(this->members.size());
+      group.first = now;
+    }
+    if (!group.frames[_index])
+      ++group.count;
+    group.frames[_index] = std::move(msg);
+
+    if (group.count < this->members.size())
+      return;
+
+    ++this->complete_count;
+    auto frames = std::move(group.frames);
+
+    // Older groups can't be completed anymore
+    auto it = this->pending.find(key);
+    this->incomplete_count += std::distance(this->pending.begin(), it);
+    this->pending.erase(this->pending.begin(), std::next(it));
+
+    if (!this->latest.empty())
+      ++this->superseded_count;
+    this->latest = std::move(frames);
+
+    if (this->scheduled)
+      return;
+
+    // Queued jobs don't keep the group alive
+    this->scheduled = true;
+    std::weak_ptr<Group> weak = this->shared_from_this();
+    this->pool.Post([weak]
+    {
+      if (auto self = weak.lock())
+        self->Process();
+    });
+  }
+
+  /// \brief Drop groups which timed out. Groups also expire when frames
+  /// arrive, this catches topics which stopped publishing altogether.
+  public: void Expire()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->ExpireLocked(std::chrono::steady_clock::now());
+  }
+
+  /// \brief Fill diagnostics with group counters.
+  /// \param[out] _status Diagnostic status
+  public: void ProduceDiagnostics(
+      diagnostic_updater::DiagnosticStatusWrapper & _status)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto new_incomplete = this->incomplete_count - this->reported_incomplete;
+    this->reported_incomplete = this->incomplete_count;
+    if (new_incomplete > 0)
+    {
+      _status.summaryf(diagnostic_msgs::DiagnosticStatus::WARN,
+          "%lu incomplete groups dropped", new_incomplete);
+    }
+    else
+    {
+      _status.summary(diagnostic_msgs::DiagnosticStatus::OK, "OK");
+    }
+
+    _status.add("Topics", this->members.size());
+    _status.add("Complete groups", this->complete_count);
+    _status.add("Incomplete groups", this->incomplete_count);
+    _status.add("Superseded groups", this->superseded_count);
+    _status.add("Published groups", this->published_count);
+    _status.add("Pending groups", this->pending.size());
+  }
+
+  /// \brief Drop groups older than the timeout. Must hold mutex.
+  /// \param[in] _now Current time
+  private: void ExpireLocked(std::chrono::steady_clock::time_point _now)
+  {
+    for (auto it = this->pending.begin(); it != this->pending.end();)
+    {
+      if (_now - it->second.first < this->timeout)
+      {
+        ++it;
+        continue;
+      }
+      ROS_DEBUG("Dropping incomplete group [%s] with [%lu / %lu] frames",
+          this->name.c_str(), it->second.count, this->members.size());
+      ++this->incomplete_count;
+      it = this->pending.erase(it);
+    }
+  }
+
+  /// \brief Convert and publish groups until none is waiting. Runs on a
+  /// worker thread, and never on more than one at a time per group.
+  private: void Process();
+
+  /// \brief Frames received for one timestamp
+  private: struct Pending
+  {
+    /// \brief Frame per topic, null until received
+    std::vector<std::shared_ptr<ignition::msgs::Image>> frames;
+
+    /// \brief Number of frames received
+    size_t count{0};
+
+    /// \brief When the first frame was received
+    std::chrono::steady_clock::time_point first;
+  };
+
+  /// \brief Name used in diagnostics
+  private: std::string name;
+
+  /// \brief How long to wait for a group to be complete
+  private: std::chrono::steady_clock::duration timeout;
+
+  /// \brief Workers which convert and publish groups
+  private: WorkerPool & pool;
+
+  /// \brief Handlers of the topics in the group, which own the group
+  private: std::vector<std::weak_ptr<Handler>> members;
+
+  /// \brief Protects everything below
+  private: std::mutex mutex;
+
+  /// \brief Incomplete groups, by timestamp in nanoseconds
+  private: std::map<int64_t, Pending> pending;
+
+  /// \brief Latest complete group which hasn't been published yet
+  private: std::vector<std::shared_ptr<ignition::msgs::Image>> latest;
+
+  /// \brief True while a job to process this group is queued or running
+  private: bool scheduled{false};
+
+  /// \brief Number of groups which received all frames
+  private: uint64_t complete_count{0};
+
+  /// \brief Number of groups dropped before receiving all frames
+  private: uint64_t incomplete_count{0};
+
+  /// \brief Number of complete groups replaced by a newer one before a
+  /// worker could publish them
+  private: uint64_t superseded_count{0};
+
+  /// \brief Number of groups published
+  private: uint64_t published_count{0};
+
+  /// \brief Incomplete groups already reported in diagnostics
+  private: uint64_t reported_incomplete{0};
+};
 
 //////////////////////////////////////////////////
 /// \brief Bridges one topic
-class Handler
+///
+/// Frames are received on Ignition Transport's thread and handed to a worker
+/// through a one-slot mailbox: if a frame arrives before the previous one was
+/// converted, the older one is dropped, so a slow topic never queues stale
+/// frames nor delays other topics.
+class Handler : public std::enable_shared_from_this<Handler>
 {
   /// \brief Constructor
   /// \param[in] _topic Image base topic
+  /// \param[in] _options Options for this topic
+  /// \param[in] _ros_node ROS node, used for shared memory announcements
   /// \param[in] _it_node Pointer to image transport node
-  /// \param[in] _ign_node Pointer to Ignition node
+  /// \param[in] _pool Workers which convert and publish frames, must
+  /// outlive the handler
+  /// \param[in] _encoder_pool Workers which compress images, must outlive
+  /// the handler
+  /// \param[in] _clock Simulation clock, must outlive the handler
   public: Handler(
       const std::string & _topic,
+      const TopicOptions & _options,
+      const ros::NodeHandle & _ros_node,
       std::shared_ptr<image_transport::ImageTransport> _it_node,
-      std::shared_ptr<ignition::transport::Node> _ign_node)
+      WorkerPool & _pool,
+      WorkerPool & _encoder_pool,
+      const SimClock & _clock)
+    : topic(_topic), options(_options), ros_node(_ros_node),
+      it_node(_it_node), pool(_pool), encoder_pool(_encoder_pool),
+      clock(_clock),
+      max_age(static_cast<int64_t>(_options.max_age * 1e9))
+  {
+  }
+
+  /// \brief Check if a frame is older than max_age, counting it as dropped
+  /// if it is. Frames are never stale before the clock is received.
+  /// \param[in] _ign_msg Ignition image
+  /// \return True if the frame should be dropped.
+  public: bool IsStale(const ignition::msgs::Image & _ign_msg)
+  {
+    if (this->max_age <= 0)
+      return false;
+
+    const auto now = this->clock.Now();
+    if (now < 0 || now - StampNanoseconds(_ign_msg.header()) <= this->max_age)
+      return false;
+
+    std::lock_guard<std::mutex> lock(this->stats_mutex);
+    ++this->stale_count;
+    return true;
+  }
+
+  /// \brief Record that a frame was published, to measure how far behind
+  /// simulation time it was.
+  /// \param[in] _ign_msg Ignition image
+  public: void RecordPublished(const ignition::msgs::Image & _ign_msg)
+  {
+    const auto now = this->clock.Now();
+
+    std::lock_guard<std::mutex> lock(this->stats_mutex);
+    ++this->published_count;
+    if (now < 0)
+      return;
+
+    const double latency = (now - StampNanoseconds(_ign_msg.header())) / 1e9;
+    this->latency_sum += latency;
+    this->latency_max = std::max(this->latency_max, latency);
+    ++this->latency_count;
+  }
+
+  /// \brief Fill diagnostics with frame counters and latencies since the
+  /// previous report.
+  /// \param[out] _status Diagnostic status
+  public: void ProduceDiagnostics(
+      diagnostic_updater::DiagnosticStatusWrapper & _status)
+  {
+    std::lock_guard<std::mutex> lock(this->stats_mutex);
+
+    auto new_stale = this->stale_count - this->reported_stale;
+    this->reported_stale = this->stale_count;
+    if (new_stale > 0)
+    {
+      _status.summaryf(diagnostic_msgs::DiagnosticStatus::WARN,
+          "%lu frames older than max_age dropped", new_stale);
+    }
+    else
+    {
+      _status.summary(diagnostic_msgs::DiagnosticStatus::OK, "OK");
+    }
+
+    _status.add("Published messages", this->published_count);
+    _status.add("Stale frames", this->stale_count);
+    if (this->latency_count > 0)
+    {
+      _status.add("Mean latency (s)",
+          this->latency_sum / this->latency_count);
+      _status.add("Max latency (s)", this->latency_max);
+    }
+    this->latency_sum = 0.0;
+    this->latency_max = 0.0;
+    this->latency_count = 0;
+  }
+
+  /// \brief Advertise the ROS topic. The Ignition topic is only subscribed
+  /// to while there are ROS subscribers, on any image transport. Not done on
+  /// the constructor because callbacks need shared_from_this.
+  public: void Start()
+  {
+    std::weak_ptr<Handler> weak = this->shared_from_this();
+    auto status_cb = [weak](const image_transport::SingleSubscriberPublisher &)
+    {
+      if (auto self = weak.lock())
+        self->OnSubscribersChanged();
+    };
+
+    // The built-in compressed output takes the plugin's topic
+    if (this->options.compressed)
+      this->DisableCompressedPlugin();
+
+    if (this->options.camera_info)
+    {
+      auto info_status_cb = [weak](const ros::SingleSubscriberPublisher &)
+      {
+        if (auto self = weak.lock())
+          self->OnSubscribersChanged();
+      };
+
+      this->camera_pub = this->it_node->advertiseCamera(this->topic, 1,
+          status_cb, status_cb, info_status_cb, info_status_cb);
+    }
+    else
+    {
+      this->image_pub = this->it_node->advertise(this->topic, 1, status_cb,
+          status_cb);
+    }
+
+    if (this->options.shm)
+    {
+      auto shm_status_cb = [weak](const ros::SingleSubscriberPublisher &)
+      {
+        if (auto self = weak.lock())
+          self->OnSubscribersChanged();
+      };
+
+      this->shm_pub = this->ros_node.advertise<ros_ign_image::ShmImage>(
+          this->topic + "/shm", 1, shm_status_cb, shm_status_cb);
+    }
+
+    if (this->options.compressed)
+    {
+      auto compressed_status_cb = [weak](const ros::SingleSubscriberPublisher &)
+      {
+        if (auto self = weak.lock())
+          self->OnSubscribersChanged();
+      };
+
+      this->compressed_pub =
+          this->ros_node.advertise<sensor_msgs::CompressedImage>(
+          this->topic + "/compressed", 1, compressed_status_cb,
+          compressed_status_cb);
+    }
+  }
+
+  /// \brief Synchronize this topic with the other topics in a group. Must
+  /// be called before Start.
+  /// \param[in] _group Group
+  /// \param[in] _index Index of this topic within the group
+  public: void SetGroup(std::shared_ptr<Group> _group, size_t _index)
+  {
+    this->group = _group;
+    this->group_index = _index;
+  }
+
+  /// \brief Number of ROS subscribers to any output.
+  /// \return Subscriber count
+  public: uint32_t NumSubscribers() const
+  {
+    return this->NumImageSubscribers() + this->NumShmSubscribers() +
+        this->NumCompressedSubscribers();
+  }
+
+  /// \brief Number of ROS subscribers to images or camera info.
+  /// \return Subscriber count
+  private: uint32_t NumImageSubscribers() const
+  {
+    if (this->options.camera_info)
+      return this->camera_pub.getNumSubscribers();
+    return this->image_pub.getNumSubscribers();
+  }
+
+  /// \brief Number of ROS subscribers to shared memory announcements.
+  /// \return Subscriber count
+  private: uint32_t NumShmSubscribers() const
   {
-    this->ros_pub = _it_node->advertise(_topic, 1);
+    return this->options.shm ? this->shm_pub.getNumSubscribers() : 0;
+  }
+
+  /// \brief Number of ROS subscribers to the built-in compressed output.
+  /// \return Subscriber count
+  private: uint32_t NumCompressedSubscribers() const
+  {
+    return this->options.compressed ?
+        this->compressed_pub.getNumSubscribers() : 0;
+  }
+
+  /// \brief Add compressed_image_transport's publisher to the plugins
+  /// image_transport skips for this topic, keeping any already listed.
+  private: void DisableCompressedPlugin()
+  {
+    const std::string plugin{"image_transport/compressed_pub"};
+    auto param = this->ros_node.resolveName(this->topic) +
+        "/disable_pub_plugins";
 
-    _ign_node->Subscribe(_topic, &Handler::OnImage, this);
+    std::vector<std::string> disabled;
+    this->ros_node.getParam(param, disabled);
+    if (std::find(disabled.begin(), disabled.end(), plugin) != disabled.end())
+      return;
+
+    disabled.push_back(plugin);
+    this->ros_node.setParam(param, disabled);
+  }
+
+  /// \brief Callback when ROS subscribers connect or disconnect.
+  private: void OnSubscribersChanged()
+  {
+    if (this->group)
+      this->group->UpdateSubscriptions();
+    else
+      this->UpdateSubscription();
+  }
+
+  /// \brief Subscribe to or unsubscribe from the Ignition topic according
+  /// to the current number of ROS subscribers. Topics in a group are
+  /// subscribed while any topic in the group has subscribers, otherwise
+  /// the group would never be complete.
+  public: void UpdateSubscription()
+  {
+    std::lock_guard<std::mutex> lock(this->subscription_mutex);
+
+    auto has_subscribers = this->group ?
+        this->group->NumSubscribers() > 0 : this->NumSubscribers() > 0;
+    if (has_subscribers && !this->subscribed)
+    {
+      this->ign_node.Subscribe(this->topic, &Handler::OnImage, this);
+      if (this->options.camera_info)
+      {
+        this->ign_node.Subscribe(this->options.camera_info_topic,
+            &Handler::OnCameraInfo, this);
+      }
+      this->subscribed = true;
+      ROS_DEBUG("Subscribed to Ignition topic [%s]", this->topic.c_str());
+    }
+    else if (!has_subscribers && this->subscribed)
+    {
+      this->ign_node.Unsubscribe(this->topic);
+      if (this->options.camera_info)
+        this->ign_node.Unsubscribe(this->options.camera_info_topic);
+      this->subscribed = false;
+      ROS_DEBUG("Unsubscribed from Ignition topic [%s]", this->topic.c_str());
+    }
+  }
+
+  /// \brief Callback when Ignition camera info is received. Cameras publish
+  /// the same info with every frame, so it's only converted when it changes.
+  /// \param[in] _ign_msg Ignition message
+  private: void OnCameraInfo(const ignition::msgs::CameraInfo & _ign_msg)
+  {
+    // The header changes with every message, compare everything else
+    auto content = _ign_msg;
+    content.clear_header();
+    auto serialized = content.SerializeAsString();
+
+    std::lock_guard<std::mutex> lock(this->info_mutex);
+    if (this->has_info && serialized == this->info_serialized)
+      return;
+
+    sensor_msgs::CameraInfo info;
+    ros_ign_bridge::convert_ign_to_ros(_ign_msg, info);
+
+    this->info = info;
+    this->info_serialized = serialized;
+    this->has_info = true;
   }
 
   /// \brief Callback when Ignition image is received
   /// \param[in] _ign_msg Ignition message
   private: void OnImage(const ignition::msgs::Image & _ign_msg)
   {
-    sensor_msgs::Image ros_msg;
-    ros_ign_bridge::convert_ign_to_ros(_ign_msg, ros_msg);
-    this->ros_pub.publish(ros_msg);
+    ROS_IGN_TRACE_INSTANT("receive", this->topic);
+
+    if (this->IsStale(_ign_msg))
+      return;
+
+    if (this->group)
+    {
+      this->group->Add(this->group_index, _ign_msg);
+      return;
+    }
+
+    auto msg = std::make_shared<ignition::msgs::Image>(_ign_msg);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->latest = std::move(msg);
+
+    // Processing is already scheduled, it will pick up the new frame
+    if (this->scheduled)
+      return;
+
+    // Queued jobs don't keep the handler alive
+    this->scheduled = true;
+    std::weak_ptr<Handler> weak = this->shared_from_this();
+    this->pool.Post([weak]
+    {
+      if (auto self = weak.lock())
+        self->Process();
+    });
+  }
+
+  /// \brief Convert and publish frames until the mailbox is empty. Runs on
+  /// a worker thread, and never on more than one at a time per handler.
+  private: void Process()
+  {
+    while (true)
+    {
+      std::shared_ptr<ignition::msgs::Image> ign_msg;
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->latest)
+        {
+          this->scheduled = false;
+          return;
+        }
+        ign_msg = std::move(this->latest);
+      }
+
+      // Subscribers may have left since the frame arrived
+      if (this->NumSubscribers() == 0)
+      {
+        this->UpdateSubscription();
+        continue;
+      }
+
+      // The frame may have waited for a worker
+      if (this->IsStale(*ign_msg))
+        continue;
+
+      ConvertedFrame frame;
+      this->Convert(ign_msg, frame);
+      this->Publish(frame, *ign_msg);
+    }
+  }
+
+  /// \brief Convert a frame for every output which has subscribers. Raw
+  /// images aren't converted if only compressed images are subscribed to,
+  /// which are handed to the encoder threads.
+  /// \param[in] _ign_msg Ignition image
+  /// \param[out] _frame Converted frame
+  public: void Convert(const std::shared_ptr<ignition::msgs::Image> & _ign_msg,
+      ConvertedFrame & _frame)
+  {
+    ROS_IGN_TRACE_SCOPE("convert", this->topic);
+
+    if (this->NumCompressedSubscribers() > 0)
+      this->PostCompression(_ign_msg);
+
+    if (this->NumImageSubscribers() > 0)
+    {
+      _frame.has_image = this->ConvertImage(*_ign_msg, _frame.image,
+          _frame.info);
+    }
+
+    if (this->NumShmSubscribers() > 0)
+      _frame.has_shm_image = this->ConvertShm(*_ign_msg, _frame.shm_image);
+  }
+
+  /// \brief Publish a converted frame.
+  /// \param[in] _frame Converted frame
+  /// \param[in] _ign_msg Ignition image it was converted from
+  public: void Publish(const ConvertedFrame & _frame,
+      const ignition::msgs::Image & _ign_msg)
+  {
+    ROS_IGN_TRACE_SCOPE("publish", this->topic);
+
+    if (_frame.has_image)
+    {
+      if (this->options.camera_info)
+        this->camera_pub.publish(_frame.image, _frame.info);
+      else
+        this->image_pub.publish(_frame.image);
+      this->RecordPublished(_ign_msg);
+    }
+
+    if (_frame.has_shm_image)
+    {
+      this->shm_pub.publish(_frame.shm_image);
+      this->RecordPublished(_ign_msg);
+    }
+  }
+
+  /// \brief Convert a frame to a ROS image, and the latest camera info if
+  /// enabled.
+  /// \param[in] _ign_msg Ignition image
+  /// \param[out] _ros_msg ROS image
+  /// \param[out] _info ROS camera info, stamped like the image. Untouched if
+  /// camera info isn't enabled.
+  /// \return False if the frame can't be published.
+  private: bool ConvertImage(const ignition::msgs::Image & _ign_msg,
+      sensor_msgs::Image & _ros_msg, sensor_msgs::CameraInfo & _info)
+  {
+    if (this->options.transform.IsIdentity())
+    {
+      ros_ign_bridge::convert_ign_to_ros(_ign_msg, _ros_msg);
+    }
+    else if (!ros_ign_image::convert_ign_to_ros(_ign_msg,
+        this->options.transform, _ros_msg))
+    {
+      return false;
+    }
+
+    if (!this->options.camera_info)
+      return true;
+
+    {
+      std::lock_guard<std::mutex> lock(this->info_mutex);
+      if (!this->has_info)
+      {
+        ROS_WARN_THROTTLE(5.0, "Dropping images on [%s] until camera info is "
+            "received on [%s]", this->topic.c_str(),
+            this->options.camera_info_topic.c_str());
+        return false;
+      }
+      _info = this->info;
+    }
+
+    // Stamp both with the image's header so consumers can pair them
+    _info.header = _ros_msg.header;
+
+    // Describe crop and downscale, intrinsics stay those of the full image
+    const auto & transform = this->options.transform;
+    if (transform.ChangesSize())
+    {
+      _info.binning_x = transform.downscale;
+      _info.binning_y = transform.downscale;
+      _info.roi.x_offset = transform.roi_x;
+      _info.roi.y_offset = transform.roi_y;
+      _info.roi.width = _ros_msg.width * transform.downscale;
+      _info.roi.height = _ros_msg.height * transform.downscale;
+    }
+    return true;
+  }
+
+  /// \brief Convert a frame straight into the next slot of the shared
+  /// memory ring. The ring is created on the first frame, sized for it.
+  /// \param[in] _ign_msg Ignition image
+  /// \param[out] _shm_msg Announcement of the written image
+  /// \return False if the frame can't be published.
+  private: bool ConvertShm(const ignition::msgs::Image & _ign_msg,
+      ros_ign_image::ShmImage & _shm_msg)
+  {
+    const auto & transform = this->options.transform;
+
+    ros_ign_image::ImageLayout layout;
+    if (!this->shm_ring)
+    {
+      if (this->shm_failed ||
+          !ros_ign_image::output_layout(_ign_msg, transform, layout))
+      {
+        return false;
+      }
+
+      // POSIX names can't have slashes after the first character
+      auto name = "/ros_ign_image" + this->topic;
+      std::replace(name.begin() + 1, name.end(), '/', '_');
+
+      this->shm_ring = ros_ign_image::ShmRing::Create(name,
+          this->options.shm_slots,
+          static_cast<uint64_t>(layout.step) * layout.height);
+      if (!this->shm_ring)
+      {
+        this->shm_failed = true;
+        return false;
+      }
+    }
+
+    uint32_t slot;
+    auto data = this->shm_ring->BeginWrite(slot);
+    auto converted = ros_ign_image::convert_ign_to_buffer(_ign_msg, transform,
+        data, this->shm_ring->SlotSize(), layout);
+    auto sequence = this->shm_ring->EndWrite(slot);
+    if (!converted)
+    {
+      ROS_WARN_THROTTLE(5, "Failed to convert image on [%s] into a shared "
+          "memory slot of [%lu] bytes", this->topic.c_str(),
+          static_cast<unsigned long>(this->shm_ring->SlotSize()));
+      return false;
+    }
+
+    ros_ign_bridge::convert_ign_to_ros(_ign_msg.header(), _shm_msg.header);
+    _shm_msg.shm_name = this->shm_ring->Name();
+    _shm_msg.slot = slot;
+    _shm_msg.sequence = sequence;
+    _shm_msg.height = layout.height;
+    _shm_msg.width = layout.width;
+    _shm_msg.encoding = layout.encoding;
+    _shm_msg.is_bigendian = false;
+    _shm_msg.step = layout.step;
+    return true;
+  }
+
+  /// \brief Hand a frame to the encoder threads, through a one-slot
+  /// mailbox like the one between Ignition and the conversion workers.
+  /// \param[in] _ign_msg Ignition image
+  private: void PostCompression(std::shared_ptr<ignition::msgs::Image> _ign_msg)
+  {
+    std::lock_guard<std::mutex> lock(this->compress_mutex);
+    this->compress_latest = std::move(_ign_msg);
+
+    if (this->compress_scheduled)
+      return;
+
+    this->compress_scheduled = true;
+    std::weak_ptr<Handler> weak = this->shared_from_this();
+    this->encoder_pool.Post([weak]
+    {
+      if (auto self = weak.lock())
+        self->Compress();
+    });
+  }
+
+  /// \brief Compress and publish frames until the mailbox is empty. Runs
+  /// on an encoder thread, and never on more than one at a time per handler.
+  private: void Compress()
+  {
+    while (true)
+    {
+      std::shared_ptr<ignition::msgs::Image> ign_msg;
+      {
+        std::lock_guard<std::mutex> lock(this->compress_mutex);
+        if (!this->compress_latest)
+        {
+          this->compress_scheduled = false;
+          return;
+        }
+        ign_msg = std::move(this->compress_latest);
+      }
+
+      if (this->NumCompressedSubscribers() == 0 || this->IsStale(*ign_msg))
+        continue;
+
+      sensor_msgs::CompressedImage compressed;
+      if (ros_ign_image::compress_ign_image(*ign_msg, this->options.transform,
+          this->options.compression, compressed))
+      {
+        this->compressed_pub.publish(compressed);
+        this->RecordPublished(*ign_msg);
+      }
+    }
+  }
+
+  /// \brief Image topic
+  private: std::string topic;
+
+  /// \brief Options for this topic
+  private: TopicOptions options;
+
+  /// \brief ROS node
+  private: ros::NodeHandle ros_node;
+
+  /// \brief Image transport node
+  private: std::shared_ptr<image_transport::ImageTransport> it_node;
+
+  /// \brief ROS image publisher, used without camera info
+  private: image_transport::Publisher image_pub;
+
+  /// \brief ROS image and camera info publisher, used with camera info
+  private: image_transport::CameraPublisher camera_pub;
+
+  /// \brief Shared memory announcement publisher, used with shm
+  private: ros::Publisher shm_pub;
+
+  /// \brief Compressed image publisher, used with compression
+  private: ros::Publisher compressed_pub;
+
+  /// \brief Shared memory ring, created on the first frame. Only accessed
+  /// from the worker converting this topic.
+  private: std::unique_ptr<ros_ign_image::ShmRing> shm_ring;
+
+  /// \brief True if the ring couldn't be created, so it isn't retried
+  private: bool shm_failed{false};
+
+  /// \brief Protects info, info_serialized and has_info
+  private: std::mutex info_mutex;
+
+  /// \brief Latest camera info, already converted
+  private: sensor_msgs::CameraInfo info;
+
+  /// \brief Latest Ignition camera info without header, to detect changes
+  private: std::string info_serialized;
+
+  /// \brief True once camera info has been received
+  private: bool has_info{false};
+
+  /// \brief Ignition node, one per handler so it unsubscribes on destruction.
+  private: ignition::transport::Node ign_node;
+
+  /// \brief Protects subscribed
+  private: std::mutex subscription_mutex;
+
+  /// \brief True while subscribed to the Ignition topic
+  private: bool subscribed{false};
+
+  /// \brief Workers which convert and publish frames
+  private: WorkerPool & pool;
+
+  /// \brief Protects latest and scheduled
+  private: std::mutex mutex;
+
+  /// \brief Latest frame which hasn't been converted yet
+  private: std::shared_ptr<ignition::msgs::Image> latest;
+
+  /// \brief True while a job to process this handler is queued or running
+  private: bool scheduled{false};
+
+  /// \brief Workers which compress images
+  private: WorkerPool & encoder_pool;
+
+  /// \brief Protects compress_latest and compress_scheduled
+  private: std::mutex compress_mutex;
+
+  /// \brief Latest frame which hasn't been compressed yet
+  private: std::shared_ptr<ignition::msgs::Image> compress_latest;
+
+  /// \brief True while a job to compress frames is queued or running
+  private: bool compress_scheduled{false};
+
+  /// \brief Simulation clock
+  private: const SimClock & clock;
+
+  /// \brief Maximum frame age in nanoseconds, zero to keep all frames
+  private: int64_t max_age;
+
+  /// \brief Protects the counters below
+  private: std::mutex stats_mutex;
+
+  /// \brief Number of frames dropped for being older than max_age
+  private: uint64_t stale_count{0};
+
+  /// \brief Stale frames already reported in diagnostics
+  private: uint64_t reported_stale{0};
+
+  /// \brief Number of messages published, on any output
+  private: uint64_t published_count{0};
+
+  /// \brief Sum of latencies since the last report, in seconds
+  private: double latency_sum{0.0};
+
+  /// \brief Largest latency since the last report, in seconds
+  private: double latency_max{0.0};
+
+  /// \brief Number of latencies since the last report
+  private: uint64_t latency_count{0};
+
+  /// \brief Group this topic is synchronized with, null if it isn't.
+  private: std::shared_ptr<Group> group;
+
+  /// \brief Index of this topic within its group
+  private: size_t group_index{0};
+};
+
+//////////////////////////////////////////////////
+uint32_t Group::NumSubscribers() const
+{
+  uint32_t count{0};
+  for (const auto & member : this->members)
+  {
+    if (auto handler = member.lock())
+      count += handler->NumSubscribers();
+  }
+  return count;
+}
+
+//////////////////////////////////////////////////
+void Group::UpdateSubscriptions()
+{
+  for (const auto & member : this->members)
+  {
+    if (auto handler = member.lock())
+      handler->UpdateSubscription();
+  }
+}
+
+//////////////////////////////////////////////////
+void Group::Process()
+{
+  while (true)
+  {
+    std::vector<std::shared_ptr<ignition::msgs::Image>> frames;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->latest.empty())
+      {
+        this->scheduled = false;
+        return;
+      }
+      frames = std::move(this->latest);
+      this->latest.clear();
+    }
+
+    // Subscribers may have left since the frames arrived
+    if (this->NumSubscribers() == 0)
+    {
+      this->UpdateSubscriptions();
+      continue;
+    }
+
+    const auto size = this->members.size();
+    std::vector<std::shared_ptr<Handler>> handlers(size);
+    for (size_t i = 0; i < size; ++i)
+      handlers[i] = this->members[i].lock();
+
+    // The group may have waited for a worker, and is dropped as a whole if
+    // any frame got too old
+    bool stale{false};
+    for (size_t i = 0; i < size && !stale; ++i)
+      stale = handlers[i] && handlers[i]->IsStale(*frames[i]);
+    if (stale)
+      continue;
+
+    // Convert everything first, so the group is published back to back
+    std::vector<ConvertedFrame> converted(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (handlers[i])
+        handlers[i]->Convert(frames[i], converted[i]);
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (handlers[i])
+        handlers[i]->Publish(converted[i], *frames[i]);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    ++this->published_count;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Bridges one topic from ROS to Ignition
+///
+/// Images are received through image_transport, so compressed and other
+/// transports are decoded before conversion. Callbacks run on the threads
+/// spinning the callback queue of the image transport node, which decode
+/// and convert frames in parallel across topics. With a queue size of 1, a
+/// slow topic drops stale frames instead of queueing them.
+class RosToIgnHandler
+{
+  /// \brief Constructor
+  /// \param[in] _topic Image base topic, also used on Ignition
+  /// \param[in] _transport Image transport to subscribe with, such as raw
+  /// or compressed
+  /// \param[in] _it_node Image transport node
+  public: RosToIgnHandler(
+      const std::string & _topic,
+      const std::string & _transport,
+      image_transport::ImageTransport & _it_node)
+    : topic(_topic)
+  {
+    this->ign_pub = this->ign_node.Advertise<ignition::msgs::Image>(
+        this->topic);
+
+    this->image_sub = _it_node.subscribe(this->topic, 1,
+        &RosToIgnHandler::OnImage, this,
+        image_transport::TransportHints(_transport));
+  }
+
+  /// \brief Callback when a ROS image is received, already decoded.
+  /// \param[in] _ros_msg ROS image
+  private: void OnImage(const sensor_msgs::ImageConstPtr & _ros_msg)
+  {
+    ROS_IGN_TRACE_INSTANT("receive", this->topic);
+
+    // Don't convert frames nobody receives
+    if (!this->ign_pub.HasConnections())
+      return;
+
+    ignition::msgs::Image ign_msg;
+    {
+      ROS_IGN_TRACE_SCOPE("convert", this->topic);
+      ros_ign_bridge::convert_ros_to_ign(*_ros_msg, ign_msg);
+    }
+
+    ROS_IGN_TRACE_SCOPE("publish", this->topic);
+    this->ign_pub.Publish(ign_msg);
   }
 
-  /// \brief ROS image publisher
-  private: image_transport::Publisher ros_pub;
+  /// \brief Image topic
+  private: std::string topic;
+
+  /// \brief Ignition node
+  private: ignition::transport::Node ign_node;
+
+  /// \brief Ignition image publisher
+  private: ignition::transport::Node::Publisher ign_pub;
+
+  /// \brief ROS image subscriber
+  private: image_transport::Subscriber image_sub;
 };
 
 //////////////////////////////////////////////////
@@ -57,41 +1340,261 @@ void usage()
 {
   std::cerr << "Bridge a collection of Ignition Transport image topics to ROS "
             << "using image_transport.\n\n"
-            << "  image_bridge <topic> <topic> ..\n\n"
-            << "E.g.: image_bridge /camera/front/image_raw" << std::endl;
+            << "  image_bridge [--threads <count>] [--encoder-threads <count>]\n"
+            << "               [--group <topic>,<topic>,..] [--ros-to-ign <topic>]\n"
+            << "               <topic> <topic> ..\n\n"
+            << "  --threads     Number of conversion threads shared by all\n"
+            << "                topics in each direction, defaults to one per\n"
+            << "                topic.\n"
+            << "  --group       Comma separated topics whose frames are\n"
+            << "                published together once all of them arrived\n"
+            << "                with the same timestamp. Can be repeated.\n"
+            << "                Groups which aren't complete within the\n"
+            << "                ~group_timeout parameter, 0.5 seconds by\n"
+            << "                default, are dropped.\n"
+            << "  --encoder-threads\n"
+            << "                Number of threads compressing images for\n"
+            << "                topics with compression, defaults to one per\n"
+            << "                topic.\n"
+            << "  --ros-to-ign  Bridge a topic from ROS to Ignition instead,\n"
+            << "                subscribing with the image transport set by\n"
+            << "                ~<topic>/image_transport or ~image_transport,\n"
+            << "                raw by default. Can be repeated.\n\n"
+            << "Per-topic options are read from the private parameters\n"
+            << "~<topic>/<option>, or ~<option> for all topics:\n\n"
+            << "  camera_info        Also bridge camera info, defaults to false.\n"
+            << "  camera_info_topic  Ignition camera info topic, defaults to\n"
+            << "                     camera_info next to the image topic.\n"
+            << "  downscale          Integer factor to scale images down by,\n"
+            << "                     defaults to 1.\n"
+            << "  downscale_filter   [area] or [nearest], defaults to area.\n"
+            << "  roi_x, roi_y,      Region of interest to crop, in pixels.\n"
+            << "  roi_width,         Zero width or height extend to the\n"
+            << "  roi_height         image's edge. Defaults to the whole image.\n"
+            << "  encoding           ROS encoding to transcode images to, such\n"
+            << "                     as bgr8, or 16UC1 for depth in millimeters.\n"
+            << "                     Defaults to the Ignition pixel format.\n"
+            << "  shm                Also write images to a shared memory ring\n"
+            << "                     announced on <topic>/shm, defaults to false.\n"
+            << "  shm_slots          Slots in the ring, defaults to 4.\n"
+            << "  compression        [jpeg] or [png] to publish <topic>/compressed\n"
+            << "                     from encoder threads instead of the\n"
+            << "                     image_transport plugin, defaults to none.\n"
+            << "  jpeg_quality       1 to 100, defaults to 80.\n"
+            << "  png_level          0 to 9, defaults to 9.\n"
+            << "  max_age            Drop frames older than this many seconds\n"
+            << "                     of simulation time, as published on the\n"
+            << "                     ~clock_topic parameter, /clock by default.\n"
+            << "                     Defaults to 0, keeping all frames.\n\n"
+            << "E.g.: image_bridge /camera/front/image_raw\n"
+            << "      image_bridge --group /stereo/left/image,/stereo/right/image\n"
+            << "      image_bridge --ros-to-ign /camera/image _image_transport:=compressed"
+            << std::endl;
 }
 
 //////////////////////////////////////////////////
 int main(int argc, char * argv[])
 {
-  if (argc < 2)
+  ros::init(argc, argv, "ros_ign_image");
+
+  // Parse options, ros::init already removed remapping arguments
+  unsigned int thread_count{0};
+  unsigned int encoder_thread_count{0};
+  std::vector<std::string> topics;
+  std::vector<std::string> ros_to_ign_topics;
+  std::vector<std::vector<std::string>> group_topics;
+  auto is_bridged = [&topics, &ros_to_ign_topics](const std::string & _topic)
+  {
+    if (std::find(topics.begin(), topics.end(), _topic) == topics.end() &&
+        std::find(ros_to_ign_topics.begin(), ros_to_ign_topics.end(),
+            _topic) == ros_to_ign_topics.end())
+    {
+      return false;
+    }
+    std::cerr << "Topic [" << _topic << "] is bridged more than once"
+              << std::endl;
+    return true;
+  };
+  for (auto i = 1; i < argc; ++i)
+  {
+    auto arg = std::string(argv[i]);
+    if (arg == "--group")
+    {
+      if (i + 1 >= argc)
+      {
+        usage();
+        return -1;
+      }
+
+      std::vector<std::string> group;
+      std::stringstream stream(argv[++i]);
+      std::string topic;
+      while (std::getline(stream, topic, ','))
+      {
+        if (topic.empty())
+          continue;
+        if (is_bridged(topic))
+          return -1;
+        group.push_back(topic);
+        topics.push_back(topic);
+      }
+
+      if (group.size() < 2)
+      {
+        usage();
+        return -1;
+      }
+      group_topics.push_back(group);
+      continue;
+    }
+    if (arg == "--threads" || arg == "--encoder-threads")
+    {
+      if (i + 1 >= argc)
+      {
+        usage();
+        return -1;
+      }
+      try
+      {
+        auto & count = arg == "--threads" ? thread_count : encoder_thread_count;
+        count = std::stoul(argv[++i]);
+      }
+      catch (std::exception &)
+      {
+        usage();
+        return -1;
+      }
+      continue;
+    }
+    if (arg == "--ros-to-ign")
+    {
+      if (i + 1 >= argc)
+      {
+        usage();
+        return -1;
+      }
+      if (is_bridged(argv[++i]))
+        return -1;
+      ros_to_ign_topics.push_back(argv[i]);
+      continue;
+    }
+    if (is_bridged(arg))
+      return -1;
+    topics.push_back(arg);
+  }
+
+  if (topics.empty() && ros_to_ign_topics.empty())
   {
     usage();
     return -1;
   }
 
-  ros::init(argc, argv, "ros_ign_image");
-
   // ROS node
   ros::NodeHandle ros_node;
+  ros::NodeHandle private_node("~");
   auto it_node = std::make_shared<image_transport::ImageTransport>(ros_node);
 
-  // Ignition node
-  auto ign_node = std::make_shared<ignition::transport::Node>();
+  std::map<std::string, TopicOptions> topic_options;
+  unsigned int compressed_count{0};
+  for (const auto &topic : topics)
+  {
+    topic_options[topic] = LoadTopicOptions(private_node, topic);
+    if (topic_options[topic].compressed)
+      ++compressed_count;
+  }
+
+  // Simulation time, to drop old frames and measure latency
+  SimClock clock(private_node.param<std::string>("clock_topic", "/clock"));
 
-  std::vector<std::shared_ptr<Handler>> handlers;
+  // Conversion and encoder workers, destroyed after the handlers
+  WorkerPool pool(thread_count > 0 ? thread_count : topics.size());
+  WorkerPool encoder_pool(compressed_count == 0 ? 0 :
+      encoder_thread_count > 0 ? encoder_thread_count : compressed_count);
+
+  std::map<std::string, std::shared_ptr<Handler>> handlers;
+  for (const auto &topic : topics)
+  {
+    handlers[topic] = std::make_shared<Handler>(topic, topic_options[topic],
+        ros_node, it_node, pool, encoder_pool, clock);
+  }
+
+  // Synchronized groups
+  double group_timeout = private_node.param("group_timeout", 0.5);
+  std::vector<std::shared_ptr<Group>> groups;
+  for (const auto &group_topic : group_topics)
+  {
+    std::string name;
+    for (const auto &topic : group_topic)
+      name += (name.empty() ? "" : ",") + topic;
+
+    auto group = std::make_shared<Group>(name, group_timeout, pool);
+    for (const auto &topic : group_topic)
+    {
+      auto handler = handlers[topic];
+      handler->SetGroup(group, group->AddMember(handler));
+    }
+    groups.push_back(group);
+  }
 
   // Create publishers and subscribers
-  for (auto i = 1; i < argc; ++i)
+  for (auto &handler : handlers)
+    handler.second->Start();
+
+  // Report topic and group counters
+  diagnostic_updater::Updater diagnostics(ros_node, private_node);
+  diagnostics.setHardwareID("none");
+  for (auto &handler : handlers)
+  {
+    diagnostics.add("Topic " + handler.first, handler.second.get(),
+        &Handler::ProduceDiagnostics);
+  }
+  for (auto &group : groups)
+  {
+    diagnostics.add("Group " + group->Name(), group.get(),
+        &Group::ProduceDiagnostics);
+  }
+
+  ros::WallTimer diagnostics_timer;
+  if (!handlers.empty())
   {
-    auto topic = std::string(argv[i]);
-    handlers.push_back(std::make_shared<Handler>(topic, it_node, ign_node));
+    diagnostics_timer = ros_node.createWallTimer(ros::WallDuration(1.0),
+        [&groups, &diagnostics](const ros::WallTimerEvent &)
+        {
+          for (auto &group : groups)
+            group->Expire();
+          diagnostics.update();
+        });
+  }
+
+  // ROS to Ignition topics get their own callback queue, whose threads
+  // decode and convert images without holding up other ROS callbacks. More
+  // threads than topics would stay idle, since each subscription's callbacks
+  // run one at a time.
+  ros::CallbackQueue ros_to_ign_queue;
+  ros::NodeHandle ros_to_ign_node;
+  ros_to_ign_node.setCallbackQueue(&ros_to_ign_queue);
+  image_transport::ImageTransport ros_to_ign_it_node(ros_to_ign_node);
+
+  std::vector<std::unique_ptr<RosToIgnHandler>> ros_to_ign_handlers;
+  for (const auto &topic : ros_to_ign_topics)
+  {
+    auto transport = TopicParam<std::string>(private_node, topic,
+        "image_transport", "raw");
+    ros_to_ign_handlers.push_back(std::make_unique<RosToIgnHandler>(topic,
+        transport, ros_to_ign_it_node));
   }
 
   // Spin ROS and Ign until shutdown
   ros::AsyncSpinner async_spinner(1);
   async_spinner.start();
 
+  auto ros_to_ign_threads = std::min<size_t>(
+      thread_count > 0 ? thread_count : ros_to_ign_topics.size(),
+      ros_to_ign_topics.size());
+  ros::AsyncSpinner ros_to_ign_spinner(ros_to_ign_threads, &ros_to_ign_queue);
+  if (ros_to_ign_threads > 0)
+    ros_to_ign_spinner.start();
+
   ignition::transport::waitForShutdown();
 
   return 0;
@@ -0,0 +1,183 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <ros/console.h>
+#include <ros_ign_bridge/convert.hpp>
+
+#include "image_codec.hpp"
+
+namespace ros_ign_image
+{
+
+namespace
+{
+
+/// \brief How an output encoding is handed to OpenCV
+struct CodecInput
+{
+  /// \brief Encoding of the output image
+  const char * encoding;
+
+  /// \brief Encoding OpenCV compresses from, BGR for color
+  const char * codec_encoding;
+
+  /// \brief OpenCV matrix type
+  int cv_type;
+
+  /// \brief True if JPEG can compress it
+  bool jpeg;
+};
+
+/// \brief Output encodings which can be compressed
+const CodecInput kCodecInputs[] = {
+  {"mono8", "mono8", CV_8UC1, true},
+  {"mono16", "mono16", CV_16UC1, false},
+  {"16UC1", "16UC1", CV_16UC1, false},
+  {"rgb8", "bgr8", CV_8UC3, true},
+  {"bgr8", "bgr8", CV_8UC3, true},
+  {"rgb16", "bgr16", CV_16UC3, false},
+  {"bgr16", "bgr16", CV_16UC3, false},
+};
+
+//////////////////////////////////////////////////
+/// \brief Find how to compress an output encoding.
+/// \return Null if it can't be compressed.
+const CodecInput * find_codec_input(const std::string & _encoding)
+{
+  for (const auto & input : kCodecInputs)
+  {
+    if (_encoding == input.encoding)
+      return &input;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////
+bool parse_compression_format(const std::string & _name,
+    CompressionFormat & _format)
+{
+  if (_name == "jpeg")
+    _format = CompressionFormat::JPEG;
+  else if (_name == "png")
+    _format = CompressionFormat::PNG;
+  else
+    return false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool compress_ign_image(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  const CompressionOptions & _options,
+  sensor_msgs::CompressedImage & _compressed)
+{
+  ImageLayout layout;
+  if (!output_layout(_ign_msg, _transform, layout))
+    return false;
+
+  // RGBA is compressed as BGR too, dropping alpha like the ROS plugin does
+  auto encoding = layout.encoding;
+  if (encoding == "rgba8" || encoding == "bgra8")
+    encoding = "rgb8";
+
+  const auto input = find_codec_input(encoding);
+  const bool jpeg = _options.format == CompressionFormat::JPEG;
+  if (nullptr == input || (jpeg && !input->jpeg))
+  {
+    ROS_ERROR_THROTTLE(5, "Can't compress [%s] images with [%s]",
+        layout.encoding.c_str(), jpeg ? "jpeg" : "png");
+    return false;
+  }
+
+  // Ask for the codec's encoding right away, instead of the output's
+  auto codec_transform = _transform;
+  codec_transform.encoding = input->codec_encoding;
+
+  ImageLayout source;
+  if (!output_layout(_ign_msg, ImageTransform(), source))
+    return false;
+
+  cv::Mat mat;
+  if (!_transform.ChangesSize() && source.encoding == input->codec_encoding)
+  {
+    // Encoders only read the matrix. Rows may be padded in the message,
+    // while the layout is packed.
+    const size_t step = _ign_msg.step() > 0 ? _ign_msg.step() : source.step;
+    mat = cv::Mat(source.height, source.width, input->cv_type,
+        const_cast<char *>(_ign_msg.data().data()), step);
+  }
+  else
+  {
+    ImageLayout codec_layout;
+    if (!output_layout(_ign_msg, codec_transform, codec_layout))
+      return false;
+
+    // Reused across frames converted on the same thread
+    thread_local std::vector<uint8_t> buffer;
+    buffer.resize(static_cast<size_t>(codec_layout.step) *
+        codec_layout.height);
+    if (!convert_ign_to_buffer(_ign_msg, codec_transform, buffer.data(),
+        buffer.size(), codec_layout))
+    {
+      return false;
+    }
+    mat = cv::Mat(codec_layout.height, codec_layout.width, input->cv_type,
+        buffer.data(), codec_layout.step);
+  }
+
+  std::vector<int> params;
+  if (jpeg)
+  {
+    params = {cv::IMWRITE_JPEG_QUALITY,
+        std::min(std::max(_options.jpeg_quality, 1), 100)};
+  }
+  else
+  {
+    params = {cv::IMWRITE_PNG_COMPRESSION,
+        std::min(std::max(_options.png_level, 0), 9)};
+  }
+
+  _compressed.data.clear();
+  try
+  {
+    if (!cv::imencode(jpeg ? ".jpg" : ".png", mat, _compressed.data, params))
+      return false;
+  }
+  catch (const cv::Exception & _e)
+  {
+    ROS_ERROR("Failed to compress image: %s", _e.what());
+    return false;
+  }
+
+  // Same format string as compressed_image_transport, which its subscribers
+  // use to convert the decoded image back to the output encoding
+  ros_ign_bridge::convert_ign_to_ros(_ign_msg.header(), _compressed.header);
+  _compressed.format = layout.encoding +
+      (jpeg ? "; jpeg compressed " : "; png compressed ");
+  if (input->cv_type == CV_8UC3 || input->cv_type == CV_16UC3)
+    _compressed.format += input->codec_encoding;
+
+  return true;
+}
+
+}  // namespace ros_ign_image
@@ -0,0 +1,82 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_IMAGE__IMAGE_CODEC_HPP_
+#define ROS_IGN_IMAGE__IMAGE_CODEC_HPP_
+
+#include <string>
+
+#include <ignition/msgs.hh>
+#include <sensor_msgs/CompressedImage.h>
+
+#include "image_ops.hpp"
+
+namespace ros_ign_image
+{
+
+/// \brief Codec used to compress images.
+enum class CompressionFormat
+{
+  /// \brief Lossy, only for 8 bit images.
+  JPEG,
+
+  /// \brief Lossless, for 8 and 16 bit images.
+  PNG
+};
+
+/// \brief How images are compressed, same as compressed_image_transport's
+/// parameters.
+struct CompressionOptions
+{
+  /// \brief Codec
+  CompressionFormat format{CompressionFormat::JPEG};
+
+  /// \brief JPEG quality, from 1 to 100.
+  int jpeg_quality{80};
+
+  /// \brief PNG compression level, from 0 for fastest to 9 for smallest.
+  int png_level{9};
+};
+
+/// \brief Parse a compression format name.
+/// \param[in] _name `jpeg` or `png`
+/// \param[out] _format Compression format
+/// \return False if the name is unknown.
+bool parse_compression_format(const std::string & _name,
+    CompressionFormat & _format);
+
+/// \brief Crop, downscale and transcode an Ignition image as
+/// convert_ign_to_ros would, and compress the result.
+///
+/// The output is decoded by compressed_image_transport subscribers, into the
+/// encoding convert_ign_to_ros would have produced. Color images are
+/// compressed from BGR, which the swizzle happens on the way into, so
+/// nothing is copied twice. Images which need no changes are compressed
+/// straight from the Ignition message.
+/// \param[in] _ign_msg Ignition image
+/// \param[in] _transform Crop, downscale and encoding to apply
+/// \param[in] _options Codec and quality
+/// \param[out] _compressed Compressed image
+/// \return False if the image can't be converted, see convert_ign_to_ros,
+/// or its encoding can't be compressed with the codec, such as 32FC1 or 16
+/// bit images with JPEG.
+bool compress_ign_image(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  const CompressionOptions & _options,
+  sensor_msgs::CompressedImage & _compressed);
+
+}  // namespace ros_ign_image
+
+#endif  // ROS_IGN_IMAGE__IMAGE_CODEC_HPP_
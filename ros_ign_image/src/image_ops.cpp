@@ -0,0 +1,611 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include <ros/console.h>
+#include <ros_ign_bridge/convert.hpp>
+
+#include "image_ops.hpp"
+
+// Byte shuffles used to transcode pixels need SSSE3, which isn't part of the
+// x86-64 baseline, so row kernels are also built for newer instruction sets
+// and the best one is picked when the library is loaded.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+# define ROS_IGN_IMAGE_ROW_KERNEL \
+  __attribute__((target_clones("default", "ssse3", "avx2")))
+#else
+# define ROS_IGN_IMAGE_ROW_KERNEL
+#endif
+
+namespace ros_ign_image
+{
+
+namespace
+{
+
+//////////////////////////////////////////////////
+/// \brief Copy every _factor-th pixel of every _factor-th row.
+/// \tparam N Bytes per pixel, known at compile time so copies are inlined.
+template<size_t N>
+void downscale_nearest(
+  const uint8_t * _src, size_t _src_step,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  uint8_t * _dst, size_t _dst_step)
+{
+  for (uint32_t y = 0; y < _out_height; ++y)
+  {
+    const uint8_t * src_row = _src + y * _factor * _src_step;
+    uint8_t * dst_row = _dst + y * _dst_step;
+
+    if (_factor == 1)
+    {
+      std::memcpy(dst_row, src_row, _out_width * N);
+      continue;
+    }
+
+    for (uint32_t x = 0; x < _out_width; ++x)
+      std::memcpy(dst_row + x * N, src_row + x * _factor * N, N);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Same as downscale_nearest, for pixel sizes only known at runtime.
+void downscale_nearest(
+  const uint8_t * _src, size_t _src_step, size_t _pixel_bytes,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  uint8_t * _dst, size_t _dst_step)
+{
+  switch (_pixel_bytes)
+  {
+    case 1:
+      downscale_nearest<1>(_src, _src_step, _out_width, _out_height, _factor,
+          _dst, _dst_step);
+      return;
+    case 2:
+      downscale_nearest<2>(_src, _src_step, _out_width, _out_height, _factor,
+          _dst, _dst_step);
+      return;
+    case 3:
+      downscale_nearest<3>(_src, _src_step, _out_width, _out_height, _factor,
+          _dst, _dst_step);
+      return;
+    case 4:
+      downscale_nearest<4>(_src, _src_step, _out_width, _out_height, _factor,
+          _dst, _dst_step);
+      return;
+    case 6:
+      downscale_nearest<6>(_src, _src_step, _out_width, _out_height, _factor,
+          _dst, _dst_step);
+      return;
+    default:
+      break;
+  }
+
+  for (uint32_t y = 0; y < _out_height; ++y)
+  {
+    const uint8_t * src_row = _src + y * _factor * _src_step;
+    uint8_t * dst_row = _dst + y * _dst_step;
+    for (uint32_t x = 0; x < _out_width; ++x)
+    {
+      std::memcpy(dst_row + x * _pixel_bytes,
+          src_row + x * _factor * _pixel_bytes, _pixel_bytes);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Average each _factor x _factor block of pixels.
+///
+/// Rows of a block are first summed into an accumulator row, a contiguous
+/// loop which the compiler vectorizes, then each output pixel sums its
+/// _factor columns from the accumulator.
+/// \tparam T Channel type
+/// \tparam AccT Type wide enough to sum _factor * _factor channels
+/// \tparam F Downscale factor if known at compile time, or zero to use
+/// _factor. Known factors turn the division into multiplications and shifts.
+/// \tparam C Channels if known at compile time, or zero to use _channels.
+template<typename T, typename AccT, uint32_t F, uint32_t C>
+void downscale_area_block(
+  const uint8_t * _src, size_t _src_step, uint32_t _channels,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  uint8_t * _dst, size_t _dst_step)
+{
+  const uint32_t factor = F > 0 ? F : _factor;
+  const uint32_t channels = C > 0 ? C : _channels;
+  const size_t row_values = static_cast<size_t>(_out_width) * factor * channels;
+  const AccT count = static_cast<AccT>(factor) * factor;
+  std::vector<AccT> acc_row(row_values);
+
+  // Accumulator doesn't alias the input or output, which are accessed
+  // through character types
+  AccT * __restrict__ acc = acc_row.data();
+
+  for (uint32_t y = 0; y < _out_height; ++y)
+  {
+    std::fill(acc, acc + row_values, AccT(0));
+    for (uint32_t dy = 0; dy < factor; ++dy)
+    {
+      auto src_row = reinterpret_cast<const T *>(
+          _src + (y * factor + dy) * _src_step);
+      for (size_t i = 0; i < row_values; ++i)
+        acc[i] += src_row[i];
+    }
+
+    auto dst_row = reinterpret_cast<T *>(_dst + y * _dst_step);
+    for (uint32_t x = 0; x < _out_width; ++x)
+    {
+      const AccT * block = acc + x * factor * channels;
+      for (uint32_t c = 0; c < channels; ++c)
+      {
+        AccT sum{0};
+        for (uint32_t dx = 0; dx < factor; ++dx)
+          sum += block[dx * channels + c];
+
+        if constexpr (std::is_integral<T>::value)
+          dst_row[x * channels + c] = static_cast<T>((sum + count / 2) / count);
+        else
+          dst_row[x * channels + c] = static_cast<T>(sum / count);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Dispatch to a downscale_area_block specialized for the factor.
+template<typename T, typename AccT, uint32_t C>
+void downscale_area(
+  const uint8_t * _src, size_t _src_step, uint32_t _channels,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  uint8_t * _dst, size_t _dst_step)
+{
+  switch (_factor)
+  {
+    case 2:
+      downscale_area_block<T, AccT, 2, C>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+    case 4:
+      downscale_area_block<T, AccT, 4, C>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+    default:
+      downscale_area_block<T, AccT, 0, C>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Dispatch to a downscale_area_block specialized for the factor and
+/// number of channels.
+template<typename T, typename AccT>
+void downscale_area(
+  const uint8_t * _src, size_t _src_step, uint32_t _channels,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  uint8_t * _dst, size_t _dst_step)
+{
+  switch (_channels)
+  {
+    case 1:
+      downscale_area<T, AccT, 1>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+    case 3:
+      downscale_area<T, AccT, 3>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+    default:
+      downscale_area<T, AccT, 0>(_src, _src_step, _channels,
+          _out_width, _out_height, _factor, _dst, _dst_step);
+      return;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Copy a row of pixels to 3 channel pixels, optionally swapping the
+/// first and third channels, and dropping any channel past the third.
+/// \tparam T Channel type
+/// \tparam InC Input channels, 3 or 4
+/// \tparam Swap True to swap red and blue
+template<typename T, uint32_t InC, bool Swap>
+ROS_IGN_IMAGE_ROW_KERNEL
+void swizzle_row(const uint8_t * _src, uint8_t * _dst, uint32_t _width)
+{
+  const T * __restrict__ src = reinterpret_cast<const T *>(_src);
+  T * __restrict__ dst = reinterpret_cast<T *>(_dst);
+  for (size_t x = 0; x < _width; ++x)
+  {
+    dst[x * 3 + 0] = src[x * InC + (Swap ? 2 : 0)];
+    dst[x * 3 + 1] = src[x * InC + 1];
+    dst[x * 3 + 2] = src[x * InC + (Swap ? 0 : 2)];
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert a row of float depths in meters to uint16 millimeters.
+/// Comparisons are written so NaN becomes 0 and the loop has no branches.
+ROS_IGN_IMAGE_ROW_KERNEL
+void depth_to_millimeters_row(const uint8_t * _src, uint8_t * _dst,
+    uint32_t _width)
+{
+  const float * __restrict__ src = reinterpret_cast<const float *>(_src);
+  uint16_t * __restrict__ dst = reinterpret_cast<uint16_t *>(_dst);
+  for (size_t x = 0; x < _width; ++x)
+  {
+    float mm = src[x] * 1000.0f + 0.5f;
+    mm = mm > 0.0f ? mm : 0.0f;
+    mm = mm < 65535.0f ? mm : 65535.0f;
+    dst[x] = static_cast<uint16_t>(static_cast<int32_t>(mm));
+  }
+}
+
+/// \brief Transcodes a row of _width pixels from _src into _dst.
+using TranscodeRow = void (*)(const uint8_t * _src, uint8_t * _dst,
+    uint32_t _width);
+
+/// \brief Conversion between two ROS encodings.
+struct Transcoding
+{
+  /// \brief Input encoding
+  const char * from;
+
+  /// \brief Output encoding
+  const char * to;
+
+  /// \brief Bytes per output pixel
+  uint32_t pixel_bytes;
+
+  /// \brief Row kernel
+  TranscodeRow row;
+};
+
+/// \brief All supported transcodings. Same encodings are handled without a
+/// transcoding.
+const Transcoding kTranscodings[] = {
+  {"rgb8", "bgr8", 3, swizzle_row<uint8_t, 3, true>},
+  {"bgr8", "rgb8", 3, swizzle_row<uint8_t, 3, true>},
+  {"rgba8", "rgb8", 3, swizzle_row<uint8_t, 4, false>},
+  {"rgba8", "bgr8", 3, swizzle_row<uint8_t, 4, true>},
+  {"bgra8", "bgr8", 3, swizzle_row<uint8_t, 4, false>},
+  {"bgra8", "rgb8", 3, swizzle_row<uint8_t, 4, true>},
+  {"rgb16", "bgr16", 6, swizzle_row<uint16_t, 3, true>},
+  {"bgr16", "rgb16", 6, swizzle_row<uint16_t, 3, true>},
+  {"32FC1", "16UC1", 2, depth_to_millimeters_row},
+};
+
+//////////////////////////////////////////////////
+/// \brief Find the transcoding between two encodings.
+/// \return Null if there's none.
+const Transcoding * find_transcoding(const std::string & _from,
+    const std::string & _to)
+{
+  for (const auto & transcoding : kTranscodings)
+  {
+    if (_from == transcoding.from && _to == transcoding.to)
+      return &transcoding;
+  }
+  return nullptr;
+}
+
+//////////////////////////////////////////////////
+/// \brief Crop and downscale an image without changing its encoding.
+/// \param[in] _src First pixel of the region of interest
+/// \param[in] _format Pixel format
+void resample(
+  const uint8_t * _src, size_t _src_step, const PixelFormatInfo & _format,
+  uint32_t _out_width, uint32_t _out_height, uint32_t _factor,
+  DownscaleFilter _filter, uint8_t * _dst, size_t _dst_step)
+{
+  if (_factor == 1 || _filter == DownscaleFilter::NEAREST)
+  {
+    downscale_nearest(_src, _src_step,
+        _format.channels * _format.octets_per_channel,
+        _out_width, _out_height, _factor, _dst, _dst_step);
+  }
+  else if (_format.encoding == "32FC1")
+  {
+    downscale_area<float, float>(_src, _src_step, _format.channels,
+        _out_width, _out_height, _factor, _dst, _dst_step);
+  }
+  else if (_format.octets_per_channel == 2)
+  {
+    downscale_area<uint16_t, uint32_t>(_src, _src_step, _format.channels,
+        _out_width, _out_height, _factor, _dst, _dst_step);
+  }
+  else
+  {
+    downscale_area<uint8_t, uint32_t>(_src, _src_step, _format.channels,
+        _out_width, _out_height, _factor, _dst, _dst_step);
+  }
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////
+bool ImageTransform::IsIdentity() const
+{
+  return !this->ChangesSize() && this->encoding.empty();
+}
+
+//////////////////////////////////////////////////
+bool ImageTransform::ChangesSize() const
+{
+  return this->roi_x != 0 || this->roi_y != 0 || this->roi_width != 0 ||
+      this->roi_height != 0 || this->downscale > 1;
+}
+
+//////////////////////////////////////////////////
+bool pixel_format_info(
+  ignition::msgs::PixelFormatType _format,
+  PixelFormatInfo & _info)
+{
+  switch (_format)
+  {
+    case ignition::msgs::PixelFormatType::L_INT8:
+      _info = {"mono8", 1, 1};
+      return true;
+    case ignition::msgs::PixelFormatType::L_INT16:
+      _info = {"mono16", 1, 2};
+      return true;
+    case ignition::msgs::PixelFormatType::RGB_INT8:
+      _info = {"rgb8", 3, 1};
+      return true;
+    case ignition::msgs::PixelFormatType::RGBA_INT8:
+      _info = {"rgba8", 4, 1};
+      return true;
+    case ignition::msgs::PixelFormatType::BGRA_INT8:
+      _info = {"bgra8", 4, 1};
+      return true;
+    case ignition::msgs::PixelFormatType::RGB_INT16:
+      _info = {"rgb16", 3, 2};
+      return true;
+    case ignition::msgs::PixelFormatType::BGR_INT8:
+      _info = {"bgr8", 3, 1};
+      return true;
+    case ignition::msgs::PixelFormatType::BGR_INT16:
+      _info = {"bgr16", 3, 2};
+      return true;
+    case ignition::msgs::PixelFormatType::R_FLOAT32:
+      _info = {"32FC1", 1, 4};
+      return true;
+    default:
+      return false;
+  }
+}
+
+//////////////////////////////////////////////////
+bool supports_encoding(const std::string & _encoding)
+{
+  for (const auto & transcoding : kTranscodings)
+  {
+    if (_encoding == transcoding.to)
+      return true;
+  }
+  return false;
+}
+
+namespace
+{
+
+/// \brief Everything needed to convert an image, worked out before
+/// touching any pixels.
+struct Plan
+{
+  /// \brief Input format
+  PixelFormatInfo format;
+
+  /// \brief Bytes per input pixel
+  size_t pixel_bytes{0};
+
+  /// \brief Bytes per input row
+  size_t src_step{0};
+
+  /// \brief Region of interest origin, clamped to the image
+  uint32_t roi_x{0};
+
+  /// \brief Region of interest origin, clamped to the image
+  uint32_t roi_y{0};
+
+  /// \brief Downscale factor, at least 1
+  uint32_t factor{1};
+
+  /// \brief Transcoding to apply, null to keep the encoding
+  const Transcoding * transcoding{nullptr};
+
+  /// \brief Output layout
+  ImageLayout layout;
+};
+
+//////////////////////////////////////////////////
+/// \brief Validate an image and transform and work out the output layout.
+/// \return False if the image can't be converted, see convert_ign_to_ros.
+bool make_plan(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  Plan & _plan)
+{
+  if (!pixel_format_info(_ign_msg.pixel_format_type(), _plan.format))
+  {
+    ROS_ERROR_STREAM_THROTTLE(5, "Unsupported pixel format ["
+        << _ign_msg.pixel_format_type() << "]" << std::endl);
+    return false;
+  }
+  const auto & format = _plan.format;
+
+  _plan.pixel_bytes = format.channels * format.octets_per_channel;
+  _plan.src_step = _ign_msg.step() > 0 ?
+      _ign_msg.step() : _ign_msg.width() * _plan.pixel_bytes;
+  if (_ign_msg.data().size() < _plan.src_step * _ign_msg.height())
+  {
+    ROS_ERROR_STREAM_THROTTLE(5, "Image has [" << _ign_msg.data().size()
+        << "] bytes, expected at least ["
+        << _plan.src_step * _ign_msg.height() << "]" << std::endl);
+    return false;
+  }
+
+  // Clamp region of interest to the image
+  _plan.roi_x = std::min(_transform.roi_x, _ign_msg.width());
+  _plan.roi_y = std::min(_transform.roi_y, _ign_msg.height());
+  uint32_t roi_width = _ign_msg.width() - _plan.roi_x;
+  if (_transform.roi_width > 0)
+    roi_width = std::min(roi_width, _transform.roi_width);
+  uint32_t roi_height = _ign_msg.height() - _plan.roi_y;
+  if (_transform.roi_height > 0)
+    roi_height = std::min(roi_height, _transform.roi_height);
+
+  _plan.factor = std::max(_transform.downscale, 1u);
+  const uint32_t out_width = roi_width / _plan.factor;
+  const uint32_t out_height = roi_height / _plan.factor;
+  if (out_width == 0 || out_height == 0)
+  {
+    ROS_ERROR_STREAM_THROTTLE(5, "Region of interest [" << roi_width
+        << " x " << roi_height << "] is empty after downscaling by ["
+        << _plan.factor << "]" << std::endl);
+    return false;
+  }
+
+  _plan.transcoding = nullptr;
+  if (!_transform.encoding.empty() && _transform.encoding != format.encoding)
+  {
+    _plan.transcoding = find_transcoding(format.encoding, _transform.encoding);
+    if (nullptr == _plan.transcoding)
+    {
+      ROS_ERROR_STREAM_THROTTLE(5, "Can't transcode [" << format.encoding
+          << "] to [" << _transform.encoding << "]" << std::endl);
+      return false;
+    }
+  }
+
+  auto & layout = _plan.layout;
+  layout.encoding = _plan.transcoding ? _plan.transcoding->to : format.encoding;
+  layout.width = out_width;
+  layout.height = out_height;
+  layout.step = out_width *
+      (_plan.transcoding ? _plan.transcoding->pixel_bytes : _plan.pixel_bytes);
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Write the pixels of a planned conversion.
+/// \param[out] _dst Buffer of at least step * height bytes
+void execute_plan(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  const Plan & _plan,
+  uint8_t * _dst)
+{
+  const auto & layout = _plan.layout;
+  auto src = reinterpret_cast<const uint8_t *>(_ign_msg.data().data()) +
+      _plan.roi_y * _plan.src_step + _plan.roi_x * _plan.pixel_bytes;
+
+  if (nullptr == _plan.transcoding)
+  {
+    resample(src, _plan.src_step, _plan.format, layout.width, layout.height,
+        _plan.factor, _transform.filter, _dst, layout.step);
+    return;
+  }
+
+  // Without downscaling, transcode straight from the region of interest
+  if (_plan.factor == 1)
+  {
+    for (uint32_t y = 0; y < layout.height; ++y)
+    {
+      _plan.transcoding->row(src + y * _plan.src_step, _dst + y * layout.step,
+          layout.width);
+    }
+    return;
+  }
+
+  // Otherwise downscale first, so only the smaller image is transcoded. The
+  // scratch buffer is reused across frames converted on the same thread.
+  thread_local std::vector<uint8_t> scratch;
+  const size_t scratch_step = layout.width * _plan.pixel_bytes;
+  scratch.resize(scratch_step * layout.height);
+  resample(src, _plan.src_step, _plan.format, layout.width, layout.height,
+      _plan.factor, _transform.filter, scratch.data(), scratch_step);
+  for (uint32_t y = 0; y < layout.height; ++y)
+  {
+    _plan.transcoding->row(scratch.data() + y * scratch_step,
+        _dst + y * layout.step, layout.width);
+  }
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////
+bool output_layout(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  ImageLayout & _layout)
+{
+  Plan plan;
+  if (!make_plan(_ign_msg, _transform, plan))
+    return false;
+
+  _layout = plan.layout;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool convert_ign_to_ros(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  sensor_msgs::Image & _ros_msg)
+{
+  Plan plan;
+  if (!make_plan(_ign_msg, _transform, plan))
+    return false;
+
+  ros_ign_bridge::convert_ign_to_ros(_ign_msg.header(), _ros_msg.header);
+  _ros_msg.encoding = plan.layout.encoding;
+  _ros_msg.is_bigendian = false;
+  _ros_msg.width = plan.layout.width;
+  _ros_msg.height = plan.layout.height;
+  _ros_msg.step = plan.layout.step;
+  _ros_msg.data.resize(_ros_msg.step * _ros_msg.height);
+
+  execute_plan(_ign_msg, _transform, plan, _ros_msg.data.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool convert_ign_to_buffer(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  uint8_t * _buffer,
+  size_t _capacity,
+  ImageLayout & _layout)
+{
+  Plan plan;
+  if (!make_plan(_ign_msg, _transform, plan))
+    return false;
+
+  const size_t size = static_cast<size_t>(plan.layout.step) * plan.layout.height;
+  if (size > _capacity)
+  {
+    ROS_ERROR_STREAM_THROTTLE(5, "Image needs [" << size
+        << "] bytes, buffer only has [" << _capacity << "]" << std::endl);
+    return false;
+  }
+
+  execute_plan(_ign_msg, _transform, plan, _buffer);
+  _layout = plan.layout;
+  return true;
+}
+
+}  // namespace ros_ign_image
@@ -0,0 +1,165 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_IMAGE__IMAGE_OPS_HPP_
+#define ROS_IGN_IMAGE__IMAGE_OPS_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <ignition/msgs.hh>
+#include <sensor_msgs/Image.h>
+
+namespace ros_ign_image
+{
+
+/// \brief Filter used to downscale images.
+enum class DownscaleFilter
+{
+  /// \brief Average all input pixels covered by an output pixel.
+  AREA,
+
+  /// \brief Keep the top-left input pixel covered by an output pixel.
+  /// Doesn't blend values, so it's better suited for depth images.
+  NEAREST
+};
+
+/// \brief Changes applied to an image while it's converted from Ignition to
+/// ROS.
+struct ImageTransform
+{
+  /// \brief Left column of the region of interest, in input pixels.
+  uint32_t roi_x{0};
+
+  /// \brief Top row of the region of interest, in input pixels.
+  uint32_t roi_y{0};
+
+  /// \brief Width of the region of interest, zero for the rest of the row.
+  uint32_t roi_width{0};
+
+  /// \brief Height of the region of interest, zero for the rest of the image.
+  uint32_t roi_height{0};
+
+  /// \brief The output is the region of interest scaled down by this factor
+  /// along each axis. Remainder pixels on the right and bottom are dropped.
+  uint32_t downscale{1};
+
+  /// \brief Filter used when downscale is larger than 1.
+  DownscaleFilter filter{DownscaleFilter::AREA};
+
+  /// \brief ROS encoding to transcode images to, empty to keep the encoding
+  /// matching the Ignition pixel format. See supports_encoding.
+  std::string encoding;
+
+  /// \brief Check if images are published as they are received.
+  /// \return True if the transform doesn't change images.
+  bool IsIdentity() const;
+
+  /// \brief Check if the image size changes, due to cropping or downscaling.
+  /// \return True if the output is smaller than the input.
+  bool ChangesSize() const;
+};
+
+/// \brief Information about the layout of an Ignition pixel format.
+struct PixelFormatInfo
+{
+  /// \brief Equivalent ROS encoding
+  std::string encoding;
+
+  /// \brief Number of channels per pixel
+  uint32_t channels{0};
+
+  /// \brief Bytes per channel
+  uint32_t octets_per_channel{0};
+};
+
+/// \brief Size and encoding of a converted image.
+struct ImageLayout
+{
+  /// \brief ROS encoding
+  std::string encoding;
+
+  /// \brief Width in pixels
+  uint32_t width{0};
+
+  /// \brief Height in pixels
+  uint32_t height{0};
+
+  /// \brief Bytes per row, rows are packed
+  uint32_t step{0};
+};
+
+/// \brief Get the ROS encoding and layout of an Ignition pixel format.
+/// \param[in] _format Ignition pixel format
+/// \param[out] _info Format information
+/// \return False if the format isn't supported.
+bool pixel_format_info(
+  ignition::msgs::PixelFormatType _format,
+  PixelFormatInfo & _info);
+
+/// \brief Check if images can be transcoded to an encoding from at least one
+/// Ignition pixel format. Supported conversions are:
+/// * `rgb8`, `rgba8`, `bgra8` and `bgr8` to `rgb8` or `bgr8`, swapping red
+///   and blue and dropping alpha as needed.
+/// * `rgb16` and `bgr16` to `rgb16` or `bgr16`.
+/// * `32FC1` depth in meters to `16UC1` depth in millimeters. Depths are
+///   clamped to [0, 65535] millimeters and NaN becomes 0, which is invalid.
+/// \param[in] _encoding ROS encoding
+/// \return True if the encoding is supported.
+bool supports_encoding(const std::string & _encoding);
+
+/// \brief Convert an Ignition image to ROS, applying a transform in the same
+/// pass as the copy, so the full size image is never copied into a ROS
+/// message.
+/// \param[in] _ign_msg Ignition image
+/// \param[in] _transform Crop, downscale and encoding to apply
+/// \param[out] _ros_msg ROS image
+/// \return False if the pixel format isn't supported, the data is smaller
+/// than the image size, the region of interest is empty, or the image can't
+/// be transcoded to the requested encoding.
+bool convert_ign_to_ros(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  sensor_msgs::Image & _ros_msg);
+
+/// \brief Get the layout an image will have once converted, for example to
+/// size buffers for convert_ign_to_buffer.
+/// \param[in] _ign_msg Ignition image
+/// \param[in] _transform Crop, downscale and encoding to apply
+/// \param[out] _layout Layout of the converted image
+/// \return False if the image can't be converted, see convert_ign_to_ros.
+bool output_layout(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  ImageLayout & _layout);
+
+/// \brief Same as convert_ign_to_ros, writing pixels into a caller owned
+/// buffer, such as shared memory, instead of a ROS message.
+/// \param[in] _ign_msg Ignition image
+/// \param[in] _transform Crop, downscale and encoding to apply
+/// \param[out] _buffer Buffer to write pixels to
+/// \param[in] _capacity Size of _buffer in bytes
+/// \param[out] _layout Layout of the pixels written
+/// \return False if the image can't be converted, see convert_ign_to_ros,
+/// or doesn't fit in the buffer.
+bool convert_ign_to_buffer(
+  const ignition::msgs::Image & _ign_msg,
+  const ImageTransform & _transform,
+  uint8_t * _buffer,
+  size_t _capacity,
+  ImageLayout & _layout);
+
+}  // namespace ros_ign_image
+
+#endif  // ROS_IGN_IMAGE__IMAGE_OPS_HPP_
@@ -0,0 +1,291 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <ros/console.h>
+
+#include "ros_ign_image/shm_ring.hpp"
+
+namespace ros_ign_image
+{
+
+namespace
+{
+
+/// \brief Identifies ring memory, "RIGNSHMR"
+constexpr uint64_t kMagic{0x524d48534e474952ULL};
+
+/// \brief Incremented when the layout changes
+constexpr uint32_t kVersion{1};
+
+/// \brief Slots start at page boundaries, which also keeps them aligned for
+/// vectorized access
+constexpr uint64_t kSlotAlignment{4096};
+
+/// \brief Start of the ring memory
+struct RingHeader
+{
+  /// \brief kMagic once the ring is initialized
+  std::atomic<uint64_t> magic;
+
+  /// \brief kVersion
+  uint32_t version;
+
+  /// \brief Number of slots
+  uint32_t slot_count;
+
+  /// \brief Bytes per slot, a multiple of kSlotAlignment
+  uint64_t slot_size;
+
+  /// \brief Offset of the first slot from the start of the ring
+  uint64_t data_offset;
+};
+
+/// \brief State of a slot, on its own cache line so writing one slot doesn't
+/// slow down readers of the others.
+struct alignas(64) SlotHeader
+{
+  /// \brief Odd while the slot is being written, incremented twice per
+  /// frame. The even value after a write identifies the frame.
+  std::atomic<uint64_t> sequence;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+    "Shared memory needs address-free atomics");
+
+//////////////////////////////////////////////////
+/// \brief Round up to a multiple of an alignment.
+uint64_t align_up(uint64_t _value, uint64_t _alignment)
+{
+  return (_value + _alignment - 1) / _alignment * _alignment;
+}
+
+//////////////////////////////////////////////////
+RingHeader * ring_header(uint8_t * _memory)
+{
+  return reinterpret_cast<RingHeader *>(_memory);
+}
+
+//////////////////////////////////////////////////
+SlotHeader * slot_header(uint8_t * _memory, uint32_t _slot)
+{
+  return reinterpret_cast<SlotHeader *>(
+      _memory + align_up(sizeof(RingHeader), alignof(SlotHeader))) + _slot;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////
+ShmRing::ShmRing() = default;
+
+//////////////////////////////////////////////////
+ShmRing::~ShmRing()
+{
+  if (nullptr != this->memory)
+    munmap(this->memory, this->size);
+  if (this->owner)
+    shm_unlink(this->name.c_str());
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<ShmRing> ShmRing::Create(const std::string & _name,
+    uint32_t _slot_count, uint64_t _slot_size)
+{
+  if (_slot_count < 2 || _slot_size == 0)
+  {
+    ROS_ERROR("Shared memory ring [%s] needs at least 2 slots of 1 byte",
+        _name.c_str());
+    return nullptr;
+  }
+
+  const uint64_t slot_size = align_up(_slot_size, kSlotAlignment);
+  const uint64_t data_offset = align_up(
+      align_up(sizeof(RingHeader), alignof(SlotHeader)) +
+      sizeof(SlotHeader) * _slot_count, kSlotAlignment);
+  const uint64_t size = data_offset + slot_size * _slot_count;
+
+  // Replace rings left behind by processes which didn't exit cleanly
+  shm_unlink(_name.c_str());
+  int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0)
+  {
+    ROS_ERROR("Failed to create shared memory [%s]: %s", _name.c_str(),
+        std::strerror(errno));
+    return nullptr;
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    ROS_ERROR("Failed to size shared memory [%s] to [%lu] bytes: %s",
+        _name.c_str(), static_cast<unsigned long>(size), std::strerror(errno));
+    close(fd);
+    shm_unlink(_name.c_str());
+    return nullptr;
+  }
+
+  void * memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+      0);
+  close(fd);
+  if (MAP_FAILED == memory)
+  {
+    ROS_ERROR("Failed to map shared memory [%s]: %s", _name.c_str(),
+        std::strerror(errno));
+    shm_unlink(_name.c_str());
+    return nullptr;
+  }
+
+  std::unique_ptr<ShmRing> ring(new ShmRing());
+  ring->name = _name;
+  ring->memory = static_cast<uint8_t *>(memory);
+  ring->size = size;
+  ring->owner = true;
+
+  // New memory is zeroed, so all slots start at sequence 0, which no frame
+  // has. Publish the magic last so readers see a complete header.
+  auto header = new (ring->memory) RingHeader;
+  header->version = kVersion;
+  header->slot_count = _slot_count;
+  header->slot_size = slot_size;
+  header->data_offset = data_offset;
+  for (uint32_t i = 0; i < _slot_count; ++i)
+    new (slot_header(ring->memory, i)) SlotHeader{{0}};
+  header->magic.store(kMagic, std::memory_order_release);
+
+  return ring;
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<ShmRing> ShmRing::Open(const std::string & _name)
+{
+  int fd = shm_open(_name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+  {
+    ROS_ERROR("Failed to open shared memory [%s]: %s", _name.c_str(),
+        std::strerror(errno));
+    return nullptr;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(RingHeader))
+  {
+    ROS_ERROR("Shared memory [%s] is too small to be a ring", _name.c_str());
+    close(fd);
+    return nullptr;
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  void * memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == memory)
+  {
+    ROS_ERROR("Failed to map shared memory [%s]: %s", _name.c_str(),
+        std::strerror(errno));
+    return nullptr;
+  }
+
+  std::unique_ptr<ShmRing> ring(new ShmRing());
+  ring->name = _name;
+  ring->memory = static_cast<uint8_t *>(memory);
+  ring->size = size;
+
+  auto header = ring_header(ring->memory);
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->version != kVersion ||
+      header->data_offset + header->slot_size * header->slot_count > size)
+  {
+    ROS_ERROR("Shared memory [%s] isn't a compatible ring", _name.c_str());
+    return nullptr;
+  }
+
+  return ring;
+}
+
+//////////////////////////////////////////////////
+const std::string & ShmRing::Name() const
+{
+  return this->name;
+}
+
+//////////////////////////////////////////////////
+uint32_t ShmRing::SlotCount() const
+{
+  return ring_header(this->memory)->slot_count;
+}
+
+//////////////////////////////////////////////////
+uint64_t ShmRing::SlotSize() const
+{
+  return ring_header(this->memory)->slot_size;
+}
+
+//////////////////////////////////////////////////
+uint8_t * ShmRing::BeginWrite(uint32_t & _slot)
+{
+  if (!this->owner)
+    return nullptr;
+
+  _slot = this->next_slot;
+  this->next_slot = (this->next_slot + 1) % this->SlotCount();
+
+  // Mark the slot as being written before touching its data
+  auto & sequence = slot_header(this->memory, _slot)->sequence;
+  sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto header = ring_header(this->memory);
+  return this->memory + header->data_offset + header->slot_size * _slot;
+}
+
+//////////////////////////////////////////////////
+uint64_t ShmRing::EndWrite(uint32_t _slot)
+{
+  auto & sequence = slot_header(this->memory, _slot)->sequence;
+  const uint64_t done = sequence.load(std::memory_order_relaxed) + 1;
+  sequence.store(done, std::memory_order_release);
+  return done;
+}
+
+//////////////////////////////////////////////////
+const uint8_t * ShmRing::Data(uint32_t _slot) const
+{
+  auto header = ring_header(this->memory);
+  if (_slot >= header->slot_count)
+    return nullptr;
+  return this->memory + header->data_offset + header->slot_size * _slot;
+}
+
+//////////////////////////////////////////////////
+bool ShmRing::IsValid(uint32_t _slot, uint64_t _sequence) const
+{
+  if (_slot >= this->SlotCount())
+    return false;
+
+  // Data reads must complete before the sequence is checked
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot_header(this->memory, _slot)->sequence.load(
+      std::memory_order_relaxed) == _sequence;
+}
+
+}  // namespace ros_ign_image
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <ignition/msgs.hh>
+#include <sensor_msgs/Image.h>
+
+#include "../../src/image_ops.hpp"
+
+//////////////////////////////////////////////////
+/// \brief Create a 1280x720 Ignition image.
+/// \param[in] _format Pixel format
+/// \return Image
+ignition::msgs::Image createImage(ignition::msgs::PixelFormatType _format)
+{
+  ros_ign_image::PixelFormatInfo info;
+  ros_ign_image::pixel_format_info(_format, info);
+
+  const uint32_t width = 1280;
+  const uint32_t height = 720;
+  const uint32_t step = width * info.channels * info.octets_per_channel;
+
+  ignition::msgs::Image msg;
+  msg.set_width(width);
+  msg.set_height(height);
+  msg.set_pixel_format_type(_format);
+  msg.set_step(step);
+  msg.set_data(std::string(step * height, '\x7f'));
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Convert a 1280x720 image with the given transform.
+/// Reports input bytes per second, so the numbers compare across
+/// transforms which produce different output sizes.
+void convert(benchmark::State & _state,
+    ignition::msgs::PixelFormatType _format,
+    uint32_t _downscale, ros_ign_image::DownscaleFilter _filter,
+    uint32_t _roi_width, const std::string & _encoding = "")
+{
+  auto ign_msg = createImage(_format);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = _downscale;
+  transform.filter = _filter;
+  transform.roi_width = _roi_width;
+  transform.encoding = _encoding;
+
+  sensor_msgs::Image ros_msg;
+  for (auto _ : _state)
+  {
+    ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg);
+    benchmark::DoNotOptimize(ros_msg.data.data());
+  }
+  _state.SetBytesProcessed(_state.iterations() * ign_msg.data().size());
+}
+
+using ignition::msgs::PixelFormatType;
+using ros_ign_image::DownscaleFilter;
+
+BENCHMARK_CAPTURE(convert, mono8_full,
+    PixelFormatType::L_INT8, 1, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, mono8_area_2,
+    PixelFormatType::L_INT8, 2, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, mono8_nearest_2,
+    PixelFormatType::L_INT8, 2, DownscaleFilter::NEAREST, 0);
+BENCHMARK_CAPTURE(convert, rgb8_full,
+    PixelFormatType::RGB_INT8, 1, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, rgb8_roi_640,
+    PixelFormatType::RGB_INT8, 1, DownscaleFilter::AREA, 640);
+BENCHMARK_CAPTURE(convert, rgb8_area_2,
+    PixelFormatType::RGB_INT8, 2, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, rgb8_area_4,
+    PixelFormatType::RGB_INT8, 4, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, rgb8_nearest_4,
+    PixelFormatType::RGB_INT8, 4, DownscaleFilter::NEAREST, 0);
+BENCHMARK_CAPTURE(convert, 32FC1_full,
+    PixelFormatType::R_FLOAT32, 1, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, 32FC1_area_2,
+    PixelFormatType::R_FLOAT32, 2, DownscaleFilter::AREA, 0);
+BENCHMARK_CAPTURE(convert, 32FC1_nearest_2,
+    PixelFormatType::R_FLOAT32, 2, DownscaleFilter::NEAREST, 0);
+BENCHMARK_CAPTURE(convert, rgb8_to_bgr8,
+    PixelFormatType::RGB_INT8, 1, DownscaleFilter::AREA, 0, "bgr8");
+BENCHMARK_CAPTURE(convert, rgba8_to_rgb8,
+    PixelFormatType::RGBA_INT8, 1, DownscaleFilter::AREA, 0, "rgb8");
+BENCHMARK_CAPTURE(convert, rgba8_to_bgr8,
+    PixelFormatType::RGBA_INT8, 1, DownscaleFilter::AREA, 0, "bgr8");
+BENCHMARK_CAPTURE(convert, rgb8_area_2_to_bgr8,
+    PixelFormatType::RGB_INT8, 2, DownscaleFilter::AREA, 0, "bgr8");
+BENCHMARK_CAPTURE(convert, 32FC1_to_16UC1,
+    PixelFormatType::R_FLOAT32, 1, DownscaleFilter::AREA, 0, "16UC1");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+// End-to-end latency of images going from Ignition through image_bridge to a
+// ROS subscriber, either as sensor_msgs/Image over TCPROS or through the
+// shared memory ring. Run with shm_latency.launch, which starts the bridge.
+//
+// Images are stamped with the wall clock when published on Ignition, and the
+// subscriber reads every byte of each image before measuring, as a consumer
+// would, so copies the transport saves are reflected in the numbers.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/msgs.hh>
+#include <ignition/transport.hh>
+#include <ros/ros.h>
+#include <ros_ign_image/ShmImage.h>
+#include <ros_ign_image/shm_ring.hpp>
+#include <sensor_msgs/Image.h>
+
+/// \brief Latencies in microseconds
+std::vector<double> g_latencies;
+
+/// \brief Protects g_latencies
+std::mutex g_mutex;
+
+/// \brief Images which were overwritten before being read
+uint64_t g_overwritten{0};
+
+/// \brief Sum of all checksums, so reading images isn't optimized out
+uint64_t g_checksum{0};
+
+//////////////////////////////////////////////////
+/// \brief Nanoseconds since epoch on the wall clock.
+int64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////
+/// \brief Read every byte of an image.
+/// \return Checksum
+uint64_t consume(const uint8_t * _data, size_t _size)
+{
+  uint64_t sum{0};
+  for (size_t i = 0; i < _size; ++i)
+    sum += _data[i];
+  return sum;
+}
+
+//////////////////////////////////////////////////
+/// \brief Record the latency of an image with the given header stamp.
+void record(const ros::Time & _stamp, uint64_t _checksum)
+{
+  auto latency = (now_ns() - (_stamp.sec * 1000000000LL + _stamp.nsec)) / 1e3;
+
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_latencies.push_back(latency);
+  g_checksum += _checksum;
+}
+
+//////////////////////////////////////////////////
+void onImage(const sensor_msgs::ImageConstPtr & _msg)
+{
+  auto checksum = consume(_msg->data.data(), _msg->data.size());
+  record(_msg->header.stamp, checksum);
+}
+
+//////////////////////////////////////////////////
+void onShmImage(const ros_ign_image::ShmImageConstPtr & _msg)
+{
+  static std::unique_ptr<ros_ign_image::ShmRing> ring;
+  if (!ring || ring->Name() != _msg->shm_name)
+  {
+    ring = ros_ign_image::ShmRing::Open(_msg->shm_name);
+    if (!ring)
+      return;
+  }
+
+  auto data = ring->Data(_msg->slot);
+  if (nullptr == data)
+    return;
+
+  auto checksum = consume(data, _msg->step * _msg->height);
+  if (!ring->IsValid(_msg->slot, _msg->sequence))
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ++g_overwritten;
+    return;
+  }
+  record(_msg->header.stamp, checksum);
+}
+
+//////////////////////////////////////////////////
+/// \brief Percentile of sorted values.
+double percentile(const std::vector<double> & _sorted, double _p)
+{
+  auto index = static_cast<size_t>(_p / 100.0 * (_sorted.size() - 1));
+  return _sorted[index];
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char ** argv)
+{
+  ros::init(argc, argv, "shm_latency");
+
+  std::string mode{"shm"};
+  uint32_t width{1920};
+  uint32_t height{1080};
+  double rate{30.0};
+  size_t count{300};
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    std::string arg = argv[i];
+    if (arg == "--mode")
+      mode = argv[i + 1];
+    else if (arg == "--width")
+      width = std::stoul(argv[i + 1]);
+    else if (arg == "--height")
+      height = std::stoul(argv[i + 1]);
+    else if (arg == "--rate")
+      rate = std::stod(argv[i + 1]);
+    else if (arg == "--count")
+      count = std::stoul(argv[i + 1]);
+  }
+
+  const std::string topic{"/shm_latency/image"};
+
+  ros::NodeHandle ros_node;
+  ros::Subscriber sub;
+  if (mode == "tcpros")
+  {
+    sub = ros_node.subscribe(topic, 1, onImage,
+        ros::TransportHints().tcpNoDelay());
+  }
+  else if (mode == "shm")
+  {
+    sub = ros_node.subscribe(topic + "/shm", 1, onShmImage,
+        ros::TransportHints().tcpNoDelay());
+  }
+  else
+  {
+    std::cerr << "Unknown mode [" << mode << "], use tcpros or shm"
+              << std::endl;
+    return -1;
+  }
+
+  ros::AsyncSpinner spinner(1);
+  spinner.start();
+
+  ignition::transport::Node ign_node;
+  auto pub = ign_node.Advertise<ignition::msgs::Image>(topic);
+
+  ignition::msgs::Image msg;
+  msg.set_width(width);
+  msg.set_height(height);
+  msg.set_step(width * 3);
+  msg.set_pixel_format_type(ignition::msgs::PixelFormatType::RGB_INT8);
+  msg.set_data(std::string(width * height * 3, '\x7f'));
+
+  // Wait for the bridge to subscribe on both ends
+  while (ros::ok() && sub.getNumPublishers() == 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  // Warm up, then measure
+  const size_t warmup = 30;
+  auto period = std::chrono::duration<double>(1.0 / rate);
+  for (size_t i = 0; ros::ok() && i < warmup + count; ++i)
+  {
+    if (i == warmup)
+    {
+      std::lock_guard<std::mutex> lock(g_mutex);
+      g_latencies.clear();
+      g_overwritten = 0;
+    }
+
+    auto stamp = now_ns();
+    msg.mutable_header()->mutable_stamp()->set_sec(stamp / 1000000000LL);
+    msg.mutable_header()->mutable_stamp()->set_nsec(stamp % 1000000000LL);
+    pub.Publish(msg);
+    std::this_thread::sleep_for(period);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  std::vector<double> latencies;
+  uint64_t overwritten;
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    latencies = g_latencies;
+    overwritten = g_overwritten;
+  }
+
+  if (latencies.empty())
+  {
+    std::cerr << "No images received" << std::endl;
+    return -1;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << std::fixed << std::setprecision(1)
+            << "mode: " << mode << ", " << width << "x" << height
+            << " rgb8 at " << rate << " Hz\n"
+            << "received: " << latencies.size() << " / " << count
+            << ", overwritten: " << overwritten << "\n"
+            << "latency us: p50 " << percentile(latencies, 50)
+            << ", p90 " << percentile(latencies, 90)
+            << ", p99 " << percentile(latencies, 99)
+            << ", max " << latencies.back() << "\n"
+            << "checksum: " << g_checksum << std::endl;
+
+  ros::shutdown();
+  return 0;
+}
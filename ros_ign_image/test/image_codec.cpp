@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include "../src/image_codec.hpp"
+#include "../src/image_ops.hpp"
+
+//////////////////////////////////////////////////
+/// \brief Create an Ignition image whose channels are numbered in order.
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \param[in] _format Pixel format
+/// \param[in] _padding Values of padding at the end of each row
+/// \return Image
+template<typename T>
+ignition::msgs::Image createImage(uint32_t _width, uint32_t _height,
+    ignition::msgs::PixelFormatType _format, uint32_t _padding = 0)
+{
+  ros_ign_image::PixelFormatInfo info;
+  EXPECT_TRUE(ros_ign_image::pixel_format_info(_format, info));
+
+  const uint32_t row = _width * info.channels + _padding;
+  std::vector<T> values(row * _height);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = i % row < row - _padding ? static_cast<T>(i * 7) : T(0xff);
+
+  ignition::msgs::Image msg;
+  msg.set_width(_width);
+  msg.set_height(_height);
+  msg.set_pixel_format_type(_format);
+  msg.set_step(row * sizeof(T));
+  msg.set_data(values.data(), values.size() * sizeof(T));
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a lossless compressed image decodes to the image
+/// convert_ign_to_ros produces with the given encoding.
+void checkLossless(const ignition::msgs::Image & _ign_msg,
+    ros_ign_image::ImageTransform _transform,
+    const sensor_msgs::CompressedImage & _compressed,
+    const std::string & _decoded_encoding)
+{
+  _transform.encoding = _decoded_encoding;
+  sensor_msgs::Image expected;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(_ign_msg, _transform,
+      expected));
+
+  auto decoded = cv::imdecode(_compressed.data, cv::IMREAD_UNCHANGED);
+  ASSERT_EQ(static_cast<int>(expected.height), decoded.rows);
+  ASSERT_EQ(static_cast<int>(expected.width), decoded.cols);
+  ASSERT_TRUE(decoded.isContinuous());
+  ASSERT_EQ(expected.data.size(), decoded.total() * decoded.elemSize());
+  EXPECT_EQ(0, std::memcmp(expected.data.data(), decoded.data,
+      expected.data.size()));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, PngColor)
+{
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::RGB_INT8);
+
+  ros_ign_image::CompressionOptions options;
+  options.format = ros_ign_image::CompressionFormat::PNG;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+  EXPECT_EQ("rgb8; png compressed bgr8", compressed.format);
+
+  // OpenCV compresses BGR
+  checkLossless(ign_msg, ros_ign_image::ImageTransform(), compressed, "bgr8");
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, PngUnchanged)
+{
+  // BGR images are compressed straight from the Ignition message
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::BGR_INT8);
+
+  ros_ign_image::CompressionOptions options;
+  options.format = ros_ign_image::CompressionFormat::PNG;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+  EXPECT_EQ("bgr8; png compressed bgr8", compressed.format);
+  checkLossless(ign_msg, ros_ign_image::ImageTransform(), compressed, "bgr8");
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, PngPadded)
+{
+  // Padded rows compressed straight from the Ignition message
+  auto ign_msg = createImage<uint8_t>(4, 3,
+      ignition::msgs::PixelFormatType::BGR_INT8, 4);
+
+  ros_ign_image::CompressionOptions options;
+  options.format = ros_ign_image::CompressionFormat::PNG;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+  checkLossless(ign_msg, ros_ign_image::ImageTransform(), compressed, "bgr8");
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, PngTransformed)
+{
+  auto ign_msg = createImage<uint8_t>(8, 4,
+      ignition::msgs::PixelFormatType::RGBA_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.roi_x = 2;
+  transform.downscale = 2;
+
+  ros_ign_image::CompressionOptions options;
+  options.format = ros_ign_image::CompressionFormat::PNG;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg, transform, options,
+      compressed));
+  EXPECT_EQ("rgba8; png compressed bgr8", compressed.format);
+  checkLossless(ign_msg, transform, compressed, "bgr8");
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, PngDepth)
+{
+  auto ign_msg = createImage<float>(4, 2,
+      ignition::msgs::PixelFormatType::R_FLOAT32);
+
+  ros_ign_image::ImageTransform transform;
+  transform.encoding = "16UC1";
+
+  ros_ign_image::CompressionOptions options;
+  options.format = ros_ign_image::CompressionFormat::PNG;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg, transform, options,
+      compressed));
+  EXPECT_EQ("16UC1; png compressed ", compressed.format);
+  checkLossless(ign_msg, transform, compressed, "16UC1");
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, Jpeg)
+{
+  auto ign_msg = createImage<uint8_t>(16, 8,
+      ignition::msgs::PixelFormatType::L_INT8);
+
+  ros_ign_image::CompressionOptions options;
+  options.jpeg_quality = 95;
+
+  sensor_msgs::CompressedImage compressed;
+  ASSERT_TRUE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+  EXPECT_EQ("mono8; jpeg compressed ", compressed.format);
+
+  auto decoded = cv::imdecode(compressed.data, cv::IMREAD_UNCHANGED);
+  EXPECT_EQ(8, decoded.rows);
+  EXPECT_EQ(16, decoded.cols);
+  EXPECT_EQ(1, decoded.channels());
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, Unsupported)
+{
+  sensor_msgs::CompressedImage compressed;
+  ros_ign_image::CompressionOptions options;
+
+  // JPEG is 8 bit only
+  auto ign_msg = createImage<uint16_t>(4, 2,
+      ignition::msgs::PixelFormatType::L_INT16);
+  EXPECT_FALSE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+
+  // Float depth has no codec
+  options.format = ros_ign_image::CompressionFormat::PNG;
+  ign_msg = createImage<float>(4, 2,
+      ignition::msgs::PixelFormatType::R_FLOAT32);
+  EXPECT_FALSE(ros_ign_image::compress_ign_image(ign_msg,
+      ros_ign_image::ImageTransform(), options, compressed));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageCodecTest, ParseFormat)
+{
+  ros_ign_image::CompressionFormat format;
+  EXPECT_TRUE(ros_ign_image::parse_compression_format("png", format));
+  EXPECT_EQ(ros_ign_image::CompressionFormat::PNG, format);
+  EXPECT_TRUE(ros_ign_image::parse_compression_format("jpeg", format));
+  EXPECT_EQ(ros_ign_image::CompressionFormat::JPEG, format);
+  EXPECT_FALSE(ros_ign_image::parse_compression_format("theora", format));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+#include <ignition/msgs.hh>
+#include <ros_ign_bridge/convert.hpp>
+#include <sensor_msgs/Image.h>
+
+#include "../src/image_ops.hpp"
+
+//////////////////////////////////////////////////
+/// \brief Create an Ignition image whose channels are numbered in order.
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \param[in] _format Pixel format
+/// \return Image
+template<typename T>
+ignition::msgs::Image createImage(uint32_t _width, uint32_t _height,
+    ignition::msgs::PixelFormatType _format)
+{
+  ros_ign_image::PixelFormatInfo info;
+  EXPECT_TRUE(ros_ign_image::pixel_format_info(_format, info));
+
+  std::vector<T> values(_width * _height * info.channels);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = static_cast<T>(i);
+
+  ignition::msgs::Image msg;
+  msg.set_width(_width);
+  msg.set_height(_height);
+  msg.set_pixel_format_type(_format);
+  msg.set_step(_width * info.channels * sizeof(T));
+  msg.set_data(values.data(), values.size() * sizeof(T));
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read channel _index of a ROS image.
+template<typename T>
+T channel(const sensor_msgs::Image &_msg, size_t _index)
+{
+  T value;
+  std::memcpy(&value, _msg.data.data() + _index * sizeof(T), sizeof(T));
+  return value;
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, IdentityMatchesBridge)
+{
+  for (auto format : {ignition::msgs::PixelFormatType::L_INT8,
+                      ignition::msgs::PixelFormatType::RGB_INT8,
+                      ignition::msgs::PixelFormatType::RGBA_INT8})
+  {
+    auto ign_msg = createImage<uint8_t>(6, 4, format);
+
+    sensor_msgs::Image expected;
+    ros_ign_bridge::convert_ign_to_ros(ign_msg, expected);
+
+    sensor_msgs::Image actual;
+    EXPECT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg,
+        ros_ign_image::ImageTransform(), actual));
+
+    EXPECT_EQ(expected.encoding, actual.encoding);
+    EXPECT_EQ(expected.width, actual.width);
+    EXPECT_EQ(expected.height, actual.height);
+    EXPECT_EQ(expected.step, actual.step);
+    EXPECT_EQ(expected.data, actual.data);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, Crop)
+{
+  auto ign_msg = createImage<uint8_t>(6, 4,
+      ignition::msgs::PixelFormatType::RGB_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.roi_x = 1;
+  transform.roi_y = 2;
+  transform.roi_width = 3;
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  EXPECT_EQ(3u, ros_msg.width);
+  EXPECT_EQ(2u, ros_msg.height);
+  EXPECT_EQ(9u, ros_msg.step);
+  ASSERT_EQ(18u, ros_msg.data.size());
+
+  // First pixel of the crop is pixel (1, 2) in the input
+  EXPECT_EQ((2 * 6 + 1) * 3, ros_msg.data[0]);
+  EXPECT_EQ((2 * 6 + 1) * 3 + 2, ros_msg.data[2]);
+
+  // First pixel of second row is pixel (1, 3) in the input
+  EXPECT_EQ((3 * 6 + 1) * 3, ros_msg.data[9]);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, DownscaleNearest)
+{
+  auto ign_msg = createImage<uint8_t>(5, 4,
+      ignition::msgs::PixelFormatType::L_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = 2;
+  transform.filter = ros_ign_image::DownscaleFilter::NEAREST;
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  // Remainder column is dropped
+  EXPECT_EQ(2u, ros_msg.width);
+  EXPECT_EQ(2u, ros_msg.height);
+  ASSERT_EQ(4u, ros_msg.data.size());
+  EXPECT_EQ(0, ros_msg.data[0]);
+  EXPECT_EQ(2, ros_msg.data[1]);
+  EXPECT_EQ(10, ros_msg.data[2]);
+  EXPECT_EQ(12, ros_msg.data[3]);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, DownscaleArea)
+{
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::RGB_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = 2;
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  EXPECT_EQ(2u, ros_msg.width);
+  EXPECT_EQ(1u, ros_msg.height);
+  ASSERT_EQ(6u, ros_msg.data.size());
+
+  // Red of first output pixel averages red of pixels 0, 1, 4 and 5, which
+  // are channels 0, 3, 12 and 15
+  EXPECT_EQ((0 + 3 + 12 + 15 + 2) / 4, ros_msg.data[0]);
+  EXPECT_EQ((1 + 4 + 13 + 16 + 2) / 4, ros_msg.data[1]);
+  EXPECT_EQ((6 + 9 + 18 + 21 + 2) / 4, ros_msg.data[3]);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, DownscaleAreaFloat)
+{
+  auto ign_msg = createImage<float>(4, 4,
+      ignition::msgs::PixelFormatType::R_FLOAT32);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = 2;
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  EXPECT_EQ("32FC1", ros_msg.encoding);
+  EXPECT_EQ(2u, ros_msg.width);
+  EXPECT_EQ(2u, ros_msg.height);
+  EXPECT_EQ(8u, ros_msg.step);
+  EXPECT_FLOAT_EQ((0 + 1 + 4 + 5) / 4.0f, channel<float>(ros_msg, 0));
+  EXPECT_FLOAT_EQ((10 + 11 + 14 + 15) / 4.0f, channel<float>(ros_msg, 3));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, DownscaleAreaOddFactor)
+{
+  auto ign_msg = createImage<uint16_t>(7, 3,
+      ignition::msgs::PixelFormatType::L_INT16);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = 3;
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  EXPECT_EQ("mono16", ros_msg.encoding);
+  EXPECT_EQ(2u, ros_msg.width);
+  EXPECT_EQ(1u, ros_msg.height);
+  EXPECT_EQ(4u, ros_msg.step);
+
+  // Center of each 3x3 block is its average
+  EXPECT_EQ(8, channel<uint16_t>(ros_msg, 0));
+  EXPECT_EQ(11, channel<uint16_t>(ros_msg, 1));
+}
+
+/////////////////////////////////////////////////
+/// \brief Check transcoding a 3 channel image against the bridge's
+/// conversion.
+/// \param[in] _format Input pixel format
+/// \param[in] _encoding Output encoding
+/// \param[in] _swap True if red and blue are swapped
+template<typename T>
+void checkSwizzle(ignition::msgs::PixelFormatType _format,
+    const std::string & _encoding, bool _swap)
+{
+  auto ign_msg = createImage<T>(5, 3, _format);
+
+  sensor_msgs::Image expected;
+  ros_ign_bridge::convert_ign_to_ros(ign_msg, expected);
+  const size_t in_channels = expected.step / (expected.width * sizeof(T));
+
+  ros_ign_image::ImageTransform transform;
+  transform.encoding = _encoding;
+
+  sensor_msgs::Image actual;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, actual));
+
+  EXPECT_EQ(_encoding, actual.encoding);
+  EXPECT_EQ(expected.width, actual.width);
+  EXPECT_EQ(expected.height, actual.height);
+  EXPECT_EQ(expected.width * 3 * sizeof(T), actual.step);
+  ASSERT_EQ(actual.step * actual.height, actual.data.size());
+
+  for (size_t i = 0; i < expected.width * expected.height; ++i)
+  {
+    auto r = channel<T>(expected, i * in_channels + 0);
+    auto g = channel<T>(expected, i * in_channels + 1);
+    auto b = channel<T>(expected, i * in_channels + 2);
+    EXPECT_EQ(_swap ? b : r, channel<T>(actual, i * 3 + 0)) << i;
+    EXPECT_EQ(g, channel<T>(actual, i * 3 + 1)) << i;
+    EXPECT_EQ(_swap ? r : b, channel<T>(actual, i * 3 + 2)) << i;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, TranscodeColor)
+{
+  using ignition::msgs::PixelFormatType;
+  checkSwizzle<uint8_t>(PixelFormatType::RGB_INT8, "bgr8", true);
+  checkSwizzle<uint8_t>(PixelFormatType::BGR_INT8, "rgb8", true);
+  checkSwizzle<uint8_t>(PixelFormatType::RGBA_INT8, "rgb8", false);
+  checkSwizzle<uint8_t>(PixelFormatType::RGBA_INT8, "bgr8", true);
+  checkSwizzle<uint8_t>(PixelFormatType::BGRA_INT8, "bgr8", false);
+  checkSwizzle<uint8_t>(PixelFormatType::BGRA_INT8, "rgb8", true);
+  checkSwizzle<uint16_t>(PixelFormatType::RGB_INT16, "bgr16", true);
+  checkSwizzle<uint16_t>(PixelFormatType::BGR_INT16, "rgb16", true);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, TranscodeDepth)
+{
+  const float depths[] = {0.0f, 0.0004f, 0.0006f, 1.5f, 65.535f, 70.0f,
+      -1.0f, std::numeric_limits<float>::quiet_NaN(),
+      std::numeric_limits<float>::infinity()};
+  const uint16_t millimeters[] = {0, 0, 1, 1500, 65535, 65535, 0, 0, 65535};
+  const uint32_t count = sizeof(depths) / sizeof(depths[0]);
+
+  ignition::msgs::Image ign_msg;
+  ign_msg.set_width(count);
+  ign_msg.set_height(1);
+  ign_msg.set_step(sizeof(depths));
+  ign_msg.set_pixel_format_type(ignition::msgs::PixelFormatType::R_FLOAT32);
+  ign_msg.set_data(depths, sizeof(depths));
+
+  // Input the kernel sees is what the bridge publishes
+  sensor_msgs::Image expected;
+  ros_ign_bridge::convert_ign_to_ros(ign_msg, expected);
+  ASSERT_EQ("32FC1", expected.encoding);
+  ASSERT_EQ(sizeof(depths), expected.data.size());
+  EXPECT_EQ(0, std::memcmp(depths, expected.data.data(), sizeof(depths)));
+
+  ros_ign_image::ImageTransform transform;
+  transform.encoding = "16UC1";
+
+  sensor_msgs::Image actual;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, actual));
+
+  EXPECT_EQ("16UC1", actual.encoding);
+  EXPECT_EQ(count * 2, actual.step);
+  for (uint32_t i = 0; i < count; ++i)
+    EXPECT_EQ(millimeters[i], channel<uint16_t>(actual, i)) << i;
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, TranscodeDownscaled)
+{
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::RGBA_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.downscale = 2;
+  transform.filter = ros_ign_image::DownscaleFilter::NEAREST;
+  transform.encoding = "bgr8";
+
+  sensor_msgs::Image ros_msg;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  EXPECT_EQ(2u, ros_msg.width);
+  EXPECT_EQ(1u, ros_msg.height);
+  EXPECT_EQ(6u, ros_msg.step);
+  ASSERT_EQ(6u, ros_msg.data.size());
+
+  // Pixels 0 and 2 of the input, swizzled
+  EXPECT_EQ(2, ros_msg.data[0]);
+  EXPECT_EQ(1, ros_msg.data[1]);
+  EXPECT_EQ(0, ros_msg.data[2]);
+  EXPECT_EQ(10, ros_msg.data[3]);
+  EXPECT_EQ(9, ros_msg.data[4]);
+  EXPECT_EQ(8, ros_msg.data[5]);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, SameEncoding)
+{
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::RGB_INT8);
+
+  sensor_msgs::Image expected;
+  ros_ign_bridge::convert_ign_to_ros(ign_msg, expected);
+
+  ros_ign_image::ImageTransform transform;
+  transform.encoding = "rgb8";
+
+  sensor_msgs::Image actual;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, actual));
+  EXPECT_EQ(expected.encoding, actual.encoding);
+  EXPECT_EQ(expected.data, actual.data);
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, Buffer)
+{
+  auto ign_msg = createImage<uint8_t>(4, 2,
+      ignition::msgs::PixelFormatType::RGBA_INT8);
+
+  ros_ign_image::ImageTransform transform;
+  transform.roi_width = 3;
+  transform.encoding = "bgr8";
+
+  sensor_msgs::Image expected;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, expected));
+
+  ros_ign_image::ImageLayout layout;
+  ASSERT_TRUE(ros_ign_image::output_layout(ign_msg, transform, layout));
+  EXPECT_EQ(expected.encoding, layout.encoding);
+  EXPECT_EQ(expected.width, layout.width);
+  EXPECT_EQ(expected.height, layout.height);
+  EXPECT_EQ(expected.step, layout.step);
+
+  std::vector<uint8_t> buffer(layout.step * layout.height + 7, 0xff);
+  ros_ign_image::ImageLayout written;
+  ASSERT_TRUE(ros_ign_image::convert_ign_to_buffer(ign_msg, transform,
+      buffer.data(), buffer.size(), written));
+  EXPECT_EQ(layout.step, written.step);
+  EXPECT_EQ(0, std::memcmp(expected.data.data(), buffer.data(),
+      expected.data.size()));
+
+  // Bytes past the image are untouched
+  EXPECT_EQ(0xff, buffer.back());
+
+  // Buffer too small for the image
+  EXPECT_FALSE(ros_ign_image::convert_ign_to_buffer(ign_msg, transform,
+      buffer.data(), expected.data.size() - 1, written));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, SupportsEncoding)
+{
+  EXPECT_TRUE(ros_ign_image::supports_encoding("bgr8"));
+  EXPECT_TRUE(ros_ign_image::supports_encoding("rgb16"));
+  EXPECT_TRUE(ros_ign_image::supports_encoding("16UC1"));
+  EXPECT_FALSE(ros_ign_image::supports_encoding("rgba8"));
+  EXPECT_FALSE(ros_ign_image::supports_encoding("jpeg"));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageOpsTest, Invalid)
+{
+  auto ign_msg = createImage<uint8_t>(4, 4,
+      ignition::msgs::PixelFormatType::L_INT8);
+
+  // Region of interest outside of the image
+  ros_ign_image::ImageTransform transform;
+  transform.roi_x = 10;
+
+  sensor_msgs::Image ros_msg;
+  EXPECT_FALSE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  // Downscaled to nothing
+  transform = ros_ign_image::ImageTransform();
+  transform.downscale = 8;
+  EXPECT_FALSE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  // Unsupported transcoding
+  transform = ros_ign_image::ImageTransform();
+  transform.encoding = "16UC1";
+  EXPECT_FALSE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+
+  // Data shorter than the image
+  transform = ros_ign_image::ImageTransform();
+  ign_msg.set_height(5);
+  EXPECT_FALSE(ros_ign_image::convert_ign_to_ros(ign_msg, transform, ros_msg));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+
+#include "ros_ign_image/shm_ring.hpp"
+
+//////////////////////////////////////////////////
+/// \brief Shared memory name unique to this process.
+std::string ringName()
+{
+  return "/ros_ign_image_test_" + std::to_string(getpid());
+}
+
+/////////////////////////////////////////////////
+TEST(ShmRingTest, WriteAndRead)
+{
+  auto writer = ros_ign_image::ShmRing::Create(ringName(), 3, 100);
+  ASSERT_NE(nullptr, writer);
+  EXPECT_EQ(3u, writer->SlotCount());
+  EXPECT_GE(writer->SlotSize(), 100u);
+
+  auto reader = ros_ign_image::ShmRing::Open(ringName());
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(3u, reader->SlotCount());
+  EXPECT_EQ(writer->SlotSize(), reader->SlotSize());
+
+  // Readers can't write
+  uint32_t slot;
+  EXPECT_EQ(nullptr, reader->BeginWrite(slot));
+
+  auto data = writer->BeginWrite(slot);
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ(0u, slot);
+  std::strcpy(reinterpret_cast<char *>(data), "first");
+  auto sequence = writer->EndWrite(slot);
+
+  EXPECT_STREQ("first", reinterpret_cast<const char *>(reader->Data(slot)));
+  EXPECT_TRUE(reader->IsValid(slot, sequence));
+
+  // Out of range
+  EXPECT_EQ(nullptr, reader->Data(3));
+  EXPECT_FALSE(reader->IsValid(3, sequence));
+}
+
+/////////////////////////////////////////////////
+TEST(ShmRingTest, Overwrite)
+{
+  auto writer = ros_ign_image::ShmRing::Create(ringName(), 2, 16);
+  ASSERT_NE(nullptr, writer);
+  auto reader = ros_ign_image::ShmRing::Open(ringName());
+  ASSERT_NE(nullptr, reader);
+
+  uint32_t first_slot;
+  writer->BeginWrite(first_slot);
+  auto first_sequence = writer->EndWrite(first_slot);
+  EXPECT_TRUE(reader->IsValid(first_slot, first_sequence));
+
+  // Second frame goes to the other slot
+  uint32_t slot;
+  writer->BeginWrite(slot);
+  EXPECT_NE(first_slot, slot);
+  writer->EndWrite(slot);
+  EXPECT_TRUE(reader->IsValid(first_slot, first_sequence));
+
+  // Third frame reuses the first slot, which is invalid while being written
+  // and after
+  writer->BeginWrite(slot);
+  EXPECT_EQ(first_slot, slot);
+  EXPECT_FALSE(reader->IsValid(first_slot, first_sequence));
+  auto sequence = writer->EndWrite(slot);
+  EXPECT_FALSE(reader->IsValid(first_slot, first_sequence));
+  EXPECT_TRUE(reader->IsValid(slot, sequence));
+}
+
+/////////////////////////////////////////////////
+TEST(ShmRingTest, Lifetime)
+{
+  // Writer removes the ring on destruction
+  {
+    auto writer = ros_ign_image::ShmRing::Create(ringName(), 2, 16);
+    ASSERT_NE(nullptr, writer);
+  }
+  EXPECT_EQ(nullptr, ros_ign_image::ShmRing::Open(ringName()));
+
+  // Creating replaces an existing ring
+  auto first = ros_ign_image::ShmRing::Create(ringName(), 2, 16);
+  ASSERT_NE(nullptr, first);
+  auto second = ros_ign_image::ShmRing::Create(ringName(), 4, 16);
+  ASSERT_NE(nullptr, second);
+  auto reader = ros_ign_image::ShmRing::Open(ringName());
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(4u, reader->SlotCount());
+
+  // Invalid sizes
+  EXPECT_EQ(nullptr, ros_ign_image::ShmRing::Create(ringName(), 1, 16));
+  EXPECT_EQ(nullptr, ros_ign_image::ShmRing::Create(ringName(), 2, 0));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
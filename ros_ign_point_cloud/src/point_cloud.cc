@@ -13,6 +13,12 @@
 // limitations under the License.
 
 #include "point_cloud.hh"
+#include "projection.hh"
+
+#include <cstring>
+#include <limits>
+#include <mutex>
+
 #include <ignition/common/Event.hh>
 #include <ignition/gazebo/components/Name.hh>
 #include <ignition/gazebo/components/DepthCamera.hh>
@@ -27,11 +33,13 @@
 #include <ignition/rendering/RenderingIface.hh>
 #include <ignition/rendering/Scene.hh>
 
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <ros/ros.h>
 #include <ros/advertise_options.h>
+#include <ros_ign_bridge/trace.hpp>
 #include <sensor_msgs/Image.h>
-#include <sensor_msgs/fill_image.h>
-#include <sensor_msgs/point_cloud2_iterator.h>
+#include <sensor_msgs/image_encodings.h>
+#include <sensor_msgs/LaserScan.h>
 
 IGNITION_ADD_PLUGIN(
     ros_ign_point_cloud::PointCloud,
@@ -68,6 +76,45 @@ class ros_ign_point_cloud::PointCloudPrivate
             unsigned int _channels,
             const std::string &_format);
 
+  /// \brief Project a frame into a point cloud and publish it.
+  /// \param[in] _scan Depth image or GPU rays data
+  /// \param[in] _width Image width in pixels
+  /// \param[in] _height Image height in pixels
+  /// \param[in] _channels Number of channels in image.
+  /// \param[in] _all_valid True if all readings are within range.
+  /// \param[in] _header Header for the message.
+  public: void PublishPointCloud(const float *_scan,
+            unsigned int _width, unsigned int _height,
+            unsigned int _channels, bool _all_valid,
+            const std_msgs::Header &_header);
+
+  /// \brief Publish the middle row of a GPU rays frame as a laser scan.
+  /// \param[in] _scan GPU rays data
+  /// \param[in] _width Number of horizontal rays
+  /// \param[in] _height Number of vertical rays
+  /// \param[in] _channels Number of channels per ray.
+  /// \param[in] _header Header for the message.
+  public: void PublishLaserScan(const float *_scan,
+            unsigned int _width, unsigned int _height,
+            unsigned int _channels,
+            const std_msgs::Header &_header);
+
+  /// \brief Publish the first channel of a frame as a 32FC1 depth image.
+  /// \param[in] _scan Depth image or GPU rays data
+  /// \param[in] _width Image width in pixels
+  /// \param[in] _height Image height in pixels
+  /// \param[in] _channels Number of channels in image.
+  /// \param[in] _header Header for the message.
+  public: void PublishDepthImage(const float *_scan,
+            unsigned int _width, unsigned int _height,
+            unsigned int _channels,
+            const std_msgs::Header &_header);
+
+  /// \brief Fill diagnostics with range statistics.
+  /// \param[out] _status Diagnostic status to fill.
+  public: void ProduceDiagnostics(
+              diagnostic_updater::DiagnosticStatusWrapper &_status);
+
   /// \brief Get depth camera from rendering.
   /// \param[in] _ecm Immutable reference to ECM.
   public: void LoadDepthCamera(const ignition::gazebo::EntityComponentManager &_ecm);
@@ -95,12 +142,10 @@ class ros_ign_point_cloud::PointCloudPrivate
   /// \brief Rendering GPU lidar
   public: std::shared_ptr<ignition::rendering::GpuRays> gpu_rays_;
 
-  /// \brief Keep latest image from RGB camera.
+  /// \brief Keep latest image from RGB camera. Point colours are read
+  /// straight from its buffer.
   public: ignition::rendering::Image rgb_image_;
 
-  /// \brief Message populated with latest image from RGB camera.
-  public: sensor_msgs::Image rgb_image_msg_;
-
   /// \brief Connection to depth frame event.
   public: ignition::common::ConnectionPtr depth_connection_;
 
@@ -113,6 +158,12 @@ class ros_ign_point_cloud::PointCloudPrivate
   /// \brief Point cloud ROS publisher.
   public: ros::Publisher pc_pub_;
 
+  /// \brief Laser scan ROS publisher, only for GPU lidars.
+  public: ros::Publisher scan_pub_;
+
+  /// \brief Depth image ROS publisher.
+  public: ros::Publisher depth_image_pub_;
+
   /// \brief Current simulation time.
   public: std::chrono::steady_clock::duration current_time_;
 
@@ -127,6 +178,34 @@ class ros_ign_point_cloud::PointCloudPrivate
 
   /// \brief Type of sensor which this plugin is attached to.
   public: SensorType type_;
+
+  /// \brief Projects frames into point clouds.
+  public: PointCloudProjector projector_;
+
+  /// \brief Minimum valid range of the current frame.
+  public: float range_min_{0.0f};
+
+  /// \brief Maximum valid range of the current frame.
+  public: float range_max_{std::numeric_limits<float>::infinity()};
+
+  /// \brief Publishes range statistics as diagnostics.
+  public: std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
+
+  /// \brief Protects the statistics below, which are written from the
+  /// rendering thread and read from the simulation thread.
+  public: std::mutex stats_mutex_;
+
+  /// \brief Invalid readings in the latest frame.
+  public: RangeStats last_stats_;
+
+  /// \brief Invalid readings since startup.
+  public: RangeStats total_stats_;
+
+  /// \brief Number of readings in the latest frame.
+  public: uint64_t last_reading_count_{0};
+
+  /// \brief Number of frames processed since startup.
+  public: uint64_t frame_count_{0};
 };
 
 //////////////////////////////////////////////////
@@ -181,9 +260,90 @@ void PointCloud::Configure(const ignition::gazebo::Entity &_entity,
   auto topic = _sdf->Get<std::string>("topic", "points").first;
   this->dataPtr->pc_pub_ = this->dataPtr->rosnode_->advertise<sensor_msgs::PointCloud2>(topic, 1);
 
+  // Other outputs derived from the same frame, only computed when subscribed
+  if (this->dataPtr->type_ == SensorType::GPU_LIDAR)
+  {
+    auto scan_topic = _sdf->Get<std::string>("scan_topic", "scan").first;
+    this->dataPtr->scan_pub_ =
+        this->dataPtr->rosnode_->advertise<sensor_msgs::LaserScan>(scan_topic, 1);
+  }
+  auto depth_image_topic =
+      _sdf->Get<std::string>("depth_image_topic", "depth_image").first;
+  this->dataPtr->depth_image_pub_ =
+      this->dataPtr->rosnode_->advertise<sensor_msgs::Image>(depth_image_topic, 1);
+
   // TF frame ID
   this->dataPtr->frame_id_ = _sdf->Get<std::string>("frame_id", scoped_name).first;
 
+  ProjectionOptions options;
+
+  // Point fields, lidars have no colour but provide intensity
+  auto default_fields =
+      this->dataPtr->type_ == SensorType::GPU_LIDAR ? "xyzi" : "xyzrgb";
+  auto fields = _sdf->Get<std::string>("fields", default_fields).first;
+  if (fields == "xyz")
+  {
+    options.fields = PointFields::XYZ;
+  }
+  else if (fields == "xyzi")
+  {
+    options.fields = PointFields::XYZI;
+  }
+  else if (fields == "xyzrgb")
+  {
+    options.fields = PointFields::XYZRGB;
+  }
+  else
+  {
+    ROS_ERROR_NAMED("ros_ign_point_cloud",
+        "Unknown <fields> [%s], expected [xyz], [xyzi] or [xyzrgb]. Using [%s].",
+        fields.c_str(), default_fields);
+    options.fields = this->dataPtr->type_ == SensorType::GPU_LIDAR ?
+        PointFields::XYZI : PointFields::XYZRGB;
+  }
+
+  // Unorganized cloud without invalid points
+  options.dense = _sdf->Get<bool>("dense", false).first;
+
+  // Downsampling
+  auto stride = _sdf->Get<int>("stride", 1).first;
+  if (stride < 1)
+  {
+    ROS_ERROR_NAMED("ros_ign_point_cloud",
+        "<stride> must be at least 1, got [%i]. Using 1.", stride);
+    stride = 1;
+  }
+  options.stride = stride;
+
+  options.voxel_size = _sdf->Get<double>("voxel_size", 0.0).first;
+  if (options.voxel_size < 0.0)
+  {
+    ROS_ERROR_NAMED("ros_ign_point_cloud",
+        "<voxel_size> can't be negative, got [%f]. Disabling voxel filter.",
+        options.voxel_size);
+    options.voxel_size = 0.0;
+  }
+
+  auto voxel_mode = _sdf->Get<std::string>("voxel_mode", "centroid").first;
+  if (voxel_mode == "first")
+  {
+    options.voxel_mode = VoxelMode::FIRST;
+  }
+  else if (voxel_mode != "centroid")
+  {
+    ROS_ERROR_NAMED("ros_ign_point_cloud",
+        "Unknown <voxel_mode> [%s], expected [centroid] or [first]. Using [centroid].",
+        voxel_mode.c_str());
+  }
+  this->dataPtr->projector_.SetOptions(options);
+
+  // Diagnostics
+  this->dataPtr->diagnostics_ =
+      std::make_unique<diagnostic_updater::Updater>(*this->dataPtr->rosnode_);
+  this->dataPtr->diagnostics_->setHardwareID(scoped_name);
+  this->dataPtr->diagnostics_->add("Range readings", this->dataPtr.get(),
+      &PointCloudPrivate::ProduceDiagnostics);
+
   // Rendering engine and scene
   this->dataPtr->engine_name_ = _sdf->Get<std::string>("engine", "ogre2").first;
   this->dataPtr->scene_name_ = _sdf->Get<std::string>("scene", "scene").first;
@@ -195,6 +355,10 @@ void PointCloud::PostUpdate(const ignition::gazebo::UpdateInfo &_info,
 {
   this->dataPtr->current_time_ = _info.simTime;
 
+  // Rate limited internally
+  if (this->dataPtr->diagnostics_)
+    this->dataPtr->diagnostics_->update();
+
   // Find engine / scene
   if (!this->dataPtr->scene_)
   {
@@ -325,8 +489,17 @@ void PointCloudPrivate::OnNewDepthFrame(const float *_scan,
                     unsigned int _channels,
                     const std::string &_format)
 {
-  if (this->pc_pub_.getNumSubscribers() <= 0 || _height == 0 || _width == 0)
+  ROS_IGN_TRACE_INSTANT("receive", this->frame_id_);
+
+  bool publish_cloud = this->pc_pub_.getNumSubscribers() > 0;
+  bool publish_scan = this->scan_pub_ && this->scan_pub_.getNumSubscribers() > 0;
+  bool publish_depth_image = this->depth_image_pub_.getNumSubscribers() > 0;
+
+  if ((!publish_cloud && !publish_scan && !publish_depth_image) ||
+      _height == 0 || _width == 0)
+  {
     return;
+  }
 
   // Just sanity check, but don't prevent publishing
   if (this->type_ == SensorType::RGBD_CAMERA && _channels != 1)
@@ -351,149 +524,212 @@ void PointCloudPrivate::OnNewDepthFrame(const float *_scan,
         "Expected GPU rays to have [PF_FLOAT32_RGB] format, but it has [%s]", _format.c_str());
   }
 
-  // Fill message
-  // Logic borrowed from
-  // https://github.com/ros-simulation/gazebo_ros_pkgs/blob/kinetic-devel/gazebo_plugins/src/gazebo_ros_depth_camera.cpp
+  // Valid range of the sensor
+  if (nullptr != this->depth_camera_)
+  {
+    this->range_min_ = this->depth_camera_->NearClipPlane();
+    this->range_max_ = this->depth_camera_->FarClipPlane();
+  }
+  else if (nullptr != this->gpu_rays_)
+  {
+    this->range_min_ = this->gpu_rays_->NearClipPlane();
+    this->range_max_ = this->gpu_rays_->FarClipPlane();
+  }
+
+  // Classify all readings up front, so is_dense and the diagnostics don't
+  // need to be tracked per point
+  auto reading_count = static_cast<size_t>(_width) * _height;
+  auto stats = ClassifyRanges(_scan, reading_count, _channels,
+      this->range_min_, this->range_max_);
+  {
+    std::lock_guard<std::mutex> lock(this->stats_mutex_);
+    this->last_stats_ = stats;
+    this->total_stats_.near += stats.near;
+    this->total_stats_.far += stats.far;
+    this->total_stats_.nan += stats.nan;
+    this->last_reading_count_ = reading_count;
+    ++this->frame_count_;
+  }
+  bool all_valid = stats.near + stats.far + stats.nan == 0;
+
   auto sec_nsec = ignition::math::durationToSecNsec(this->current_time_);
 
+  std_msgs::Header header;
+  header.frame_id = this->frame_id_;
+  header.stamp.sec = sec_nsec.first;
+  header.stamp.nsec = sec_nsec.second;
+
+  if (publish_cloud)
+    this->PublishPointCloud(_scan, _width, _height, _channels, all_valid, header);
+
+  if (publish_scan)
+    this->PublishLaserScan(_scan, _width, _height, _channels, header);
+
+  if (publish_depth_image)
+    this->PublishDepthImage(_scan, _width, _height, _channels, header);
+}
+
+//////////////////////////////////////////////////
+void PointCloudPrivate::PublishPointCloud(const float *_scan,
+                    unsigned int _width, unsigned int _height,
+                    unsigned int _channels, bool _all_valid,
+                    const std_msgs::Header &_header)
+{
+  ROS_IGN_TRACE_BEGIN("convert", this->pc_pub_.getTopic());
+
   sensor_msgs::PointCloud2 msg;
-  msg.header.frame_id = this->frame_id_;
-  msg.header.stamp.sec = sec_nsec.first;
-  msg.header.stamp.nsec = sec_nsec.second;
-  msg.width = _width;
-  msg.height = _height;
-  msg.row_step = msg.point_step * _width;
-  msg.is_dense = true;
+  msg.header = _header;
 
-  sensor_msgs::PointCloud2Modifier modifier(msg);
-  modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
-  modifier.resize(_width*_height);
+  DepthFrame frame;
+  frame.data = _scan;
+  frame.width = _width;
+  frame.height = _height;
+  frame.channels = _channels;
+  frame.range_min = this->range_min_;
+  frame.range_max = this->range_max_;
+  frame.all_valid = _all_valid;
 
-  sensor_msgs::PointCloud2Iterator<float> iter_x(msg, "x");
-  sensor_msgs::PointCloud2Iterator<float> iter_y(msg, "y");
-  sensor_msgs::PointCloud2Iterator<float> iter_z(msg, "z");
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_r(msg, "r");
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_g(msg, "g");
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_b(msg, "b");
+  if (nullptr != this->depth_camera_)
+  {
+    // The RGB image is read in place, there's no intermediate copy into a
+    // ROS image.
+    const uint8_t *color{nullptr};
+    size_t color_size{0};
+    if (nullptr != this->rgb_camera_ &&
+        this->projector_.Options().fields == PointFields::XYZRGB)
+    {
+      this->rgb_camera_->Capture(this->rgb_image_);
+      color = this->rgb_image_.Data<unsigned char>();
+      color_size = this->rgb_image_.MemorySize();
+    }
 
-  if (this->rgb_camera_)
+    auto intrinsics = CameraIntrinsics::FromHfov(
+        this->depth_camera_->HFOV().Radian(), _width);
+    this->projector_.ProjectDepthImage(frame, intrinsics, color, color_size,
+        msg);
+  }
+  else if (nullptr != this->gpu_rays_)
   {
-    this->rgb_camera_->Capture(this->rgb_image_);
-    fillImage(this->rgb_image_msg_, sensor_msgs::image_encodings::RGB8, _height,
-        _width, 3 * _width, this->rgb_image_.Data<unsigned char>());
+    LidarAngles angles;
+    angles.angle_min = this->gpu_rays_->AngleMin().Radian();
+    angles.angle_max = this->gpu_rays_->AngleMax().Radian();
+    angles.range_count = this->gpu_rays_->RangeCount();
+    angles.vertical_angle_min = this->gpu_rays_->VerticalAngleMin().Radian();
+    angles.vertical_angle_max = this->gpu_rays_->VerticalAngleMax().Radian();
+    angles.vertical_range_count = this->gpu_rays_->VerticalRangeCount();
+    this->projector_.ProjectGpuRays(frame, angles, msg);
   }
+  ROS_IGN_TRACE_END("convert");
 
-  // For depth calculation from image
-  double fl{0.0};
-  if (nullptr != this->depth_camera_)
+  ROS_IGN_TRACE_SCOPE("publish", this->pc_pub_.getTopic());
+  this->pc_pub_.publish(msg);
+}
+
+//////////////////////////////////////////////////
+void PointCloudPrivate::PublishLaserScan(const float *_scan,
+                    unsigned int _width, unsigned int _height,
+                    unsigned int _channels,
+                    const std_msgs::Header &_header)
+{
+  if (nullptr == this->gpu_rays_)
+    return;
+
+  ROS_IGN_TRACE_BEGIN("convert", this->scan_pub_.getTopic());
+
+  sensor_msgs::LaserScan msg;
+  msg.header = _header;
+  msg.angle_min = this->gpu_rays_->AngleMin().Radian();
+  msg.angle_max = this->gpu_rays_->AngleMax().Radian();
+  msg.angle_increment = _width > 1 ?
+      (msg.angle_max - msg.angle_min) / (_width - 1) : 0.0;
+  msg.range_min = this->range_min_;
+  msg.range_max = this->range_max_;
+
+  // Not available from rendering.
+  msg.time_increment = 0.0;
+  msg.scan_time = 0.0;
+
+  // If there are multiple vertical beams, use the one in the middle, same as
+  // the ros_ign_bridge conversion.
+  const float *row = _scan + (_height / 2) * _width * _channels;
+
+  msg.ranges.resize(_width);
+  msg.intensities.resize(_channels > 1 ? _width : 0);
+  for (unsigned int i = 0; i < _width; ++i)
   {
-    auto hfov = this->depth_camera_->HFOV().Radian();
-    fl = _width / (2.0 * tan(hfov / 2.0));
+    msg.ranges[i] = Rep117(row[i * _channels], msg.range_min, msg.range_max);
+    if (_channels > 1)
+      msg.intensities[i] = row[i * _channels + 1];
   }
+  ROS_IGN_TRACE_END("convert");
 
-  // For depth calculation from laser scan
-  double angle_step{0.0};
-  double vertical_angle_step{0.0};
-  double inclination{0.0};
-  double azimuth{0.0};
-  if (nullptr != this->gpu_rays_)
-  {
-    angle_step = (this->gpu_rays_->AngleMax() - this->gpu_rays_->AngleMin()).Radian() /
-        (this->gpu_rays_->RangeCount()-1);
-    vertical_angle_step = (this->gpu_rays_->VerticalAngleMax() -
-        this->gpu_rays_->VerticalAngleMin()).Radian() / (this->gpu_rays_->VerticalRangeCount()-1);
+  ROS_IGN_TRACE_SCOPE("publish", this->scan_pub_.getTopic());
+  this->scan_pub_.publish(msg);
+}
 
-    // Angles of ray currently processing, azimuth is horizontal, inclination is vertical
-    inclination = this->gpu_rays_->VerticalAngleMin().Radian();
-    azimuth = this->gpu_rays_->AngleMin().Radian();
-  }
+//////////////////////////////////////////////////
+void PointCloudPrivate::PublishDepthImage(const float *_scan,
+                    unsigned int _width, unsigned int _height,
+                    unsigned int _channels,
+                    const std_msgs::Header &_header)
+{
+  ROS_IGN_TRACE_BEGIN("convert", this->depth_image_pub_.getTopic());
 
-  // For color calculation
-  uint8_t * image_src;
-  if (nullptr != this->rgb_camera_)
+  sensor_msgs::Image msg;
+  msg.header = _header;
+  msg.width = _width;
+  msg.height = _height;
+  msg.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+  msg.is_bigendian = false;
+  msg.step = _width * sizeof(float);
+  msg.data.resize(msg.step * _height);
+
+  if (_channels == 1)
   {
-    image_src = (uint8_t *)(&(this->rgb_image_msg_.data[0]));
+    std::memcpy(msg.data.data(), _scan, msg.data.size());
   }
-
-  // Iterate over scan and populate point cloud
-  for (uint32_t j = 0; j < _height; ++j)
+  else
   {
-    double p_angle{0.0};
-    if (fl > 0 && _height > 1)
-      p_angle = atan2((double)j - 0.5 * (double)(_height-1), fl);
-
-    if (nullptr != this->gpu_rays_)
-    {
-      azimuth = this->gpu_rays_->AngleMin().Radian();
-    }
-    for (uint32_t i = 0; i < _width; ++i, ++iter_x, ++iter_y, ++iter_z, ++iter_r, ++iter_g, ++iter_b)
-    {
-      // Index of current point
-      auto index = j * _width * _channels + i * _channels;
-      double depth = _scan[index];
-
-      double y_angle{0.0};
-      if (fl > 0 && _width > 1)
-        y_angle = atan2((double)i - 0.5 * (double)(_width-1), fl);
-
-      if (nullptr != this->depth_camera_)
-      {
-        // in optical frame
-        // hardcoded rotation rpy(-M_PI/2, 0, -M_PI/2) is built-in
-        // to urdf, where the *_optical_frame should have above relative
-        // rotation from the physical camera *_frame
-        *iter_x = depth * tan(y_angle);
-        *iter_y = depth * tan(p_angle);
-        *iter_z = depth;
-
-        // Clamp according to REP 117
-        if (depth > this->depth_camera_->FarClipPlane())
-        {
-          *iter_z = ignition::math::INF_D;
-          msg.is_dense = false;
-        }
-        if (depth < this->depth_camera_->NearClipPlane())
-        {
-          *iter_z = -ignition::math::INF_D;
-          msg.is_dense = false;
-        }
-      }
-      else if (nullptr != this->gpu_rays_)
-      {
-        // Convert spherical coordinates to Cartesian for pointcloud
-        // See https://en.wikipedia.org/wiki/Spherical_coordinate_system
-        *iter_x = depth * cos(inclination) * cos(azimuth);
-        *iter_y = depth * cos(inclination) * sin(azimuth);
-        *iter_z = depth * sin(inclination);
-      }
-
-      // Put image color data for each point
-      if (this->rgb_image_msg_.data.size() == _height * _width * 3)
-      {
-        // color
-        *iter_r = image_src[i*3+j*_width*3+0];
-        *iter_g = image_src[i*3+j*_width*3+1];
-        *iter_b = image_src[i*3+j*_width*3+2];
-      }
-      else if (this->rgb_image_msg_.data.size() == _height*_width)
-      {
-        // mono?
-        *iter_r = image_src[i+j*_width];
-        *iter_g = image_src[i+j*_width];
-        *iter_b = image_src[i+j*_width];
-      }
-      else
-      {
-        // no image
-        *iter_r = 0;
-        *iter_g = 0;
-        *iter_b = 0;
-      }
-      azimuth += angle_step;
-    }
-    inclination += vertical_angle_step;
+    // Keep range, drop the other channels
+    auto depth = reinterpret_cast<float *>(msg.data.data());
+    for (size_t i = 0; i < static_cast<size_t>(_width) * _height; ++i)
+      depth[i] = _scan[i * _channels];
   }
+  ROS_IGN_TRACE_END("convert");
 
-  this->pc_pub_.publish(msg);
+  ROS_IGN_TRACE_SCOPE("publish", this->depth_image_pub_.getTopic());
+  this->depth_image_pub_.publish(msg);
 }
 
+
+//////////////////////////////////////////////////
+void PointCloudPrivate::ProduceDiagnostics(
+    diagnostic_updater::DiagnosticStatusWrapper &_status)
+{
+  std::lock_guard<std::mutex> lock(this->stats_mutex_);
+
+  if (this->frame_count_ == 0)
+  {
+    _status.summary(diagnostic_msgs::DiagnosticStatus::OK,
+        "No frames processed yet, frames are only processed while subscribed");
+  }
+  else if (this->last_stats_.nan > 0)
+  {
+    _status.summaryf(diagnostic_msgs::DiagnosticStatus::WARN,
+        "Latest frame has [%lu] erroneous readings",
+        static_cast<unsigned long>(this->last_stats_.nan));
+  }
+  else
+  {
+    _status.summary(diagnostic_msgs::DiagnosticStatus::OK, "OK");
+  }
+
+  _status.add("Frames", this->frame_count_);
+  _status.add("Readings in latest frame", this->last_reading_count_);
+  _status.add("Too near in latest frame", this->last_stats_.near);
+  _status.add("Too far in latest frame", this->last_stats_.far);
+  _status.add("NaN in latest frame", this->last_stats_.nan);
+  _status.add("Too near total", this->total_stats_.near);
+  _status.add("Too far total", this->total_stats_.far);
+  _status.add("NaN total", this->total_stats_.nan);
+}
@@ -24,6 +24,12 @@ namespace ros_ign_point_cloud
   class PointCloudPrivate;
 
   /// \brief System which publishes ROS PointCloud2 messages for RGBD or GPU lidar sensors.
+  /// The same frame can also be published as a LaserScan (GPU lidar only) and as a
+  /// 32FC1 depth image. Each output is only computed while it has subscribers.
+  ///
+  /// Out of range readings follow REP 117: -inf when closer than the near clip plane,
+  /// +inf when beyond the far clip plane and NaN when erroneous. Counts of these are
+  /// published on /diagnostics.
   ///
   /// This plugin should be attached to an RGBD or GPU lidar sensor (i.e. <sensor...><plugin>)
   ///
@@ -32,9 +38,20 @@ namespace ros_ign_point_cloud
   /// SDF parameters:
   /// * `<namespace>`: Namespace for ROS node, defaults to sensor scoped name
   /// * `<topic>`: ROS topic to publish to, defaults to "points"
+  /// * `<scan_topic>`: ROS topic for laser scans from GPU lidars, defaults to "scan"
+  /// * `<depth_image_topic>`: ROS topic for depth images, defaults to "depth_image"
   /// * `<frame_id>`: TF frame name to populate message header, defaults to sensor scoped name
   /// * `<engine>`: Render engine name, defaults to 'ogre2'
   /// * `<scene>`: Scene name, defaults to 'scene'
+  /// * `<fields>`: Fields for each point, one of 'xyz', 'xyzi' or 'xyzrgb'. Defaults to
+  ///               'xyzi' for GPU lidars and 'xyzrgb' for cameras.
+  /// * `<dense>`: True to drop invalid points and publish an unorganized (1 x N) cloud,
+  ///              defaults to false, which keeps the sensor's width x height layout.
+  /// * `<stride>`: Only project every Nth pixel / ray along each axis, defaults to 1.
+  /// * `<voxel_size>`: Edge in meters of a voxel grid filter applied while projecting,
+  ///                   defaults to 0 (disabled). Filtered clouds are unorganized.
+  /// * `<voxel_mode>`: 'centroid' to average the points within a voxel, or 'first' to
+  ///                   keep the first one. Defaults to 'centroid'.
   class PointCloud:
     public ignition::gazebo::System,
     public ignition::gazebo::ISystemConfigure,
@@ -0,0 +1,528 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "projection.hh"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <sensor_msgs/point_cloud2_iterator.h>
+
+using namespace ros_ign_point_cloud;
+
+/// \brief Where each point's colour comes from. Resolved once per frame so
+/// the per-point loop doesn't need to branch on it.
+enum class ColorSource {
+  /// \brief No colour image, points are black
+  NONE,
+
+  /// \brief Single channel image, each byte used for R, G and B
+  MONO,
+
+  /// \brief 3 channel RGB image
+  RGB
+};
+
+//////////////////////////////////////////////////
+/// \brief Copy the colour of pixel _index from _src into a point's packed
+/// `rgb` field, which is laid out as B, G, R in little endian.
+/// \param[in] _src Start of image data, may be null for NONE.
+/// \param[in] _index Index of pixel within image.
+/// \param[out] _rgb First byte of the point's `rgb` field.
+template<ColorSource C>
+inline void CopyColor(const uint8_t *_src, size_t _index, uint8_t *_rgb);
+
+template<>
+inline void CopyColor<ColorSource::NONE>(const uint8_t *, size_t,
+    uint8_t *_rgb)
+{
+  _rgb[0] = 0;
+  _rgb[1] = 0;
+  _rgb[2] = 0;
+}
+
+template<>
+inline void CopyColor<ColorSource::MONO>(const uint8_t *_src, size_t _index,
+    uint8_t *_rgb)
+{
+  _rgb[0] = _src[_index];
+  _rgb[1] = _src[_index];
+  _rgb[2] = _src[_index];
+}
+
+template<>
+inline void CopyColor<ColorSource::RGB>(const uint8_t *_src, size_t _index,
+    uint8_t *_rgb)
+{
+  _rgb[0] = _src[_index * 3 + 2];
+  _rgb[1] = _src[_index * 3 + 1];
+  _rgb[2] = _src[_index * 3 + 0];
+}
+
+/// \brief A projected point before it's written into the message.
+struct Point
+{
+  /// \brief Position
+  float xyz[3];
+
+  /// \brief Intensity, only used by PointFields::XYZI
+  float intensity;
+
+  /// \brief Colour, only used by PointFields::XYZRGB
+  uint8_t rgb[3];
+};
+
+/// \brief Running sums of all points which fell into one voxel.
+struct VoxelAccumulator
+{
+  /// \brief Sum of positions
+  double xyz[3];
+
+  /// \brief Sum of intensities
+  double intensity;
+
+  /// \brief Sum of colours
+  uint32_t rgb[3];
+
+  /// \brief Number of points accumulated
+  uint32_t count;
+};
+
+//////////////////////////////////////////////////
+/// \brief Write a projected point into the message buffer.
+/// \param[in] _point Point to write.
+/// \param[in] _extra_offset Offset of the intensity or rgb field.
+/// \param[out] _dst First byte of the point in the message.
+template<PointFields F>
+inline void WritePoint(const Point &_point, size_t _extra_offset, uint8_t *_dst)
+{
+  std::memcpy(_dst, _point.xyz, sizeof(_point.xyz));
+
+  if constexpr (F == PointFields::XYZI)
+  {
+    std::memcpy(_dst + _extra_offset, &_point.intensity,
+        sizeof(_point.intensity));
+  }
+  else if constexpr (F == PointFields::XYZRGB)
+  {
+    // The field is 4 bytes, the last one is cleared in case the message is
+    // reused
+    const uint8_t rgb[4]{_point.rgb[0], _point.rgb[1], _point.rgb[2], 0};
+    std::memcpy(_dst + _extra_offset, rgb, sizeof(rgb));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Hash key of the voxel containing a point. Each axis index is
+/// wrapped to 21 bits, so voxels ~2^21 cells apart share a key.
+/// \param[in] _xyz Point position.
+/// \param[in] _inv_size 1 / voxel size.
+/// \param[out] _key Voxel key.
+/// \return False if the point is not finite, or too far for its cell index
+/// to fit in 64 bits, such as an infinite depth within the default range.
+inline bool VoxelKey(const float *_xyz, double _inv_size, uint64_t &_key)
+{
+  // Casting to int64_t is undefined beyond its range, 2^63
+  const double kMaxCell = 9.2e18;
+
+  _key = 0;
+  for (int k = 0; k < 3; ++k)
+  {
+    const double cell = std::floor(_xyz[k] * _inv_size);
+
+    // Also false for NaN
+    if (!(std::abs(cell) < kMaxCell))
+      return false;
+    _key = (_key << 21) |
+        (static_cast<uint64_t>(static_cast<int64_t>(cell)) & 0x1FFFFF);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+class ros_ign_point_cloud::PointCloudProjectorPrivate
+{
+  /// \brief Project a frame into the message. Exactly one of _intrinsics
+  /// and _angles is set.
+  /// \param[in] _frame Depth image or GPU rays
+  /// \param[in] _intrinsics Depth camera intrinsics, or null
+  /// \param[in] _angles GPU lidar angles, or null
+  /// \param[in] _color Colour image data, or null
+  /// \param[in] _color_size Size of _color in bytes
+  /// \param[in,out] _msg Cloud to fill
+  /// \return Number of points in the cloud
+  public: size_t Project(const DepthFrame &_frame,
+            const CameraIntrinsics *_intrinsics,
+            const LidarAngles *_angles,
+            const uint8_t *_color, size_t _color_size,
+            sensor_msgs::PointCloud2 &_msg);
+
+  /// \brief Project the frame into the message's points, writing fields F
+  /// and reading colour from an image of kind C.
+  /// \param[in] _frame Depth image or GPU rays
+  /// \param[in] _intrinsics Depth camera intrinsics, or null
+  /// \param[in] _angles GPU lidar angles, or null
+  /// \param[in] _color Colour image data, or null for ColorSource::NONE.
+  /// \param[out] _msg Message already resized to hold one point per sampled
+  /// pixel.
+  /// \return Number of points written. Smaller than the number of sampled
+  /// pixels if `dense` is set or points were merged into voxels.
+  public: template<PointFields F, ColorSource C>
+          size_t FillPoints(const DepthFrame &_frame,
+            const CameraIntrinsics *_intrinsics,
+            const LidarAngles *_angles,
+            const uint8_t *_color,
+            sensor_msgs::PointCloud2 &_msg);
+
+  /// \brief How frames are projected.
+  public: ProjectionOptions options_;
+
+  /// \brief Voxel key to index in the output or in voxels_. Kept across
+  /// frames so its buckets are reused.
+  public: std::unordered_map<uint64_t, uint32_t> voxel_index_;
+
+  /// \brief Accumulated points per voxel, for VoxelMode::CENTROID.
+  public: std::vector<VoxelAccumulator> voxels_;
+};
+
+//////////////////////////////////////////////////
+CameraIntrinsics CameraIntrinsics::FromHfov(double _hfov, unsigned int _width)
+{
+  return CameraIntrinsics{_width / (2.0 * tan(_hfov / 2.0))};
+}
+
+//////////////////////////////////////////////////
+PointCloudProjector::PointCloudProjector()
+  : dataPtr(std::make_unique<PointCloudProjectorPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+PointCloudProjector::~PointCloudProjector() = default;
+
+//////////////////////////////////////////////////
+void PointCloudProjector::SetOptions(const ProjectionOptions &_options)
+{
+  this->dataPtr->options_ = _options;
+  if (this->dataPtr->options_.stride < 1)
+    this->dataPtr->options_.stride = 1;
+}
+
+//////////////////////////////////////////////////
+const ProjectionOptions &PointCloudProjector::Options() const
+{
+  return this->dataPtr->options_;
+}
+
+//////////////////////////////////////////////////
+size_t PointCloudProjector::ProjectDepthImage(const DepthFrame &_frame,
+    const CameraIntrinsics &_intrinsics,
+    const uint8_t *_color, size_t _color_size,
+    sensor_msgs::PointCloud2 &_msg)
+{
+  return this->dataPtr->Project(_frame, &_intrinsics, nullptr,
+      _color, _color_size, _msg);
+}
+
+//////////////////////////////////////////////////
+size_t PointCloudProjector::ProjectGpuRays(const DepthFrame &_frame,
+    const LidarAngles &_angles,
+    sensor_msgs::PointCloud2 &_msg)
+{
+  return this->dataPtr->Project(_frame, nullptr, &_angles, nullptr, 0, _msg);
+}
+
+//////////////////////////////////////////////////
+size_t PointCloudProjectorPrivate::Project(const DepthFrame &_frame,
+    const CameraIntrinsics *_intrinsics,
+    const LidarAngles *_angles,
+    const uint8_t *_color, size_t _color_size,
+    sensor_msgs::PointCloud2 &_msg)
+{
+  // Fill message
+  // Logic borrowed from
+  // https://github.com/ros-simulation/gazebo_ros_pkgs/blob/kinetic-devel/gazebo_plugins/src/gazebo_ros_depth_camera.cpp
+  const auto &options = this->options_;
+  bool unorganized = options.dense || options.voxel_size > 0.0;
+
+  // Invalid points are dropped from unorganized clouds
+  _msg.is_dense = _frame.all_valid || unorganized;
+
+  sensor_msgs::PointCloud2Modifier modifier(_msg);
+  switch (options.fields)
+  {
+    case PointFields::XYZ:
+      modifier.setPointCloud2FieldsByString(1, "xyz");
+      break;
+    case PointFields::XYZI:
+      modifier.setPointCloud2Fields(4,
+          "x", 1, sensor_msgs::PointField::FLOAT32,
+          "y", 1, sensor_msgs::PointField::FLOAT32,
+          "z", 1, sensor_msgs::PointField::FLOAT32,
+          "intensity", 1, sensor_msgs::PointField::FLOAT32);
+      break;
+    default:
+    case PointFields::XYZRGB:
+      modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+      break;
+  }
+
+  // One point per sampled pixel at most
+  auto out_width = (_frame.width + options.stride - 1) / options.stride;
+  auto out_height = (_frame.height + options.stride - 1) / options.stride;
+  modifier.resize(out_width * out_height);
+
+  // Decide where colour comes from once per frame
+  auto color_source = ColorSource::NONE;
+  if (nullptr != _color && options.fields == PointFields::XYZRGB)
+  {
+    auto pixel_count = static_cast<size_t>(_frame.width) * _frame.height;
+    if (_color_size == pixel_count * 3)
+      color_source = ColorSource::RGB;
+    else if (_color_size == pixel_count)
+      color_source = ColorSource::MONO;
+  }
+
+  size_t count{0};
+  switch (options.fields)
+  {
+    case PointFields::XYZ:
+      count = this->FillPoints<PointFields::XYZ, ColorSource::NONE>(
+          _frame, _intrinsics, _angles, nullptr, _msg);
+      break;
+    case PointFields::XYZI:
+      count = this->FillPoints<PointFields::XYZI, ColorSource::NONE>(
+          _frame, _intrinsics, _angles, nullptr, _msg);
+      break;
+    default:
+    case PointFields::XYZRGB:
+      if (color_source == ColorSource::RGB)
+      {
+        count = this->FillPoints<PointFields::XYZRGB, ColorSource::RGB>(
+            _frame, _intrinsics, _angles, _color, _msg);
+      }
+      else if (color_source == ColorSource::MONO)
+      {
+        count = this->FillPoints<PointFields::XYZRGB, ColorSource::MONO>(
+            _frame, _intrinsics, _angles, _color, _msg);
+      }
+      else
+      {
+        count = this->FillPoints<PointFields::XYZRGB, ColorSource::NONE>(
+            _frame, _intrinsics, _angles, nullptr, _msg);
+      }
+      break;
+  }
+
+  if (unorganized)
+  {
+    // Unorganized, 1 x count
+    modifier.resize(count);
+  }
+  else
+  {
+    // Organized, keep image layout
+    _msg.height = out_height;
+    _msg.width = out_width;
+    _msg.row_step = _msg.point_step * out_width;
+  }
+
+  return count;
+}
+
+//////////////////////////////////////////////////
+template<PointFields F, ColorSource C>
+size_t PointCloudProjectorPrivate::FillPoints(const DepthFrame &_frame,
+    const CameraIntrinsics *_intrinsics,
+    const LidarAngles *_angles,
+    const uint8_t *_color,
+    sensor_msgs::PointCloud2 &_msg)
+{
+  const float *scan = _frame.data;
+  const unsigned int width = _frame.width;
+  const unsigned int height = _frame.height;
+  const unsigned int channels = _frame.channels;
+  const unsigned int stride = this->options_.stride;
+
+  // Offset of intensity or colour within each point. Position is always
+  // x, y, z at the start of the point.
+  size_t extra_offset{0};
+  for (const auto &field : _msg.fields)
+  {
+    if (field.name == "intensity" || field.name == "rgb")
+      extra_offset = field.offset;
+  }
+
+  // For depth calculation from image
+  double fl{0.0};
+  if (nullptr != _intrinsics)
+  {
+    fl = _intrinsics->focal_length;
+  }
+
+  // For depth calculation from laser scan
+  double angle_step{0.0};
+  double vertical_angle_step{0.0};
+  double inclination{0.0};
+  double azimuth{0.0};
+  if (nullptr != _angles)
+  {
+    if (_angles->range_count > 1)
+    {
+      angle_step = (_angles->angle_max - _angles->angle_min) /
+          (_angles->range_count - 1);
+    }
+    if (_angles->vertical_range_count > 1)
+    {
+      vertical_angle_step = (_angles->vertical_angle_max -
+          _angles->vertical_angle_min) / (_angles->vertical_range_count - 1);
+    }
+
+    // Angles of ray currently processing, azimuth is horizontal, inclination is vertical
+    inclination = _angles->vertical_angle_min;
+    azimuth = _angles->angle_min;
+  }
+
+  // Voxel filter state, reset every frame
+  bool voxelize = this->options_.voxel_size > 0.0;
+  double inv_voxel_size = voxelize ? 1.0 / this->options_.voxel_size : 0.0;
+  this->voxel_index_.clear();
+  this->voxels_.clear();
+
+  uint8_t *point = _msg.data.data();
+  size_t count{0};
+
+  // Iterate over scan and populate point cloud, skipping stride - 1 pixels
+  // between samples
+  for (uint32_t j = 0; j < height; j += stride,
+      inclination += vertical_angle_step * stride)
+  {
+    double p_angle{0.0};
+    if (fl > 0 && height > 1)
+      p_angle = atan2((double)j - 0.5 * (double)(height-1), fl);
+
+    if (nullptr != _angles)
+    {
+      azimuth = _angles->angle_min;
+    }
+    for (uint32_t i = 0; i < width; i += stride,
+        azimuth += angle_step * stride)
+    {
+      // Index of current point
+      auto index = j * width * channels + i * channels;
+      double depth = scan[index];
+
+      double y_angle{0.0};
+      if (fl > 0 && width > 1)
+        y_angle = atan2((double)i - 0.5 * (double)(width-1), fl);
+
+      Point p{{0.0f, 0.0f, 0.0f}, 0.0f, {0, 0, 0}};
+      if (nullptr != _intrinsics)
+      {
+        // in optical frame
+        // hardcoded rotation rpy(-M_PI/2, 0, -M_PI/2) is built-in
+        // to urdf, where the *_optical_frame should have above relative
+        // rotation from the physical camera *_frame
+        p.xyz[0] = depth * tan(y_angle);
+        p.xyz[1] = depth * tan(p_angle);
+        p.xyz[2] = depth;
+      }
+      else if (nullptr != _angles)
+      {
+        // Convert spherical coordinates to Cartesian for pointcloud
+        // See https://en.wikipedia.org/wiki/Spherical_coordinate_system
+        p.xyz[0] = depth * cos(inclination) * cos(azimuth);
+        p.xyz[1] = depth * cos(inclination) * sin(azimuth);
+        p.xyz[2] = depth * sin(inclination);
+      }
+
+      // Replace out of range points according to REP 117. NaN fails both
+      // comparisons.
+      bool valid = (depth >= _frame.range_min) & (depth <= _frame.range_max);
+      if ((this->options_.dense || voxelize) && !valid)
+        continue;
+
+      float rep117 = Rep117(depth, _frame.range_min, _frame.range_max);
+      for (int k = 0; k < 3; ++k)
+        p.xyz[k] = valid ? p.xyz[k] : rep117;
+
+      if constexpr (F == PointFields::XYZI)
+      {
+        p.intensity = channels > 1 ? scan[index + 1] : 0.0f;
+      }
+      else if constexpr (F == PointFields::XYZRGB)
+      {
+        // Put image color data for each point
+        CopyColor<C>(_color, j * width + i, p.rgb);
+      }
+
+      if (voxelize)
+      {
+        uint64_t key;
+        if (!VoxelKey(p.xyz, inv_voxel_size, key))
+          continue;
+        auto slot = this->voxel_index_.emplace(key,
+            static_cast<uint32_t>(this->voxel_index_.size()));
+
+        if (this->options_.voxel_mode == VoxelMode::FIRST)
+        {
+          // Voxel already has its point
+          if (!slot.second)
+            continue;
+        }
+        else
+        {
+          if (slot.second)
+            this->voxels_.push_back(VoxelAccumulator{{0, 0, 0}, 0, {0, 0, 0}, 0});
+
+          auto &acc = this->voxels_[slot.first->second];
+          for (int k = 0; k < 3; ++k)
+          {
+            acc.xyz[k] += p.xyz[k];
+            acc.rgb[k] += p.rgb[k];
+          }
+          acc.intensity += p.intensity;
+          ++acc.count;
+
+          // Points are written once all of them have been accumulated
+          continue;
+        }
+      }
+
+      WritePoint<F>(p, extra_offset, point);
+      point += _msg.point_step;
+      ++count;
+    }
+  }
+
+  // Write voxel centroids
+  for (const auto &acc : this->voxels_)
+  {
+    Point p;
+    for (int k = 0; k < 3; ++k)
+    {
+      p.xyz[k] = acc.xyz[k] / acc.count;
+      p.rgb[k] = static_cast<uint8_t>(acc.rgb[k] / acc.count);
+    }
+    p.intensity = acc.intensity / acc.count;
+
+    WritePoint<F>(p, extra_offset, point);
+    point += _msg.point_step;
+    ++count;
+  }
+
+  return count;
+}
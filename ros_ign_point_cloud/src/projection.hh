@@ -0,0 +1,234 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROS_IGN_POINTCLOUD__PROJECTION_HPP_
+#define ROS_IGN_POINTCLOUD__PROJECTION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+#include <sensor_msgs/PointCloud2.h>
+
+namespace ros_ign_point_cloud
+{
+  // Forward declarations.
+  class PointCloudProjectorPrivate;
+
+  /// \brief Fields published for each point.
+  enum class PointFields {
+    /// \brief Only position
+    XYZ,
+
+    /// \brief Position and intensity, for GPU lidar
+    XYZI,
+
+    /// \brief Position and packed RGB colour
+    XYZRGB
+  };
+
+  /// \brief How points falling in the same voxel are merged.
+  enum class VoxelMode {
+    /// \brief Average position, intensity and colour of all points
+    CENTROID,
+
+    /// \brief Keep the first point projected into each voxel
+    FIRST
+  };
+
+  /// \brief Counts of readings outside the sensor's valid range, see REP 117.
+  struct RangeStats
+  {
+    /// \brief Readings closer than the minimum range
+    uint64_t near{0};
+
+    /// \brief Readings further than the maximum range
+    uint64_t far{0};
+
+    /// \brief Erroneous readings
+    uint64_t nan{0};
+  };
+
+  /// \brief A frame rendered by a depth camera or GPU rays. The first
+  /// channel of each reading is its range, GPU rays have the intensity on the
+  /// second one.
+  struct DepthFrame
+  {
+    /// \brief Readings, row by row
+    const float *data{nullptr};
+
+    /// \brief Image width in pixels, or number of horizontal rays
+    unsigned int width{0};
+
+    /// \brief Image height in pixels, or number of vertical rays
+    unsigned int height{0};
+
+    /// \brief Number of channels per reading
+    unsigned int channels{1};
+
+    /// \brief Minimum valid range, the near clip plane
+    float range_min{0.0f};
+
+    /// \brief Maximum valid range, the far clip plane
+    float range_max{std::numeric_limits<float>::infinity()};
+
+    /// \brief True if all readings are within range, see ClassifyRanges.
+    /// Only used to set the cloud's is_dense.
+    bool all_valid{false};
+  };
+
+  /// \brief Intrinsics of a depth camera, whose pixels are square.
+  struct CameraIntrinsics
+  {
+    /// \brief Focal length in pixels
+    double focal_length{0.0};
+
+    /// \brief Intrinsics of a camera with the given horizontal field of view.
+    /// \param[in] _hfov Horizontal field of view in radians
+    /// \param[in] _width Image width in pixels
+    /// \return Intrinsics
+    static CameraIntrinsics FromHfov(double _hfov, unsigned int _width);
+  };
+
+  /// \brief Angles of the rays of a GPU lidar, evenly spread between the
+  /// minimum and maximum along each axis.
+  struct LidarAngles
+  {
+    /// \brief Azimuth of the first ray of each row, in radians
+    double angle_min{0.0};
+
+    /// \brief Azimuth of the last ray of each row, in radians
+    double angle_max{0.0};
+
+    /// \brief Number of horizontal rays
+    unsigned int range_count{1};
+
+    /// \brief Inclination of the first row, in radians
+    double vertical_angle_min{0.0};
+
+    /// \brief Inclination of the last row, in radians
+    double vertical_angle_max{0.0};
+
+    /// \brief Number of vertical rays
+    unsigned int vertical_range_count{1};
+  };
+
+  /// \brief How frames are projected into clouds.
+  struct ProjectionOptions
+  {
+    /// \brief Fields written for each point
+    PointFields fields{PointFields::XYZRGB};
+
+    /// \brief True to drop invalid points and publish an unorganized cloud
+    bool dense{false};
+
+    /// \brief Only project every stride-th pixel along each axis
+    unsigned int stride{1};
+
+    /// \brief Edge of the voxel grid filter in meters, zero to disable it
+    double voxel_size{0.0};
+
+    /// \brief How points within a voxel are merged
+    VoxelMode voxel_mode{VoxelMode::CENTROID};
+  };
+
+  //////////////////////////////////////////////////
+  /// \brief Count near, far and NaN readings in a frame. The loop has no
+  /// branches on the data so it can be vectorized.
+  /// \param[in] _scan Depth image or GPU rays data, range on first channel.
+  /// \param[in] _count Number of readings.
+  /// \param[in] _channels Number of channels per reading.
+  /// \param[in] _min Minimum valid range.
+  /// \param[in] _max Maximum valid range.
+  /// \return Counts of invalid readings.
+  inline RangeStats ClassifyRanges(const float *_scan, size_t _count,
+      unsigned int _channels, float _min, float _max)
+  {
+    uint64_t near{0};
+    uint64_t far{0};
+    uint64_t nan{0};
+    for (size_t i = 0; i < _count; ++i)
+    {
+      float range = _scan[i * _channels];
+      near += range < _min;
+      far += range > _max;
+      nan += range != range;
+    }
+    return RangeStats{near, far, nan};
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Map a range to its REP 117 value: -inf if too close, +inf if too
+  /// far, NaN if erroneous, and unchanged otherwise.
+  /// \param[in] _range Range reading.
+  /// \param[in] _min Minimum valid range.
+  /// \param[in] _max Maximum valid range.
+  /// \return REP 117 range.
+  inline float Rep117(float _range, float _min, float _max)
+  {
+    float range = _range < _min ? -std::numeric_limits<float>::infinity() : _range;
+    return range > _max ? std::numeric_limits<float>::infinity() : range;
+  }
+
+  /// \brief Projects depth camera and GPU lidar frames into point clouds.
+  /// It only works on buffers, without rendering, so it can be fed
+  /// synthetic frames.
+  class PointCloudProjector
+  {
+    /// \brief Constructor
+    public: PointCloudProjector();
+
+    /// \brief Destructor
+    public: ~PointCloudProjector();
+
+    /// \brief Set how frames are projected.
+    /// \param[in] _options Options
+    public: void SetOptions(const ProjectionOptions &_options);
+
+    /// \brief Get how frames are projected.
+    /// \return Options
+    public: const ProjectionOptions &Options() const;
+
+    /// \brief Project a depth camera frame, in the camera's optical frame.
+    /// \param[in] _frame Depth image
+    /// \param[in] _intrinsics Camera intrinsics
+    /// \param[in] _color Colour image of the same size, or null. It's used
+    /// for PointFields::XYZRGB if it has 1 or 3 bytes per pixel, otherwise
+    /// points are black.
+    /// \param[in] _color_size Size of _color in bytes
+    /// \param[in,out] _msg Cloud whose fields, points and layout are set.
+    /// Its buffers are reused.
+    /// \return Number of points in the cloud
+    public: size_t ProjectDepthImage(const DepthFrame &_frame,
+                const CameraIntrinsics &_intrinsics,
+                const uint8_t *_color, size_t _color_size,
+                sensor_msgs::PointCloud2 &_msg);
+
+    /// \brief Project a GPU lidar frame, in the sensor frame.
+    /// \param[in] _frame GPU rays
+    /// \param[in] _angles Angles of the rays
+    /// \param[in,out] _msg Cloud whose fields, points and layout are set.
+    /// Its buffers are reused.
+    /// \return Number of points in the cloud
+    public: size_t ProjectGpuRays(const DepthFrame &_frame,
+                const LidarAngles &_angles,
+                sensor_msgs::PointCloud2 &_msg);
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<PointCloudProjectorPrivate> dataPtr;
+  };
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "../../src/projection.hh"
+
+using ros_ign_point_cloud::CameraIntrinsics;
+using ros_ign_point_cloud::DepthFrame;
+using ros_ign_point_cloud::LidarAngles;
+using ros_ign_point_cloud::PointCloudProjector;
+using ros_ign_point_cloud::PointFields;
+using ros_ign_point_cloud::ProjectionOptions;
+using ros_ign_point_cloud::VoxelMode;
+
+//////////////////////////////////////////////////
+/// \brief Create a synthetic frame: a tilted plane, with every 10th reading
+/// out of range, alternating too near, too far and NaN.
+/// \param[in] _width Width in pixels or rays
+/// \param[in] _height Height in pixels or rays
+/// \param[in] _channels Channels per reading
+/// \return Readings
+std::vector<float> createFrame(unsigned int _width, unsigned int _height,
+    unsigned int _channels)
+{
+  const float invalid[] = {0.0f, 100.0f,
+      std::numeric_limits<float>::quiet_NaN()};
+
+  std::vector<float> data(_width * _height * _channels, 0.5f);
+  for (unsigned int j = 0; j < _height; ++j)
+  {
+    for (unsigned int i = 0; i < _width; ++i)
+    {
+      auto index = j * _width + i;
+      data[index * _channels] = index % 10 == 0 ?
+          invalid[(index / 10) % 3] : 1.0f + 4.0f * i / _width;
+    }
+  }
+  return data;
+}
+
+//////////////////////////////////////////////////
+/// \brief Options for a benchmark.
+ProjectionOptions options(PointFields _fields, bool _dense,
+    unsigned int _stride, double _voxel_size,
+    VoxelMode _voxel_mode = VoxelMode::CENTROID)
+{
+  ProjectionOptions result;
+  result.fields = _fields;
+  result.dense = _dense;
+  result.stride = _stride;
+  result.voxel_size = _voxel_size;
+  result.voxel_mode = _voxel_mode;
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Project a 640x480 depth image, with an RGB image for XYZRGB.
+/// Reports readings per second.
+void depthImage(benchmark::State &_state, const ProjectionOptions &_options)
+{
+  const unsigned int width = 640;
+  const unsigned int height = 480;
+  auto data = createFrame(width, height, 1);
+  std::vector<uint8_t> rgb(width * height * 3, 0x7f);
+
+  DepthFrame frame;
+  frame.data = data.data();
+  frame.width = width;
+  frame.height = height;
+  frame.range_min = 0.1f;
+  frame.range_max = 10.0f;
+  auto intrinsics = CameraIntrinsics::FromHfov(1.047, width);
+
+  PointCloudProjector projector;
+  projector.SetOptions(_options);
+
+  sensor_msgs::PointCloud2 msg;
+  for (auto _ : _state)
+  {
+    projector.ProjectDepthImage(frame, intrinsics, rgb.data(), rgb.size(),
+        msg);
+    benchmark::DoNotOptimize(msg.data.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * width * height);
+}
+
+//////////////////////////////////////////////////
+/// \brief Project a 1800x16 GPU lidar frame, with range and intensity.
+/// Reports readings per second.
+void gpuRays(benchmark::State &_state, const ProjectionOptions &_options)
+{
+  const unsigned int width = 1800;
+  const unsigned int height = 16;
+  auto data = createFrame(width, height, 3);
+
+  DepthFrame frame;
+  frame.data = data.data();
+  frame.width = width;
+  frame.height = height;
+  frame.channels = 3;
+  frame.range_min = 0.1f;
+  frame.range_max = 10.0f;
+
+  LidarAngles angles;
+  angles.angle_min = -M_PI;
+  angles.angle_max = M_PI;
+  angles.range_count = width;
+  angles.vertical_angle_min = -0.26;
+  angles.vertical_angle_max = 0.26;
+  angles.vertical_range_count = height;
+
+  PointCloudProjector projector;
+  projector.SetOptions(_options);
+
+  sensor_msgs::PointCloud2 msg;
+  for (auto _ : _state)
+  {
+    projector.ProjectGpuRays(frame, angles, msg);
+    benchmark::DoNotOptimize(msg.data.data());
+  }
+  _state.SetItemsProcessed(_state.iterations() * width * height);
+}
+
+BENCHMARK_CAPTURE(depthImage, xyz,
+    options(PointFields::XYZ, false, 1, 0.0));
+BENCHMARK_CAPTURE(depthImage, xyzrgb,
+    options(PointFields::XYZRGB, false, 1, 0.0));
+BENCHMARK_CAPTURE(depthImage, xyzrgb_dense,
+    options(PointFields::XYZRGB, true, 1, 0.0));
+BENCHMARK_CAPTURE(depthImage, xyzrgb_stride_2,
+    options(PointFields::XYZRGB, false, 2, 0.0));
+BENCHMARK_CAPTURE(depthImage, xyz_voxel_centroid,
+    options(PointFields::XYZ, false, 1, 0.05));
+BENCHMARK_CAPTURE(depthImage, xyz_voxel_first,
+    options(PointFields::XYZ, false, 1, 0.05, VoxelMode::FIRST));
+BENCHMARK_CAPTURE(gpuRays, xyzi,
+    options(PointFields::XYZI, false, 1, 0.0));
+BENCHMARK_CAPTURE(gpuRays, xyzi_dense,
+    options(PointFields::XYZI, true, 1, 0.0));
+BENCHMARK_CAPTURE(gpuRays, xyzi_voxel_centroid,
+    options(PointFields::XYZI, false, 1, 0.2));
+
+BENCHMARK_MAIN();
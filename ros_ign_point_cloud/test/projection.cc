@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/point_cloud2_iterator.h>
+
+#include "../src/projection.hh"
+
+using ros_ign_point_cloud::CameraIntrinsics;
+using ros_ign_point_cloud::DepthFrame;
+using ros_ign_point_cloud::LidarAngles;
+using ros_ign_point_cloud::PointCloudProjector;
+using ros_ign_point_cloud::PointFields;
+using ros_ign_point_cloud::ProjectionOptions;
+using ros_ign_point_cloud::VoxelMode;
+
+static const float kInf = std::numeric_limits<float>::infinity();
+static const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+//////////////////////////////////////////////////
+/// \brief Create a synthetic frame.
+/// \param[in] _width Width in pixels or rays
+/// \param[in] _height Height in pixels or rays
+/// \param[in] _channels Channels per reading, the second one is set to the
+/// reading's index as intensity
+/// \param[in] _range Range of the reading at column i, row j
+/// \return Readings
+std::vector<float> createFrame(unsigned int _width, unsigned int _height,
+    unsigned int _channels,
+    const std::function<float(unsigned int, unsigned int)> &_range)
+{
+  std::vector<float> data(_width * _height * _channels, 0.0f);
+  for (unsigned int j = 0; j < _height; ++j)
+  {
+    for (unsigned int i = 0; i < _width; ++i)
+    {
+      auto index = (j * _width + i) * _channels;
+      data[index] = _range(i, j);
+      if (_channels > 1)
+        data[index + 1] = static_cast<float>(j * _width + i);
+    }
+  }
+  return data;
+}
+
+//////////////////////////////////////////////////
+/// \brief Describe a frame.
+DepthFrame frameOf(const std::vector<float> &_data, unsigned int _width,
+    unsigned int _height, unsigned int _channels, float _min = 0.1f,
+    float _max = 10.0f)
+{
+  DepthFrame frame;
+  frame.data = _data.data();
+  frame.width = _width;
+  frame.height = _height;
+  frame.channels = _channels;
+  frame.range_min = _min;
+  frame.range_max = _max;
+  return frame;
+}
+
+//////////////////////////////////////////////////
+/// \brief Read the position of point _index.
+/// \return Position
+std::vector<float> position(const sensor_msgs::PointCloud2 &_msg,
+    size_t _index)
+{
+  std::vector<float> xyz(3);
+  std::memcpy(xyz.data(), _msg.data.data() + _index * _msg.point_step,
+      sizeof(float) * 3);
+  return xyz;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a field of the cloud.
+/// \return Field, or null if missing
+const sensor_msgs::PointField *field(const sensor_msgs::PointCloud2 &_msg,
+    const std::string &_name)
+{
+  for (const auto &f : _msg.fields)
+  {
+    if (f.name == _name)
+      return &f;
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, DepthImage)
+{
+  const unsigned int width = 5;
+  const unsigned int height = 3;
+  auto data = createFrame(width, height, 1,
+      [](unsigned int _i, unsigned int) { return 1.0f + _i; });
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZ;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  auto intrinsics = CameraIntrinsics::FromHfov(M_PI / 2, width);
+  EXPECT_DOUBLE_EQ(2.5, intrinsics.focal_length);
+
+  sensor_msgs::PointCloud2 msg;
+  auto frame = frameOf(data, width, height, 1);
+  frame.all_valid = true;
+  EXPECT_EQ(width * height,
+      projector.ProjectDepthImage(frame, intrinsics, nullptr, 0, msg));
+
+  // Organized, in the optical frame
+  EXPECT_EQ(height, msg.height);
+  EXPECT_EQ(width, msg.width);
+  EXPECT_EQ(msg.point_step * width, msg.row_step);
+  EXPECT_EQ(msg.row_step * height, msg.data.size());
+  EXPECT_TRUE(msg.is_dense);
+  ASSERT_NE(nullptr, field(msg, "x"));
+  EXPECT_EQ(nullptr, field(msg, "rgb"));
+
+  for (unsigned int j = 0; j < height; ++j)
+  {
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      float depth = 1.0f + i;
+      auto xyz = position(msg, j * width + i);
+      EXPECT_NEAR(depth * (i - 2.0) / 2.5, xyz[0], 1e-5) << i << ", " << j;
+      EXPECT_NEAR(depth * (j - 1.0) / 2.5, xyz[1], 1e-5) << i << ", " << j;
+      EXPECT_FLOAT_EQ(depth, xyz[2]) << i << ", " << j;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, GpuRays)
+{
+  const unsigned int width = 3;
+  const unsigned int height = 3;
+  auto data = createFrame(width, height, 3,
+      [](unsigned int, unsigned int) { return 2.0f; });
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZI;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  LidarAngles angles;
+  angles.angle_min = -M_PI / 2;
+  angles.angle_max = M_PI / 2;
+  angles.range_count = width;
+  angles.vertical_angle_min = -M_PI / 4;
+  angles.vertical_angle_max = M_PI / 4;
+  angles.vertical_range_count = height;
+
+  sensor_msgs::PointCloud2 msg;
+  EXPECT_EQ(width * height, projector.ProjectGpuRays(
+      frameOf(data, width, height, 3), angles, msg));
+  EXPECT_EQ(height, msg.height);
+  EXPECT_EQ(width, msg.width);
+
+  // Middle row is horizontal, from right to left
+  const float s = 2.0f * std::cos(M_PI / 4);
+  std::vector<std::vector<float>> expected{
+    {0, -s, -s}, {s, 0, -s}, {0, s, -s},
+    {0, -2, 0}, {2, 0, 0}, {0, 2, 0},
+    {0, -s, s}, {s, 0, s}, {0, s, s}};
+
+  sensor_msgs::PointCloud2ConstIterator<float> intensity(msg, "intensity");
+  for (size_t p = 0; p < expected.size(); ++p, ++intensity)
+  {
+    auto xyz = position(msg, p);
+    for (int k = 0; k < 3; ++k)
+      EXPECT_NEAR(expected[p][k], xyz[k], 1e-5) << p;
+    EXPECT_FLOAT_EQ(static_cast<float>(p), *intensity);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, Rep117)
+{
+  std::vector<float> data{0.05f, 1.0f, 20.0f, kNaN};
+  auto frame = frameOf(data, 4, 1, 1);
+
+  auto stats = ros_ign_point_cloud::ClassifyRanges(data.data(), data.size(), 1,
+      frame.range_min, frame.range_max);
+  EXPECT_EQ(1u, stats.near);
+  EXPECT_EQ(1u, stats.far);
+  EXPECT_EQ(1u, stats.nan);
+  frame.all_valid = false;
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZ;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  // Organized keeps invalid points
+  sensor_msgs::PointCloud2 msg;
+  EXPECT_EQ(4u, projector.ProjectDepthImage(frame,
+      CameraIntrinsics::FromHfov(1.0, 4), nullptr, 0, msg));
+  EXPECT_FALSE(msg.is_dense);
+  for (int k = 0; k < 3; ++k)
+  {
+    EXPECT_EQ(-kInf, position(msg, 0)[k]);
+    EXPECT_TRUE(std::isfinite(position(msg, 1)[k]));
+    EXPECT_EQ(kInf, position(msg, 2)[k]);
+    EXPECT_TRUE(std::isnan(position(msg, 3)[k]));
+  }
+
+  // Dense drops them
+  options.dense = true;
+  projector.SetOptions(options);
+  EXPECT_EQ(1u, projector.ProjectDepthImage(frame,
+      CameraIntrinsics::FromHfov(1.0, 4), nullptr, 0, msg));
+  EXPECT_TRUE(msg.is_dense);
+  EXPECT_EQ(1u, msg.height);
+  EXPECT_EQ(1u, msg.width);
+  EXPECT_EQ(msg.point_step, msg.data.size());
+  EXPECT_FLOAT_EQ(1.0f, position(msg, 0)[2]);
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, Color)
+{
+  const unsigned int width = 2;
+  const unsigned int height = 2;
+  auto data = createFrame(width, height, 1,
+      [](unsigned int, unsigned int) { return 1.0f; });
+  auto frame = frameOf(data, width, height, 1);
+  auto intrinsics = CameraIntrinsics::FromHfov(1.0, width);
+
+  PointCloudProjector projector;
+  EXPECT_EQ(PointFields::XYZRGB, projector.Options().fields);
+
+  // Reads B, G, R from the packed rgb field
+  auto colors = [](const sensor_msgs::PointCloud2 &_msg)
+  {
+    std::vector<uint8_t> result;
+    sensor_msgs::PointCloud2ConstIterator<uint8_t> rgb(_msg, "rgb");
+    for (size_t p = 0; p < _msg.width * _msg.height; ++p, ++rgb)
+    {
+      result.push_back(rgb[2]);
+      result.push_back(rgb[1]);
+      result.push_back(rgb[0]);
+    }
+    return result;
+  };
+
+  std::vector<uint8_t> rgb{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  sensor_msgs::PointCloud2 msg;
+  projector.ProjectDepthImage(frame, intrinsics, rgb.data(), rgb.size(), msg);
+  EXPECT_EQ(rgb, colors(msg));
+
+  std::vector<uint8_t> mono{10, 20, 30, 40};
+  projector.ProjectDepthImage(frame, intrinsics, mono.data(), mono.size(),
+      msg);
+  EXPECT_EQ(std::vector<uint8_t>({10, 10, 10, 20, 20, 20, 30, 30, 30, 40, 40,
+      40}), colors(msg));
+
+  // Size doesn't match the frame, so points are black
+  projector.ProjectDepthImage(frame, intrinsics, rgb.data(), rgb.size() - 1,
+      msg);
+  EXPECT_EQ(std::vector<uint8_t>(12, 0), colors(msg));
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, Stride)
+{
+  const unsigned int width = 5;
+  const unsigned int height = 4;
+  auto data = createFrame(width, height, 3,
+      [](unsigned int _i, unsigned int _j) { return 1.0f + _i + _j; });
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZI;
+  options.stride = 2;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  sensor_msgs::PointCloud2 msg;
+  EXPECT_EQ(6u, projector.ProjectDepthImage(frameOf(data, width, height, 3),
+      CameraIntrinsics::FromHfov(1.0, width), nullptr, 0, msg));
+  EXPECT_EQ(2u, msg.height);
+  EXPECT_EQ(3u, msg.width);
+
+  // Every other column of every other row
+  sensor_msgs::PointCloud2ConstIterator<float> z(msg, "z");
+  sensor_msgs::PointCloud2ConstIterator<float> intensity(msg, "intensity");
+  for (unsigned int j = 0; j < height; j += 2)
+  {
+    for (unsigned int i = 0; i < width; i += 2, ++z, ++intensity)
+    {
+      EXPECT_FLOAT_EQ(1.0f + i + j, *z);
+      EXPECT_FLOAT_EQ(static_cast<float>(j * width + i), *intensity);
+    }
+  }
+
+  // Zero is the same as 1
+  options.stride = 0;
+  projector.SetOptions(options);
+  EXPECT_EQ(1u, projector.Options().stride);
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, Voxels)
+{
+  // Two clusters of 2 readings each, far apart along the optical axis, and an
+  // invalid reading which is dropped
+  std::vector<float> data{1.0f, 1.02f, 5.0f, 5.04f, kNaN};
+  auto frame = frameOf(data, 5, 1, 1);
+  CameraIntrinsics intrinsics{1000.0};
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZ;
+  options.voxel_size = 0.5;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  sensor_msgs::PointCloud2 msg;
+  EXPECT_EQ(2u, projector.ProjectDepthImage(frame, intrinsics, nullptr, 0,
+      msg));
+  EXPECT_TRUE(msg.is_dense);
+  EXPECT_EQ(1u, msg.height);
+  EXPECT_EQ(2u, msg.width);
+  EXPECT_NEAR(1.01f, position(msg, 0)[2], 1e-5);
+  EXPECT_NEAR(5.02f, position(msg, 1)[2], 1e-5);
+
+  options.voxel_mode = VoxelMode::FIRST;
+  projector.SetOptions(options);
+  EXPECT_EQ(2u, projector.ProjectDepthImage(frame, intrinsics, nullptr, 0,
+      msg));
+  EXPECT_FLOAT_EQ(1.0f, position(msg, 0)[2]);
+  EXPECT_FLOAT_EQ(5.0f, position(msg, 1)[2]);
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, VoxelsInfinite)
+{
+  // Infinite and huge depths are within the default range, but have no
+  // voxel, so they're dropped
+  std::vector<float> data{1.0f, kInf, 1.02f, 3e38f};
+  DepthFrame frame;
+  frame.data = data.data();
+  frame.width = 4;
+  frame.height = 1;
+  CameraIntrinsics intrinsics{1000.0};
+
+  ProjectionOptions options;
+  options.fields = PointFields::XYZ;
+  options.voxel_size = 1e-3;
+  PointCloudProjector projector;
+  projector.SetOptions(options);
+
+  sensor_msgs::PointCloud2 msg;
+  EXPECT_EQ(2u, projector.ProjectDepthImage(frame, intrinsics, nullptr, 0,
+      msg));
+  EXPECT_FLOAT_EQ(1.0f, position(msg, 0)[2]);
+  EXPECT_FLOAT_EQ(1.02f, position(msg, 1)[2]);
+
+  options.voxel_mode = VoxelMode::FIRST;
+  projector.SetOptions(options);
+  EXPECT_EQ(2u, projector.ProjectDepthImage(frame, intrinsics, nullptr, 0,
+      msg));
+}
+
+/////////////////////////////////////////////////
+TEST(ProjectionTest, Reuse)
+{
+  const unsigned int width = 4;
+  const unsigned int height = 3;
+  auto data = createFrame(width, height, 1,
+      [](unsigned int _i, unsigned int _j) { return _i == _j ? kNaN : 2.0f; });
+  auto frame = frameOf(data, width, height, 1);
+  auto intrinsics = CameraIntrinsics::FromHfov(1.0, width);
+
+  // A message which held a cloud of another layout gets the same result as
+  // a new one
+  for (auto fields : {PointFields::XYZ, PointFields::XYZI, PointFields::XYZRGB})
+  {
+    for (bool dense : {false, true})
+    {
+      ProjectionOptions options;
+      options.fields = fields;
+      options.dense = dense;
+
+      PointCloudProjector projector;
+      projector.SetOptions(options);
+      sensor_msgs::PointCloud2 expected;
+      projector.ProjectDepthImage(frame, intrinsics, nullptr, 0, expected);
+
+      sensor_msgs::PointCloud2 msg;
+      options.fields = PointFields::XYZI;
+      options.dense = !dense;
+      projector.SetOptions(options);
+      projector.ProjectDepthImage(frame, intrinsics, nullptr, 0, msg);
+
+      options.fields = fields;
+      options.dense = dense;
+      projector.SetOptions(options);
+      projector.ProjectDepthImage(frame, intrinsics, nullptr, 0, msg);
+
+      EXPECT_EQ(expected.height, msg.height);
+      EXPECT_EQ(expected.width, msg.width);
+      EXPECT_EQ(expected.point_step, msg.point_step);
+      EXPECT_EQ(expected.row_step, msg.row_step);
+      EXPECT_EQ(expected.fields.size(), msg.fields.size());
+      EXPECT_EQ(expected.is_dense, msg.is_dense);
+      ASSERT_EQ(expected.data.size(), msg.data.size());
+
+      // Padding between fields isn't compared
+      for (const auto &f : expected.fields)
+      {
+        for (size_t p = 0; p < msg.width * msg.height; ++p)
+        {
+          auto offset = p * msg.point_step + f.offset;
+          EXPECT_EQ(0, std::memcmp(expected.data.data() + offset,
+              msg.data.data() + offset, sizeof(float))) << f.name << p;
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}